@@ -83,6 +83,14 @@ struct CollectionChangeSet {
     // unreported moves which show up only as a delete/insert pair.
     std::vector<Move> moves;
 
+    // Per-column breakdown of `modifications_new`, indexed by column index in
+    // the collection's table. columns[i] contains the indices in the _new_
+    // collection whose value for column `i` was set directly; rows which are
+    // in `modifications_new` only because of changes to linked objects do not
+    // appear here. The vector is only as long as the highest modified column,
+    // and may be empty.
+    std::vector<IndexSet> columns;
+
     bool empty() const
     {
         return deletions.empty() && insertions.empty() && modifications.empty()
@@ -97,6 +105,11 @@ struct CollectionChangeSet {
 // `void error(std::exception_ptr)`, or a pointer to such an object. If a pointer
 // is given, the caller is responsible for ensuring that the pointed-to object
 // outlives the collection.
+//
+// The CollectionChangeSet passed to before() and after() is a single immutable
+// instance shared by every callback registered on the collection, and is only
+// guaranteed to remain valid for the duration of the call; callbacks which
+// need it afterwards must copy it.
 class CollectionChangeCallback {
 public:
     CollectionChangeCallback(std::nullptr_t={}) { }
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "handover_channel.hpp"
+
+#include "thread_confined.hpp"
+
+using namespace realm;
+
+void HandoverChannel::send(SharedRealm const& source_realm, std::vector<Object> const& objects)
+{
+    auto package = source_realm->package_objects_for_handover(objects);
+
+    util::Optional<Realm::HandoverPackage> superseded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        superseded = std::move(m_pending);
+        m_pending = std::move(package);
+    }
+    // The superseded package (if any) is destroyed here, outside the lock,
+    // unpinning its version on the sending thread
+}
+
+util::Optional<std::vector<AnyThreadConfined>> HandoverChannel::receive(SharedRealm const& destination_realm)
+{
+    util::Optional<Realm::HandoverPackage> package;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        package = std::move(m_pending);
+        m_pending = util::none;
+    }
+    if (!package) {
+        return util::none;
+    }
+    return destination_realm->accept_handover(std::move(*package));
+}
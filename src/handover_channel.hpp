@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_HANDOVER_CHANNEL_HPP
+#define REALM_HANDOVER_CHANNEL_HPP
+
+#include "shared_realm.hpp"
+
+#include <realm/util/optional.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace realm {
+class AnyThreadConfined;
+class Object;
+
+// A persistent channel for repeatedly handing objects from one thread to
+// another, for architectures which stream query results from a worker to a
+// consumer continuously. Unlike a bare HandoverPackage, which is single-shot,
+// the channel can be sent through any number of times; each send packages the
+// batch as row positions against a freshly pinned version (no per-object
+// handover export), and a batch which is superseded before being received is
+// dropped and its version unpinned rather than imported.
+//
+// send() must be called from the source Realm's thread and receive() from the
+// destination Realm's thread; the channel itself may be shared freely.
+class HandoverChannel {
+public:
+    HandoverChannel() = default;
+    HandoverChannel(const HandoverChannel&) = delete;
+    HandoverChannel& operator=(const HandoverChannel&) = delete;
+
+    // Publish a batch of objects from `source_realm`'s thread, replacing any
+    // previously sent batch which has not yet been received.
+    void send(SharedRealm const& source_realm, std::vector<Object> const& objects);
+
+    // Take the most recently sent batch, importing it into
+    // `destination_realm`. Returns none if nothing has been sent since the
+    // last receive.
+    util::Optional<std::vector<AnyThreadConfined>> receive(SharedRealm const& destination_realm);
+
+private:
+    std::mutex m_mutex;
+    util::Optional<Realm::HandoverPackage> m_pending;
+};
+}
+
+#endif // REALM_HANDOVER_CHANNEL_HPP
@@ -18,6 +18,7 @@
 
 #include "impl/external_commit_helper.hpp"
 #include "impl/realm_coordinator.hpp"
+#include "impl/thread_scheduling.hpp"
 
 #include <assert.h>
 #include <errno.h>
@@ -156,6 +157,7 @@ ExternalCommitHelper::~ExternalCommitHelper()
 void ExternalCommitHelper::listen()
 {
     pthread_setname_np(pthread_self(), "Realm notification listener");
+    apply_worker_thread_scheduling(m_parent.get_config());
 
     int ret;
 
@@ -19,6 +19,7 @@
 #include "impl/external_commit_helper.hpp"
 
 #include "impl/realm_coordinator.hpp"
+#include "impl/thread_scheduling.hpp"
 
 #include <asl.h>
 #include <assert.h>
@@ -180,6 +181,7 @@ ExternalCommitHelper::~ExternalCommitHelper()
 void ExternalCommitHelper::listen()
 {
     pthread_setname_np("RLMRealm notification listener");
+    apply_worker_thread_scheduling(m_parent.get_config());
 
     // Set up the kqueue
     // EVFILT_READ indicates that we care about data being available to read
@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/bulk_importer.hpp"
+
+#include "object_schema.hpp"
+#include "object_store.hpp"
+#include "property.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group.hpp>
+#include <realm/util/assert.hpp>
+#include <realm/table.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace realm;
+using namespace realm::_impl;
+
+BulkImporter::BulkImporter(std::shared_ptr<Realm> realm, ObjectSchema const& object_schema,
+                           size_t rows_per_buffer, size_t rows_per_transaction)
+: m_realm(std::move(realm))
+, m_object_schema(object_schema)
+, m_rows_per_buffer(rows_per_buffer)
+, m_rows_per_transaction(rows_per_transaction)
+{
+    for (auto& prop : m_object_schema.persisted_properties) {
+        switch (prop.type) {
+            case PropertyType::Object:
+            case PropertyType::Array:
+            case PropertyType::LinkingObjects:
+            case PropertyType::Any:
+                throw std::logic_error("Bulk import of type '" + m_object_schema.name
+                                       + "' is not possible: property '" + prop.name
+                                       + "' is not a scalar column.");
+            default:
+                break;
+        }
+    }
+}
+
+void BulkImporter::insert_rows(std::vector<ImportRow> const& rows)
+{
+    TableRef table = ObjectStore::table_for_object_type(m_realm->read_group(), m_object_schema);
+    size_t first_row = table->add_empty_row(rows.size());
+    auto& props = m_object_schema.persisted_properties;
+
+    // column-by-column so each column's accessor and type dispatch is
+    // resolved once per buffer rather than once per cell
+    for (size_t col = 0; col < props.size(); col++) {
+        auto& prop = props[col];
+        size_t column = prop.table_column;
+
+        switch (prop.type) {
+            case PropertyType::Bool:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_bool(column, first_row + i, cell.int_value != 0);
+                }
+                break;
+            case PropertyType::Int:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_int(column, first_row + i, cell.int_value);
+                }
+                break;
+            case PropertyType::Float:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_float(column, first_row + i, static_cast<float>(cell.double_value));
+                }
+                break;
+            case PropertyType::Double:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_double(column, first_row + i, cell.double_value);
+                }
+                break;
+            case PropertyType::String:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_string(column, first_row + i, cell.string_value);
+                }
+                break;
+            case PropertyType::Data:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_binary(column, first_row + i,
+                                          BinaryData(cell.string_value.data(), cell.string_value.size()));
+                }
+                break;
+            case PropertyType::Date:
+                for (size_t i = 0; i < rows.size(); i++) {
+                    auto& cell = rows[i][col];
+                    if (cell.is_null)
+                        table->set_null(column, first_row + i);
+                    else
+                        table->set_timestamp(column, first_row + i, cell.timestamp_value);
+                }
+                break;
+            default:
+                REALM_UNREACHABLE(); // rejected in the constructor
+        }
+    }
+}
+
+uint64_t BulkImporter::import(Producer producer)
+{
+    m_realm->verify_thread();
+    if (m_realm->is_in_transaction()) {
+        throw std::logic_error("Cannot import within an existing write transaction.");
+    }
+
+    struct SharedState {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<ImportRow> filled;
+        bool has_filled = false;
+        bool done = false;
+        bool abort = false;
+        std::exception_ptr error;
+    };
+    SharedState state;
+    size_t rows_per_buffer = m_rows_per_buffer;
+
+    // the producer fills one buffer while the previous one is being
+    // inserted, handing them over under the mutex
+    std::thread producer_thread([&] {
+        try {
+            std::vector<ImportRow> buffer;
+            bool more = true;
+            while (more) {
+                buffer.clear();
+                buffer.reserve(rows_per_buffer);
+                more = producer(buffer);
+
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.cv.wait(lock, [&] { return !state.has_filled || state.abort; });
+                if (state.abort)
+                    break;
+                state.filled.swap(buffer);
+                state.has_filled = !state.filled.empty();
+                if (!more)
+                    state.done = true;
+                state.cv.notify_all();
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.error = std::current_exception();
+            state.done = true;
+            state.cv.notify_all();
+        }
+    });
+
+    uint64_t total_rows = 0;
+    size_t rows_since_commit = 0;
+    std::vector<ImportRow> inserting;
+
+    m_realm->begin_transaction();
+    try {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.cv.wait(lock, [&] { return state.has_filled || state.done; });
+                if (state.error) {
+                    std::rethrow_exception(state.error);
+                }
+                if (!state.has_filled) {
+                    break;
+                }
+                inserting.swap(state.filled);
+                state.filled.clear();
+                state.has_filled = false;
+                state.cv.notify_all();
+            }
+
+            insert_rows(inserting);
+            total_rows += inserting.size();
+            rows_since_commit += inserting.size();
+
+            if (rows_since_commit >= m_rows_per_transaction) {
+                m_realm->commit_transaction();
+                m_realm->begin_transaction();
+                rows_since_commit = 0;
+            }
+        }
+        m_realm->commit_transaction();
+    }
+    catch (...) {
+        if (m_realm->is_in_transaction()) {
+            m_realm->cancel_transaction();
+        }
+        // unblock the producer so it can observe the abort and exit
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.abort = true;
+            state.cv.notify_all();
+        }
+        producer_thread.join();
+        throw;
+    }
+    producer_thread.join();
+    return total_rows;
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_BULK_IMPORTER_HPP
+#define REALM_BULK_IMPORTER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <realm/timestamp.hpp>
+
+namespace realm {
+class ObjectSchema;
+class Realm;
+
+namespace _impl {
+
+// One parsed cell of an imported row. Which field is meaningful is
+// determined by the type of the column the cell belongs to: Int and Bool
+// use int_value, Float and Double use double_value, String and Data use
+// string_value, and Date uses timestamp_value.
+struct ImportCell {
+    bool is_null = false;
+    int64_t int_value = 0;
+    double double_value = 0;
+    std::string string_value;
+    Timestamp timestamp_value;
+};
+
+// One parsed row: one cell per persisted property, in schema order.
+using ImportRow = std::vector<ImportCell>;
+
+// A pipelined bulk importer for large flat data loads. A producer callback
+// parses source data into typed row buffers on a background thread while the
+// previously filled buffer is inserted on the importing thread, so parsing
+// and inserting overlap rather than alternating. Rows are inserted
+// column-by-column and the write is chunked into multiple transactions so
+// that a multi-million row import does not accumulate one giant commit.
+//
+// Only scalar columns are supported: link, array and linking-objects
+// properties cannot be expressed as flat parsed cells and make the importer
+// throw at construction. Primary key columns are written as plain values;
+// the source data must not contain keys which already exist.
+class BulkImporter {
+public:
+    // Fill `buffer` with up to the importer's buffer capacity of parsed
+    // rows. Invoked repeatedly on a background thread; return false when the
+    // source is exhausted (any rows added on that final call are still
+    // inserted).
+    using Producer = std::function<bool (std::vector<ImportRow>& buffer)>;
+
+    // The Realm must be on the calling thread and must not have a write
+    // transaction in progress; the importer manages its own transactions.
+    BulkImporter(std::shared_ptr<Realm> realm, ObjectSchema const& object_schema,
+                 size_t rows_per_buffer = 4096, size_t rows_per_transaction = 65536);
+
+    // Run the import to completion on the calling thread, returning the
+    // number of rows inserted. If the producer or an insert throws, the
+    // transaction in progress is rolled back (rows from already-committed
+    // chunks remain) and the exception is rethrown here.
+    uint64_t import(Producer producer);
+
+private:
+    std::shared_ptr<Realm> m_realm;
+    ObjectSchema const& m_object_schema;
+    size_t m_rows_per_buffer;
+    size_t m_rows_per_transaction;
+
+    void insert_rows(std::vector<ImportRow> const& rows);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_BULK_IMPORTER_HPP
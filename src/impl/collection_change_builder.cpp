@@ -19,13 +19,21 @@
 #include "impl/collection_change_builder.hpp"
 
 #include <realm/util/assert.hpp>
-#include <algorithm>
 
 #include <algorithm>
+#include <thread>
 
 using namespace realm;
 using namespace realm::_impl;
 
+namespace {
+// The maximum number of moves tracked individually within a single
+// transaction before the changeset degrades to reporting the entire
+// collection as deleted and reinserted, which bounds the memory used when a
+// transaction removes a huge number of rows
+constexpr size_t max_individually_tracked_moves = 65536;
+}
+
 CollectionChangeBuilder::CollectionChangeBuilder(IndexSet deletions,
                                                  IndexSet insertions,
                                                  IndexSet modifications,
@@ -50,6 +58,32 @@ void CollectionChangeBuilder::merge(CollectionChangeBuilder&& c)
     verify();
     c.verify();
 
+    // Modification-only changesets are by far the most common thing merged
+    // into a large accumulated changeset, and compose by simply merging the
+    // sets of modified rows: with no new insertions, deletions or moves
+    // nothing shifts, so the general index-adjusting passes below (which all
+    // cost proportional to the size of the accumulated changeset) can be
+    // skipped entirely.
+    if (c.deletions.empty() && c.insertions.empty() && c.moves.empty()) {
+        modifications.add(c.modifications);
+        if (c.columns.size() > columns.size())
+            columns.resize(c.columns.size());
+        for (size_t i = 0; i < c.columns.size(); ++i)
+            columns[i].add(c.columns[i]);
+        c = {};
+        verify();
+        return;
+    }
+
+    // Propagate per-column modification info for rows which the new changeset
+    // moves, mirroring what's done below for `modifications`
+    auto mark_moved_columns = [&](size_t from, size_t to) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].contains(from))
+                c.column(i).add(to);
+        }
+    };
+
     // First update any old moves
     if (!c.moves.empty() || !c.deletions.empty() || !c.insertions.empty()) {
         auto it = std::remove_if(begin(moves), end(moves), [&](auto& old) {
@@ -60,6 +94,7 @@ void CollectionChangeBuilder::merge(CollectionChangeBuilder&& c)
             if (it != c.moves.end()) {
                 if (modifications.contains(it->from))
                     c.modifications.add(it->to);
+                mark_moved_columns(it->from, it->to);
                 old.to = it->to;
                 *it = c.moves.back();
                 c.moves.pop_back();
@@ -92,6 +127,7 @@ void CollectionChangeBuilder::merge(CollectionChangeBuilder&& c)
         for (auto const& move : c.moves) {
             if (modifications.contains(move.from))
                 c.modifications.add(move.to);
+            mark_moved_columns(move.from, move.to);
         }
     }
 
@@ -118,6 +154,15 @@ void CollectionChangeBuilder::merge(CollectionChangeBuilder&& c)
     modifications.shift_for_insert_at(c.insertions);
     modifications.add(c.modifications);
 
+    if (c.columns.size() > columns.size())
+        columns.resize(c.columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        columns[i].erase_at(c.deletions);
+        columns[i].shift_for_insert_at(c.insertions);
+        if (i < c.columns.size())
+            columns[i].add(c.columns[i]);
+    }
+
     c = {};
     verify();
 }
@@ -136,8 +181,40 @@ void CollectionChangeBuilder::clean_up_stale_moves()
     }), end(moves));
 }
 
+void CollectionChangeBuilder::collapse_to_reload(size_t current_size)
+{
+    // Reconstruct the size of the collection before any of the tracked
+    // changes were made, as in clear()
+    size_t old_size = current_size;
+    for (auto range : deletions)
+        old_size += range.second - range.first;
+    for (auto range : insertions)
+        old_size -= range.second - range.first;
+
+    deletions = {};
+    insertions = {};
+    modifications = {};
+    moves.clear();
+    m_move_mapping.clear();
+    columns.clear();
+
+    m_collapsed = true;
+    m_old_size = old_size;
+    m_current_size = current_size;
+}
+
 void CollectionChangeBuilder::parse_complete()
 {
+    if (m_collapsed) {
+        // Materialize the collapsed state as every row in the old collection
+        // being deleted and every row in the new one being inserted, which
+        // consumers already handle as a full reload
+        deletions.set(m_old_size);
+        insertions.set(m_current_size);
+        m_collapsed = false;
+        return;
+    }
+
     moves.reserve(m_move_mapping.size());
     for (auto move : m_move_mapping) {
         REALM_ASSERT_DEBUG(deletions.contains(move.second));
@@ -154,14 +231,31 @@ void CollectionChangeBuilder::parse_complete()
               [](auto const& a, auto const& b) { return a.from < b.from; });
 }
 
-void CollectionChangeBuilder::modify(size_t ndx)
+IndexSet& CollectionChangeBuilder::column(size_t col)
 {
+    if (col >= columns.size())
+        columns.resize(col + 1);
+    return columns[col];
+}
+
+void CollectionChangeBuilder::modify(size_t ndx, size_t col)
+{
+    if (m_collapsed)
+        return;
     modifications.add(ndx);
+    if (col != IndexSet::npos)
+        column(col).add(ndx);
 }
 
 void CollectionChangeBuilder::insert(size_t index, size_t count, bool track_moves)
 {
+    if (m_collapsed) {
+        m_current_size += count;
+        return;
+    }
     modifications.shift_for_insert_at(index, count);
+    for (auto& col : columns)
+        col.shift_for_insert_at(index, count);
     if (!track_moves)
         return;
 
@@ -175,7 +269,13 @@ void CollectionChangeBuilder::insert(size_t index, size_t count, bool track_move
 
 void CollectionChangeBuilder::erase(size_t index)
 {
+    if (m_collapsed) {
+        --m_current_size;
+        return;
+    }
     modifications.erase_at(index);
+    for (auto& col : columns)
+        col.erase_at(index);
     size_t unshifted = insertions.erase_or_unshift(index);
     if (unshifted != IndexSet::npos)
         deletions.add_shifted(unshifted);
@@ -193,6 +293,10 @@ void CollectionChangeBuilder::erase(size_t index)
 
 void CollectionChangeBuilder::clear(size_t old_size)
 {
+    if (m_collapsed) {
+        m_current_size = 0;
+        return;
+    }
     if (old_size != std::numeric_limits<size_t>::max()) {
         for (auto range : deletions)
             old_size += range.second - range.first;
@@ -201,15 +305,35 @@ void CollectionChangeBuilder::clear(size_t old_size)
     }
 
     modifications.clear();
+    for (auto& col : columns)
+        col.clear();
     insertions.clear();
     moves.clear();
     m_move_mapping.clear();
     deletions.set(old_size);
 }
 
+void CollectionChangeBuilder::reset()
+{
+    deletions.clear();
+    insertions.clear();
+    modifications.clear();
+    modifications_new.clear();
+    moves.clear();
+    // The length of `columns` is visible to consumers of the changeset, so
+    // it has to actually shrink rather than just clearing each entry
+    columns.clear();
+    m_move_mapping.clear();
+    m_collapsed = false;
+    m_old_size = 0;
+    m_current_size = 0;
+}
+
 void CollectionChangeBuilder::move(size_t from, size_t to)
 {
     REALM_ASSERT(from != to);
+    if (m_collapsed)
+        return;
 
     bool updated_existing_move = false;
     for (auto& move : moves) {
@@ -250,11 +374,33 @@ void CollectionChangeBuilder::move(size_t from, size_t to)
         modifications.insert_at(to);
     else
         modifications.shift_for_insert_at(to);
+
+    for (auto& col : columns) {
+        bool modified = col.contains(from);
+        col.erase_at(from);
+        if (modified)
+            col.insert_at(to);
+        else
+            col.shift_for_insert_at(to);
+    }
 }
 
 void CollectionChangeBuilder::move_over(size_t row_ndx, size_t last_row, bool track_moves)
 {
     REALM_ASSERT(row_ndx <= last_row);
+    if (m_collapsed) {
+        --m_current_size;
+        return;
+    }
+    // Each tracked move costs a hash table entry plus potentially fragmenting
+    // the index sets, so once there are enough of them in a single transaction
+    // give up on tracking individual rows. `last_row + 1` is the size of the
+    // collection before this change.
+    if (track_moves && m_move_mapping.size() >= max_individually_tracked_moves) {
+        collapse_to_reload(last_row + 1);
+        --m_current_size;
+        return;
+    }
     REALM_ASSERT(insertions.empty() || prev(insertions.end())->second - 1 <= last_row);
     REALM_ASSERT(modifications.empty() || prev(modifications.end())->second - 1 <= last_row);
 
@@ -266,6 +412,8 @@ void CollectionChangeBuilder::move_over(size_t row_ndx, size_t last_row, bool tr
             m_move_mapping.erase(row_ndx);
         }
         modifications.remove(row_ndx);
+        for (auto& col : columns)
+            col.remove(row_ndx);
         return;
     }
 
@@ -277,6 +425,15 @@ void CollectionChangeBuilder::move_over(size_t row_ndx, size_t last_row, bool tr
     else
         modifications.remove(row_ndx);
 
+    for (auto& col : columns) {
+        if (col.contains(last_row)) {
+            col.remove(last_row);
+            col.add(row_ndx);
+        }
+        else
+            col.remove(row_ndx);
+    }
+
     if (!track_moves)
         return;
 
@@ -324,6 +481,8 @@ void CollectionChangeBuilder::move_over(size_t row_ndx, size_t last_row, bool tr
 void CollectionChangeBuilder::swap(size_t ndx_1, size_t ndx_2, bool track_moves)
 {
     REALM_ASSERT(ndx_1 != ndx_2);
+    if (m_collapsed)
+        return;
     // The order of the two indices doesn't matter semantically, but making them
     // consistent simplifies the logic
     if (ndx_1 > ndx_2)
@@ -342,6 +501,21 @@ void CollectionChangeBuilder::swap(size_t ndx_1, size_t ndx_2, bool track_moves)
         }
     }
 
+    for (auto& col : columns) {
+        bool row_1_modified = col.contains(ndx_1);
+        bool row_2_modified = col.contains(ndx_2);
+        if (row_1_modified != row_2_modified) {
+            if (row_1_modified) {
+                col.remove(ndx_1);
+                col.add(ndx_2);
+            }
+            else {
+                col.remove(ndx_2);
+                col.add(ndx_1);
+            }
+        }
+    }
+
     if (!track_moves)
         return;
 
@@ -389,10 +563,16 @@ void CollectionChangeBuilder::swap(size_t ndx_1, size_t ndx_2, bool track_moves)
 void CollectionChangeBuilder::subsume(size_t old_ndx, size_t new_ndx, bool track_moves)
 {
     REALM_ASSERT(old_ndx != new_ndx);
+    if (m_collapsed)
+        return;
 
     if (modifications.contains(old_ndx)) {
         modifications.add(new_ndx);
     }
+    for (auto& col : columns) {
+        if (col.contains(old_ndx))
+            col.add(new_ndx);
+    }
 
     if (!track_moves)
         return;
@@ -417,6 +597,9 @@ void CollectionChangeBuilder::subsume(size_t old_ndx, size_t new_ndx, bool track
 void CollectionChangeBuilder::verify()
 {
 #ifdef REALM_DEBUG
+    // Collapsed changesets must be materialized by parse_complete() before
+    // being merged or delivered
+    REALM_ASSERT(!m_collapsed);
     for (auto&& move : moves) {
         REALM_ASSERT(deletions.contains(move.from));
         REALM_ASSERT(insertions.contains(move.to));
@@ -622,7 +805,19 @@ private:
     }
 };
 
-void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& changeset)
+// The maximum number of rows in the differing window for which move
+// detection is performed. The LCS calculation degrades badly when a large
+// portion of the rows changed position, so past this point the whole window
+// is reported as a delete+insert instead, which is still a correct changeset
+// but loses the move information.
+constexpr size_t max_rows_for_move_detection = 10000;
+
+// The minimum combined input size for which calculate() builds and sorts its
+// two row arrays on separate threads
+constexpr size_t min_rows_for_parallel_build = 100000;
+
+void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& changeset,
+                            bool track_moves)
 {
     // The RowInfo array contains information about the old and new TV indices of
     // each row, which we need to turn into two sequences of rows, which we'll
@@ -649,6 +844,22 @@ void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& cha
     if (first_difference == IndexSet::npos)
         return;
 
+    // Similarly find the end of the common suffix to bound the window of
+    // rows which actually changed position
+    size_t last_difference = a.size();
+    while (last_difference > first_difference
+           && a[last_difference - 1].row_index == rows[last_difference - 1].row_index) {
+        --last_difference;
+    }
+
+    if (!track_moves || last_difference - first_difference > max_rows_for_move_detection) {
+        for (size_t i = first_difference; i < last_difference; ++i) {
+            changeset.deletions.add(a[i].tv_index);
+            changeset.insertions.add(rows[i].tv_index);
+        }
+        return;
+    }
+
     // Note that `b` is sorted by row_index, while `a` is sorted by tv_index
     b.reserve(rows.size());
     for (size_t i = 0; i < rows.size(); ++i)
@@ -678,35 +889,70 @@ void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& cha
 CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<size_t> const& prev_rows,
                                                            std::vector<size_t> const& next_rows,
                                                            std::function<bool (size_t)> row_did_change,
-                                                           util::Optional<IndexSet> const& move_candidates)
+                                                           util::Optional<IndexSet> const& move_candidates,
+                                                           bool track_moves)
 {
     REALM_ASSERT_DEBUG(!move_candidates || std::is_sorted(begin(next_rows), end(next_rows)));
 
     CollectionChangeBuilder ret;
 
-    size_t deleted = 0;
     std::vector<RowInfo> old_rows;
-    old_rows.reserve(prev_rows.size());
-    for (size_t i = 0; i < prev_rows.size(); ++i) {
-        if (prev_rows[i] == IndexSet::npos) {
-            ++deleted;
-            ret.deletions.add(i);
+    auto build_old_rows = [&] {
+        size_t deleted = 0;
+        old_rows.reserve(prev_rows.size());
+        for (size_t i = 0; i < prev_rows.size(); ++i) {
+            if (prev_rows[i] == IndexSet::npos) {
+                ++deleted;
+                ret.deletions.add(i);
+            }
+            else
+                old_rows.push_back({prev_rows[i], IndexSet::npos, i, i - deleted});
         }
-        else
-            old_rows.push_back({prev_rows[i], IndexSet::npos, i, i - deleted});
-    }
-    std::sort(begin(old_rows), end(old_rows), [](auto& lft, auto& rgt) {
-        return lft.row_index < rgt.row_index;
-    });
+        std::sort(begin(old_rows), end(old_rows), [](auto& lft, auto& rgt) {
+            return lft.row_index < rgt.row_index;
+        });
+    };
 
     std::vector<RowInfo> new_rows;
-    new_rows.reserve(next_rows.size());
-    for (size_t i = 0; i < next_rows.size(); ++i) {
-        new_rows.push_back({next_rows[i], IndexSet::npos, i, 0});
+    auto build_new_rows = [&] {
+        new_rows.reserve(next_rows.size());
+        for (size_t i = 0; i < next_rows.size(); ++i) {
+            new_rows.push_back({next_rows[i], IndexSet::npos, i, 0});
+        }
+        std::sort(begin(new_rows), end(new_rows), [](auto& lft, auto& rgt) {
+            return lft.row_index < rgt.row_index;
+        });
+    };
+
+    // Building and sorting the two row arrays dominates the cost of diffing
+    // large collections, and the two are entirely independent of each other,
+    // so build them on two threads when there's enough data for the thread
+    // to pay for itself
+    if (prev_rows.size() + next_rows.size() >= min_rows_for_parallel_build) {
+        std::exception_ptr build_error;
+        std::thread worker([&]() noexcept {
+            try {
+                build_old_rows();
+            }
+            catch (...) {
+                build_error = std::current_exception();
+            }
+        });
+        try {
+            build_new_rows();
+        }
+        catch (...) {
+            worker.join();
+            throw;
+        }
+        worker.join();
+        if (build_error)
+            std::rethrow_exception(build_error);
+    }
+    else {
+        build_old_rows();
+        build_new_rows();
     }
-    std::sort(begin(new_rows), end(new_rows), [](auto& lft, auto& rgt) {
-        return lft.row_index < rgt.row_index;
-    });
 
     // Don't add rows which were modified to not match the query to `deletions`
     // immediately because the unsorted move logic needs to be able to
@@ -755,11 +1001,14 @@ CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<size_t> c
         }
     }
 
-    if (move_candidates) {
+    if (!track_moves) {
+        calculate_moves_sorted(new_rows, ret, false);
+    }
+    else if (move_candidates) {
         calculate_moves_unsorted(new_rows, removed, *move_candidates, ret);
     }
     else {
-        calculate_moves_sorted(new_rows, ret);
+        calculate_moves_sorted(new_rows, ret, true);
     }
     ret.deletions.add(removed);
     ret.verify();
@@ -795,12 +1044,15 @@ CollectionChangeSet CollectionChangeBuilder::finalize() &&
     // modified in case changeset merging results in it no longer being an insert,
     // but we don't want inserts in the final modification set
     modifications.remove(insertions);
+    for (auto& col : columns)
+        col.remove(insertions);
 
     return {
         std::move(deletions),
         std::move(insertions),
         std::move(modifications_in_old),
         std::move(modifications),
-        std::move(moves)
+        std::move(moves),
+        std::move(columns)
     };
 }
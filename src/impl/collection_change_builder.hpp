@@ -44,17 +44,25 @@ public:
     // If `move_candidates` is supplied they it will be used to do more accurate
     // determination of which rows moved. This is only supported when the rows
     // are in table order (i.e. not sorted or from a LinkList)
+    // If `track_moves` is false no move detection is performed at all and rows
+    // which changed position are reported as a delete and an insert, which is
+    // much cheaper to calculate
     static CollectionChangeBuilder calculate(std::vector<size_t> const& old_rows,
                                              std::vector<size_t> const& new_rows,
                                              std::function<bool (size_t)> row_did_change,
-                                             util::Optional<IndexSet> const& move_candidates = util::none);
+                                             util::Optional<IndexSet> const& move_candidates = util::none,
+                                             bool track_moves = true);
 
     // generic operations {
     CollectionChangeSet finalize() &&;
     void merge(CollectionChangeBuilder&&);
 
+    // Reset to the empty state, keeping the allocated buffers so that a
+    // long-lived builder can be reused without reallocating
+    void reset();
+
     void insert(size_t ndx, size_t count=1, bool track_moves=true);
-    void modify(size_t ndx);
+    void modify(size_t ndx, size_t col=IndexSet::npos);
     void erase(size_t ndx);
     void clear(size_t old_size);
     // }
@@ -77,6 +85,23 @@ public:
 private:
     std::unordered_map<size_t, size_t> m_move_mapping;
 
+    // Whether the changeset has grown past the point where tracking each row
+    // individually is worth the memory, and has been degraded to reporting
+    // the entire collection as deleted and reinserted. While collapsed only
+    // the collection's size is tracked, with the pre-change size in
+    // `m_old_size` and the current size in `m_current_size`.
+    bool m_collapsed = false;
+    size_t m_old_size = 0;
+    size_t m_current_size = 0;
+
+    // Discard all of the per-row state and switch to reporting the entire
+    // collection as changed. `current_size` is the size of the collection
+    // as of the last change made to it.
+    void collapse_to_reload(size_t current_size);
+
+    // Get the modification set for the given column, growing `columns` as needed
+    IndexSet& column(size_t col);
+
     void verify();
 };
 } // namespace _impl
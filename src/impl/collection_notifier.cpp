@@ -26,6 +26,15 @@
 using namespace realm;
 using namespace realm::_impl;
 
+void TransactionChangeInfo::reset()
+{
+    table_modifications_needed.clear();
+    table_moves_needed.clear();
+    lists.clear();
+    for (auto& table : tables)
+        table.reset();
+}
+
 std::function<bool (size_t)>
 CollectionNotifier::get_modification_checker(TransactionChangeInfo const& info,
                                              Table const& root_table)
@@ -33,15 +42,38 @@ CollectionNotifier::get_modification_checker(TransactionChangeInfo const& info,
     // First check if any of the tables accessible from the root table were
     // actually modified. This can be false if there were only insertions, or
     // deletions which were not linked to by any row in the linking table
+    if (!any_related_table_modified(info)) {
+        return [](size_t) { return false; };
+    }
+
+    return DeepChangeChecker(info, root_table, *m_related_tables);
+}
+
+bool CollectionNotifier::check_rows_in_parallel(TransactionChangeInfo const& info,
+                                                Table const& root_table,
+                                                std::vector<size_t> const& rows,
+                                                std::vector<char>& modified)
+{
+    std::shared_ptr<Realm> realm;
+    {
+        std::lock_guard<std::mutex> lock(m_realm_mutex);
+        realm = m_realm;
+    }
+    if (!realm || !m_sg)
+        return false;
+    return Realm::Internal::get_coordinator(*realm)
+        .check_rows_in_parallel(m_sg->get_version_of_current_transaction(), info,
+                                root_table.get_index_in_group(), *m_related_tables,
+                                rows, modified);
+}
+
+bool CollectionNotifier::any_related_table_modified(TransactionChangeInfo const& info) const noexcept
+{
     auto table_modified = [&](auto& tbl) {
         return tbl.table_ndx < info.tables.size()
             && !info.tables[tbl.table_ndx].modifications.empty();
     };
-    if (!any_of(begin(m_related_tables), end(m_related_tables), table_modified)) {
-        return [](size_t) { return false; };
-    }
-
-    return DeepChangeChecker(info, root_table, m_related_tables);
+    return any_of(begin(*m_related_tables), end(*m_related_tables), table_modified);
 }
 
 void DeepChangeChecker::find_related_tables(std::vector<RelatedTable>& out, Table const& table)
@@ -155,6 +187,7 @@ bool DeepChangeChecker::operator()(size_t ndx)
 CollectionNotifier::CollectionNotifier(std::shared_ptr<Realm> realm)
 : m_realm(std::move(realm))
 , m_sg_version(Realm::Internal::get_shared_group(*m_realm).get_version_of_current_transaction())
+, m_callbacks(std::make_shared<std::vector<std::shared_ptr<Callback>>>())
 {
 }
 
@@ -169,20 +202,25 @@ size_t CollectionNotifier::add_callback(CollectionChangeCallback callback)
 {
     m_realm->verify_thread();
 
-    auto next_token = [=] {
-        size_t token = 0;
-        for (auto& callback : m_callbacks) {
-            if (token <= callback.token) {
-                token = callback.token + 1;
-            }
+    std::lock_guard<std::mutex> lock(m_callback_mutex);
+    auto& callbacks = *std::atomic_load(&m_callbacks);
+
+    size_t token = 0;
+    for (auto& existing : callbacks) {
+        if (token <= existing->token) {
+            token = existing->token + 1;
         }
-        return token;
-    };
+    }
 
-    std::lock_guard<std::mutex> lock(m_callback_mutex);
-    auto token = next_token();
-    m_callbacks.push_back({std::move(callback), token, false});
-    if (m_callback_index == npos) { // Don't need to wake up if we're already sending notifications
+    auto cb = std::make_shared<Callback>();
+    cb->fn = std::move(callback);
+    cb->token = token;
+
+    auto new_callbacks = std::make_shared<std::vector<std::shared_ptr<Callback>>>(callbacks);
+    new_callbacks->push_back(std::move(cb));
+    std::atomic_store(&m_callbacks, std::move(new_callbacks));
+
+    if (!m_is_sending_notifications) { // Don't need to wake up if we're already sending notifications
         Realm::Internal::get_coordinator(*m_realm).send_commit_notifications();
         m_have_callbacks = true;
     }
@@ -191,28 +229,29 @@ size_t CollectionNotifier::add_callback(CollectionChangeCallback callback)
 
 void CollectionNotifier::remove_callback(size_t token)
 {
-    Callback old;
+    std::shared_ptr<Callback> old;
     {
         std::lock_guard<std::mutex> lock(m_callback_mutex);
-        REALM_ASSERT(m_error || m_callbacks.size() > 0);
+        auto& callbacks = *std::atomic_load(&m_callbacks);
+        REALM_ASSERT(m_error || callbacks.size() > 0);
 
-        auto it = find_if(begin(m_callbacks), end(m_callbacks),
-                          [=](const auto& c) { return c.token == token; });
+        auto it = find_if(begin(callbacks), end(callbacks),
+                          [=](const auto& c) { return c->token == token; });
         // We should only fail to find the callback if it was removed due to an error
-        REALM_ASSERT(m_error || it != end(m_callbacks));
-        if (it == end(m_callbacks)) {
+        REALM_ASSERT(m_error || it != end(callbacks));
+        if (it == end(callbacks)) {
             return;
         }
 
-        size_t idx = distance(begin(m_callbacks), it);
-        if (m_callback_index != npos && m_callback_index >= idx) {
-            --m_callback_index;
-        }
-
-        old = std::move(*it);
-        m_callbacks.erase(it);
+        old = *it;
+        // Mark the callback as removed before publishing the new list so that
+        // an in-progress delivery iterating an older snapshot skips it
+        old->removed = true;
 
-        m_have_callbacks = !m_callbacks.empty();
+        auto new_callbacks = std::make_shared<std::vector<std::shared_ptr<Callback>>>(callbacks);
+        new_callbacks->erase(new_callbacks->begin() + distance(begin(callbacks), it));
+        m_have_callbacks = !new_callbacks->empty();
+        std::atomic_store(&m_callbacks, std::move(new_callbacks));
     }
 }
 
@@ -235,26 +274,46 @@ std::unique_lock<std::mutex> CollectionNotifier::lock_target()
 
 void CollectionNotifier::set_table(Table const& table)
 {
-    m_related_tables.clear();
-    DeepChangeChecker::find_related_tables(m_related_tables, table);
+    m_related_tables = Realm::Internal::get_coordinator(*m_realm).get_related_tables(table);
 }
 
 void CollectionNotifier::add_required_change_info(TransactionChangeInfo& info)
 {
+    m_change_info = nullptr;
     if (!do_add_required_change_info(info)) {
         return;
     }
+    m_change_info = &info;
 
-    auto max = max_element(begin(m_related_tables), end(m_related_tables),
+    auto max = max_element(begin(*m_related_tables), end(*m_related_tables),
                            [](auto&& a, auto&& b) { return a.table_ndx < b.table_ndx; });
 
     if (max->table_ndx >= info.table_modifications_needed.size())
         info.table_modifications_needed.resize(max->table_ndx + 1, false);
-    for (auto& tbl : m_related_tables) {
+    for (auto& tbl : *m_related_tables) {
         info.table_modifications_needed[tbl.table_ndx] = true;
     }
 }
 
+bool CollectionNotifier::any_related_table_changed(TransactionChangeInfo const& info) const noexcept
+{
+    return any_of(begin(*m_related_tables), end(*m_related_tables), [&](auto const& tbl) {
+        return tbl.table_ndx < info.tables.size() && !info.tables[tbl.table_ndx].empty();
+    });
+}
+
+void CollectionNotifier::run()
+{
+    // m_change_info being set means that this notifier asked for change
+    // tracking for this run, which in turn means it has completed its
+    // initial run and so only needs to do anything if something it can
+    // observe actually changed
+    if (m_change_info && !has_out_of_table_changes() && !any_related_table_changed(*m_change_info)) {
+        return;
+    }
+    do_run();
+}
+
 void CollectionNotifier::prepare_handover()
 {
     REALM_ASSERT(m_sg);
@@ -262,29 +321,70 @@ void CollectionNotifier::prepare_handover()
     do_prepare_handover(*m_sg);
 }
 
+template<typename Fn>
+void CollectionNotifier::for_each_callback(Fn&& fn)
+{
+    // Iterate over a snapshot of the callback list taken up front rather than
+    // the live list, so that callbacks added or removed from within a callback
+    // (or from another thread) don't invalidate the iteration. Individual
+    // callbacks are shared with the live list, so the initial_delivered and
+    // removed flags stay in sync between the two.
+    auto snapshot = std::atomic_load(&m_callbacks);
+    m_is_sending_notifications = true;
+    for (auto& callback : *snapshot) {
+        if (callback->removed) {
+            continue;
+        }
+        fn(*callback);
+    }
+    m_is_sending_notifications = false;
+}
+
 void CollectionNotifier::before_advance()
 {
-    while (auto fn = next_callback(!m_changes_to_deliver.empty(), true))
-        fn.before(m_changes_to_deliver);
+    // Hold our own reference to the changeset in case a callback triggers a
+    // nested delivery which replaces m_changes_to_deliver
+    auto changes = m_changes_to_deliver;
+    if (!changes) {
+        return;
+    }
+    bool has_changes = !changes->empty();
+    for_each_callback([&](Callback& callback) {
+        if (callback.initial_delivered && !has_changes) {
+            return;
+        }
+        callback.fn.before(*changes);
+    });
 }
 
 void CollectionNotifier::after_advance()
 {
-    while (auto fn = next_callback(!m_changes_to_deliver.empty(), false))
-        fn.after(m_changes_to_deliver);
-    m_changes_to_deliver = {};
+    auto changes = std::move(m_changes_to_deliver);
+    if (!changes) {
+        return;
+    }
+    bool has_changes = !changes->empty();
+    for_each_callback([&](Callback& callback) {
+        if (callback.initial_delivered && !has_changes) {
+            return;
+        }
+        callback.initial_delivered = true;
+        callback.fn.after(*changes);
+    });
 }
 
 void CollectionNotifier::deliver_error(std::exception_ptr error)
 {
-    while (auto fn = next_callback(true, false)) {
-        fn.error(error);
-    }
+    for_each_callback([&](Callback& callback) {
+        callback.fn.error(error);
+    });
 
     // Remove all the callbacks as we never need to call anything ever again
     // after delivering an error
     std::lock_guard<std::mutex> callback_lock(m_callback_mutex);
-    m_callbacks.clear();
+    std::atomic_store(&m_callbacks,
+                      std::make_shared<std::vector<std::shared_ptr<Callback>>>());
+    m_have_callbacks = false;
     m_error = true;
 }
 
@@ -300,28 +400,10 @@ SharedGroup::VersionID CollectionNotifier::package_for_delivery(Realm& realm)
     if (!prepare_to_deliver()) {
         return SharedGroup::VersionID{};
     }
-    m_changes_to_deliver = std::move(m_accumulated_changes).finalize();
+    m_changes_to_deliver = std::make_shared<CollectionChangeSet const>(std::move(m_accumulated_changes).finalize());
     return version();
 }
 
-CollectionChangeCallback CollectionNotifier::next_callback(bool has_changes, bool pre)
-{
-    std::lock_guard<std::mutex> callback_lock(m_callback_mutex);
-
-    for (++m_callback_index; m_callback_index < m_callbacks.size(); ++m_callback_index) {
-        auto& callback = m_callbacks[m_callback_index];
-        if (callback.initial_delivered && !has_changes) {
-            continue;
-        }
-        if (!pre)
-            callback.initial_delivered = true;
-        return callback.fn;
-    }
-
-    m_callback_index = npos;
-    return nullptr;
-}
-
 void CollectionNotifier::attach_to(SharedGroup& sg)
 {
     REALM_ASSERT(!m_sg);
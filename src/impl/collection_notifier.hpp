@@ -27,6 +27,7 @@
 #include <atomic>
 #include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 
@@ -46,6 +47,12 @@ struct TransactionChangeInfo {
     std::vector<bool> table_moves_needed;
     std::vector<ListChangeInfo> lists;
     std::vector<CollectionChangeBuilder> tables;
+
+    // Reset to the empty state, keeping the allocated buffers so that a
+    // long-lived instance can be reused across notifier runs. An untouched
+    // table keeps its (empty) changeset, which every consumer treats the
+    // same as the table not being present at all.
+    void reset();
 };
 
 class DeepChangeChecker {
@@ -159,7 +166,12 @@ public:
     // transaction advance, and register all required information in it
     void add_required_change_info(TransactionChangeInfo& info);
 
-    virtual void run() = 0;
+    // Perform the notifier's background work if any of the tables it
+    // (transitively) observes were changed by the transactions advanced
+    // over, and otherwise do nothing. In write-heavy apps most commits
+    // don't touch most notifiers' tables, so this check makes those
+    // commits not wake the notifier at all.
+    void run();
     void prepare_handover();
 
     template <typename T>
@@ -173,12 +185,39 @@ protected:
 
     std::function<bool (size_t)> get_modification_checker(TransactionChangeInfo const&, Table const&);
 
+    // Whether any table reachable from the root table via links had rows
+    // modified in the given transaction. When false, no row can possibly
+    // report a modification and per-row checking can be skipped entirely.
+    bool any_related_table_modified(TransactionChangeInfo const&) const noexcept;
+
+    // Run the modification check for each row index in `rows` (rows of
+    // `root_table`) over the coordinator's parallel worker pool, writing one
+    // flag per row into `modified`. Returns false without touching `modified`
+    // if parallel evaluation is disabled or not worthwhile for this batch,
+    // in which case the caller should check the rows serially with
+    // get_modification_checker(). Must be called from the worker thread while
+    // attached to a SharedGroup.
+    bool check_rows_in_parallel(TransactionChangeInfo const&, Table const& root_table,
+                                std::vector<size_t> const& rows, std::vector<char>& modified);
+
+    // The tables which the root table can transitively reach via links, as
+    // set by set_table()
+    std::vector<DeepChangeChecker::RelatedTable> const& related_tables() const noexcept { return *m_related_tables; }
+
 private:
+    virtual void do_run() = 0;
     virtual void do_attach_to(SharedGroup&) = 0;
     virtual void do_detach_from(SharedGroup&) = 0;
     virtual void do_prepare_handover(SharedGroup&) = 0;
     virtual bool do_add_required_change_info(TransactionChangeInfo&) = 0;
     virtual bool prepare_to_deliver() { return true; }
+    // Whether this notifier needs to run even when none of the tables it
+    // observes were changed, due to changes to the collection itself which
+    // are tracked outside of the per-table change info (e.g. LinkList
+    // mutations, which only mark the origin row as modified)
+    virtual bool has_out_of_table_changes() const noexcept { return false; }
+
+    bool any_related_table_changed(TransactionChangeInfo const& info) const noexcept;
 
     mutable std::mutex m_realm_mutex;
     std::shared_ptr<Realm> m_realm;
@@ -188,20 +227,41 @@ private:
 
     bool m_error = false;
     CollectionChangeBuilder m_accumulated_changes;
-    CollectionChangeSet m_changes_to_deliver;
 
-    std::vector<DeepChangeChecker::RelatedTable> m_related_tables;
+    // The changeset passed to callbacks during the current delivery. A single
+    // immutable instance is shared by every callback of this notifier rather
+    // than each one getting its own copy, which matters for the very large
+    // changesets produced by bulk operations. Set in package_for_delivery()
+    // and released once after_advance() has run.
+    std::shared_ptr<CollectionChangeSet const> m_changes_to_deliver;
+
+    // The tables transitively reachable from the root table via links, shared
+    // with the coordinator's cache (see RealmCoordinator::get_related_tables())
+    std::shared_ptr<std::vector<DeepChangeChecker::RelatedTable> const> m_related_tables;
+
+    // The change info for the current notifier run, set if and only if this
+    // notifier requested change info for this run (i.e.
+    // do_add_required_change_info() returned true), and only valid until
+    // the end of that run
+    TransactionChangeInfo const* m_change_info = nullptr;
 
     struct Callback {
         CollectionChangeCallback fn;
-        size_t token;
-        bool initial_delivered;
+        size_t token = 0;
+        bool initial_delivered = false;
+        // Set by remove_callback(). Checked before each invocation during
+        // delivery so that a callback removed after the delivery snapshot
+        // was taken is still never invoked.
+        std::atomic<bool> removed = {false};
     };
 
-    // Currently registered callbacks and a mutex which must always be held
-    // while doing anything with them or m_callback_index
+    // The currently registered callbacks, maintained read-copy-update style:
+    // mutations copy the vector under m_callback_mutex and atomically publish
+    // the new one, while delivery reads an atomic snapshot and iterates it
+    // without holding any lock. The mutex must only be held while mutating;
+    // all reads must go through std::atomic_load().
     std::mutex m_callback_mutex;
-    std::vector<Callback> m_callbacks;
+    std::shared_ptr<std::vector<std::shared_ptr<Callback>>> m_callbacks;
 
     // Cached value for if m_callbacks is empty, needed to avoid deadlocks in
     // run() due to lock-order inversion between m_callback_mutex and m_target_mutex
@@ -209,11 +269,15 @@ private:
     // some extra work.
     std::atomic<bool> m_have_callbacks = {false};
 
-    // Iteration variable for looping over callbacks
-    // remove_callback() updates this when needed
-    size_t m_callback_index = npos;
+    // Whether we're currently delivering notifications on the target thread,
+    // used by add_callback() to avoid redundantly waking up the worker when
+    // a callback is added from within another callback
+    bool m_is_sending_notifications = false;
 
-    CollectionChangeCallback next_callback(bool has_changes, bool pre);
+    // Call `fn` with each callback in the current snapshot which hasn't been
+    // removed, without holding any lock
+    template<typename Fn>
+    void for_each_callback(Fn&& fn);
 };
 
 // A smart pointer to a CollectionNotifier that unregisters the notifier when
@@ -19,6 +19,7 @@
 #include "impl/external_commit_helper.hpp"
 
 #include "impl/realm_coordinator.hpp"
+#include "impl/thread_scheduling.hpp"
 
 #include <realm/commit_log.hpp>
 #include <realm/replication.hpp>
@@ -32,6 +33,7 @@ ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
 , m_sg(*m_history, parent.is_in_memory() ? SharedGroup::durability_MemOnly : SharedGroup::durability_Full,
        parent.get_encryption_key().data())
 , m_thread(std::async(std::launch::async, [=] {
+    apply_worker_thread_scheduling(m_parent.get_config());
     m_sg.begin_read();
     while (m_sg.wait_for_change()) {
         m_sg.end_read();
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/external_commit_helper.hpp"
+#include "impl/realm_coordinator.hpp"
+#include "impl/thread_scheduling.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sstream>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// Sleep until the shared counter no longer holds `expected_value` or another
+// process wakes us. Spurious returns (EINTR, or the counter changing before
+// we go to sleep) are fine because the caller rechecks the counter.
+void futex_wait(std::atomic<uint32_t>* counter, uint32_t expected_value)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(counter),
+            FUTEX_WAIT, expected_value, nullptr, nullptr, 0);
+}
+
+// Wake every process currently futex-waiting on the shared counter
+void futex_wake_all(std::atomic<uint32_t>* counter)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(counter),
+            FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+} // anonymous namespace
+
+void ExternalCommitHelper::FdHolder::close()
+{
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+    m_fd = -1;
+}
+
+ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
+: m_parent(parent)
+{
+    // Create and map the file holding the shared commit counter. Every
+    // process which has the Realm file open maps the same four bytes, so a
+    // plain (non-private) futex on them is visible to all of them.
+    auto path = parent.get_path() + ".note";
+    m_counter_fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_counter_fd == -1) {
+        throw std::system_error(errno, std::system_category());
+    }
+    if (ftruncate(m_counter_fd, sizeof(uint32_t)) == -1) {
+        throw std::system_error(errno, std::system_category());
+    }
+
+    void* addr = mmap(nullptr, sizeof(uint32_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, m_counter_fd, 0);
+    if (addr == MAP_FAILED) {
+        // Filesystem doesn't support shared mappings, so try putting it in
+        // tmp instead. Hash collisions are okay here because they just result
+        // in doing extra work, as opposed to correctness problems
+        std::ostringstream ss;
+
+        const char* tmp = getenv("TMPDIR");
+        std::string tmp_dir(tmp ? tmp : "/tmp");
+        ss << tmp_dir;
+        if (tmp_dir.back() != '/')
+          ss << '/';
+        ss << "realm_" << std::hash<std::string>()(path) << ".note";
+        path = ss.str();
+
+        m_counter_fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (m_counter_fd == -1) {
+            throw std::system_error(errno, std::system_category());
+        }
+        if (ftruncate(m_counter_fd, sizeof(uint32_t)) == -1) {
+            throw std::system_error(errno, std::system_category());
+        }
+        addr = mmap(nullptr, sizeof(uint32_t), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, m_counter_fd, 0);
+        if (addr == MAP_FAILED) {
+            throw std::system_error(errno, std::system_category());
+        }
+    }
+    m_commit_counter = static_cast<std::atomic<uint32_t>*>(addr);
+
+    m_thread = std::thread([=] {
+        try {
+            listen();
+        }
+        catch (std::exception const& e) {
+            fprintf(stderr, "uncaught exception in notifier thread: %s: %s\n", typeid(e).name(), e.what());
+            throw;
+        }
+        catch (...) {
+            fprintf(stderr, "uncaught exception in notifier thread\n");
+            throw;
+        }
+    });
+}
+
+ExternalCommitHelper::~ExternalCommitHelper()
+{
+    m_shutdown.store(true, std::memory_order_release);
+    // This also wakes the listeners in other processes, but they'll see an
+    // unchanged counter and an unset shutdown flag and simply wait again
+    futex_wake_all(m_commit_counter);
+    m_thread.join(); // Wait for the thread to exit
+    munmap(m_commit_counter, sizeof(uint32_t));
+}
+
+void ExternalCommitHelper::listen()
+{
+    pthread_setname_np(pthread_self(), "Realm notification listener");
+    apply_worker_thread_scheduling(m_parent.get_config());
+
+    uint32_t last_seen = m_commit_counter->load(std::memory_order_acquire);
+    while (true) {
+        futex_wait(m_commit_counter, last_seen);
+        if (m_shutdown.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        uint32_t current = m_commit_counter->load(std::memory_order_acquire);
+        if (current == last_seen) {
+            // Spurious wakeup; just wait again
+            continue;
+        }
+        // Only report the newest version rather than once per missed commit;
+        // on_change() always advances all the way to the latest version
+        last_seen = current;
+        m_parent.on_change();
+    }
+}
+
+
+void ExternalCommitHelper::notify_others()
+{
+    m_commit_counter->fetch_add(1, std::memory_order_release);
+    futex_wake_all(m_commit_counter);
+}
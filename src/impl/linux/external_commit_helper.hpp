@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <thread>
+
+namespace realm {
+
+namespace _impl {
+class RealmCoordinator;
+
+class ExternalCommitHelper {
+public:
+    ExternalCommitHelper(RealmCoordinator& parent);
+    ~ExternalCommitHelper();
+
+    void notify_others();
+
+private:
+    // A RAII holder for a file descriptor which automatically closes the wrapped
+    // fd when it's deallocated
+    class FdHolder {
+    public:
+        FdHolder() = default;
+        ~FdHolder() { close(); }
+        operator int() const { return m_fd; }
+
+        FdHolder& operator=(int new_fd) {
+            close();
+            m_fd = new_fd;
+            return *this;
+        }
+
+    private:
+        int m_fd = -1;
+        void close();
+
+        FdHolder& operator=(FdHolder const&) = delete;
+        FdHolder(FdHolder const&) = delete;
+    };
+
+    void listen();
+
+    RealmCoordinator& m_parent;
+
+    // Commit counter shared between every process which has the Realm file
+    // open, mapped from a small file next to the Realm file. It's bumped on
+    // each commit, and the listener threads futex-wait on it rather than
+    // rendezvousing over a named pipe, which cuts the cross-process
+    // notification latency down to a single syscall on each side.
+    std::atomic<uint32_t>* m_commit_counter = nullptr;
+
+    // File descriptor backing the shared mapping
+    FdHolder m_counter_fd;
+
+    // Set to tell the listener thread to shut down. Unlike the commit
+    // notifications this never crosses a process boundary, so a plain
+    // process-local flag checked after each futex wakeup suffices.
+    std::atomic<bool> m_shutdown{false};
+
+    // The listener thread
+    std::thread m_thread;
+};
+
+} // namespace _impl
+} // namespace realm
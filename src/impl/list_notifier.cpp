@@ -80,7 +80,15 @@ bool ListNotifier::do_add_required_change_info(TransactionChangeInfo& info)
     return true;
 }
 
-void ListNotifier::run()
+bool ListNotifier::has_out_of_table_changes() const noexcept
+{
+    // LinkList mutations are tracked in m_change by the transaction advance
+    // itself rather than in the per-table info, and only mark the origin row
+    // (which we don't necessarily observe) as modified
+    return !m_change.empty();
+}
+
+void ListNotifier::do_run()
 {
     if (!m_lv || !m_lv->is_attached()) {
         // LV was deleted, so report all of the rows being removed if this is
@@ -95,19 +103,46 @@ void ListNotifier::run()
         return;
     }
 
-    auto row_did_change = get_modification_checker(*m_info, m_lv->get_target_table());
-    for (size_t i = 0; i < m_lv->size(); ++i) {
-        if (m_change.modifications.contains(i))
-            continue;
-        if (row_did_change(m_lv->get(i).get_index()))
-            m_change.modifications.add(i);
-    }
-
-    for (auto const& move : m_change.moves) {
-        if (m_change.modifications.contains(move.to))
-            continue;
-        if (row_did_change(m_lv->get(move.to).get_index()))
-            m_change.modifications.add(move.to);
+    // Insertions, removals and moves on the list itself are described
+    // exactly by the link-list instructions in the transact log and have
+    // already been applied to m_change by the transaction advance, so
+    // scanning the list is only needed to find modifications to the target
+    // rows. When nothing reachable from the target table was modified there
+    // is nothing to scan for, which keeps purely structural changes to very
+    // large lists O(change) rather than O(list size).
+    if (any_related_table_modified(*m_info)) {
+        size_t size = m_lv->size();
+        std::vector<size_t> target_rows(size);
+        for (size_t i = 0; i < size; ++i)
+            target_rows[i] = m_lv->get(i).get_index();
+
+        std::vector<char> modified;
+        if (check_rows_in_parallel(*m_info, m_lv->get_target_table(), target_rows, modified)) {
+            for (size_t i = 0; i < size; ++i) {
+                if (modified[i])
+                    m_change.modifications.add(i);
+            }
+            for (auto const& move : m_change.moves) {
+                if (modified[move.to])
+                    m_change.modifications.add(move.to);
+            }
+        }
+        else {
+            auto row_did_change = get_modification_checker(*m_info, m_lv->get_target_table());
+            for (size_t i = 0; i < size; ++i) {
+                if (m_change.modifications.contains(i))
+                    continue;
+                if (row_did_change(target_rows[i]))
+                    m_change.modifications.add(i);
+            }
+
+            for (auto const& move : m_change.moves) {
+                if (m_change.modifications.contains(move.to))
+                    continue;
+                if (row_did_change(target_rows[move.to]))
+                    m_change.modifications.add(move.to);
+            }
+        }
     }
 
     m_prev_size = m_lv->size();
@@ -43,7 +43,8 @@ private:
     CollectionChangeBuilder m_change;
     TransactionChangeInfo* m_info;
 
-    void run() override;
+    void do_run() override;
+    bool has_out_of_table_changes() const noexcept override;
 
     void do_prepare_handover(SharedGroup&) override;
 
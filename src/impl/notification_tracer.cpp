@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/notification_tracer.hpp"
+
+#include <atomic>
+#include <chrono>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// A plain function pointer rather than std::function so that installing and
+// invoking the sink is lock-free and allocation-free
+std::atomic<NotificationTraceSink> s_trace_sink{nullptr};
+} // anonymous namespace
+
+void realm::_impl::set_notification_trace_sink(NotificationTraceSink sink) noexcept
+{
+    s_trace_sink.store(sink, std::memory_order_release);
+}
+
+#ifdef REALM_ENABLE_NOTIFICATION_TRACING
+void realm::_impl::trace_notification_stage(NotificationTraceStage stage, uint_fast64_t version) noexcept
+{
+    auto sink = s_trace_sink.load(std::memory_order_acquire);
+    if (!sink) {
+        return;
+    }
+
+    NotificationTraceEvent event;
+    event.stage = stage;
+    event.version = version;
+    event.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    sink(event);
+}
+#endif
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_NOTIFICATION_TRACER_HPP
+#define REALM_NOTIFICATION_TRACER_HPP
+
+#include <cstdint>
+
+namespace realm {
+namespace _impl {
+
+// Trace points for measuring end-to-end notification latency: the time from a
+// write transaction committing to the resulting change notifications being
+// delivered to callbacks on the target threads. Events from the different
+// pipeline stages are correlated by the commit version they refer to, and are
+// reported on whichever thread the stage happens to run on.
+//
+// The trace points are compiled in only when REALM_ENABLE_NOTIFICATION_TRACING
+// is defined, and compile to nothing otherwise. Even when compiled in they
+// cost a single relaxed atomic load per stage until a sink is installed.
+
+// The stage of the notification pipeline at which an event was recorded
+enum class NotificationTraceStage {
+    // A write transaction finished committing on the originating thread
+    Commit,
+    // The background notifier worker pinned its read transaction at (or past)
+    // the commit, i.e. the external-commit signal for it has been acted on
+    CommitObserved,
+    // The background notifier worker finished computing the changesets for
+    // the commit and published them for delivery
+    NotifiersRun,
+    // The changesets for the commit were delivered to the callbacks
+    // registered on one target Realm. Reported once per Realm instance which
+    // has notifiers, not once per commit.
+    Delivery,
+};
+
+struct NotificationTraceEvent {
+    NotificationTraceStage stage;
+    // The version produced by the commit which this event refers to. Events
+    // with the same version describe the same commit's trip through the
+    // pipeline. When commits are coalesced into a single notifier run the
+    // intermediate versions do not get CommitObserved/NotifiersRun events of
+    // their own.
+    uint_fast64_t version;
+    // Time the event was recorded, in microseconds on the same monotonic
+    // clock as std::chrono::steady_clock. Only differences between timestamps
+    // are meaningful.
+    int_fast64_t timestamp_us;
+};
+
+using NotificationTraceSink = void (*)(NotificationTraceEvent const&);
+
+// Install the function which trace events are reported to, replacing any
+// previously installed one, or remove it by passing nullptr. The sink is
+// invoked from arbitrary internal threads (including user threads committing
+// write transactions) and must be cheap and non-blocking; it should hand the
+// event off to the actual tracing system rather than doing any real work.
+//
+// This may be called even when tracing is not compiled in, in which case it
+// has no effect.
+void set_notification_trace_sink(NotificationTraceSink sink) noexcept;
+
+#ifdef REALM_ENABLE_NOTIFICATION_TRACING
+// Report an event for the given stage and commit version to the installed
+// sink, if any
+void trace_notification_stage(NotificationTraceStage stage, uint_fast64_t version) noexcept;
+#else
+inline void trace_notification_stage(NotificationTraceStage, uint_fast64_t) noexcept { }
+#endif
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_NOTIFICATION_TRACER_HPP
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/query_worker_pool.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+QueryWorkerPool::QueryWorkerPool(size_t thread_count, std::function<void ()> thread_init)
+: m_thread_init(std::move(thread_init))
+{
+    m_threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i)
+        m_threads.emplace_back([this] { worker(); });
+}
+
+QueryWorkerPool::~QueryWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void QueryWorkerPool::run(size_t partitions, std::function<void (size_t)> const& fn)
+{
+    if (partitions == 0)
+        return;
+
+    Job job;
+    job.fn = &fn;
+    job.partitions = partitions;
+    job.next_partition = 0;
+    job.remaining = partitions;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+    }
+    m_work_cv.notify_all();
+
+    do_work(job);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // Clear m_job before waiting so that no further workers pick the job
+        // up, then wait both for every partition to have completed and for
+        // every worker which did pick it up to have left do_work(). Waiting
+        // only on `remaining` is not sufficient: the Job lives on this
+        // thread's stack, and a worker touches it again after finishing its
+        // final partition when it loops back to claim the next one.
+        m_job = nullptr;
+        m_done_cv.wait(lock, [&] { return job.remaining.load() == 0 && job.active_workers == 0; });
+    }
+
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+void QueryWorkerPool::worker()
+{
+    if (m_thread_init)
+        m_thread_init();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_shutdown) {
+        if (!m_job || m_job->next_partition.load() >= m_job->partitions) {
+            m_work_cv.wait(lock);
+            continue;
+        }
+
+        Job& job = *m_job;
+        // Claim participation while still holding the mutex so that run()
+        // cannot observe the job as complete and destroy it before this
+        // thread has entered (and left) do_work()
+        ++job.active_workers;
+        lock.unlock();
+        do_work(job);
+        lock.lock();
+        if (--job.active_workers == 0 && job.remaining.load() == 0)
+            m_done_cv.notify_all();
+    }
+}
+
+void QueryWorkerPool::do_work(Job& job)
+{
+    while (true) {
+        size_t partition = job.next_partition.fetch_add(1);
+        if (partition >= job.partitions)
+            return;
+
+        try {
+            (*job.fn)(partition);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!job.error)
+                job.error = std::current_exception();
+        }
+
+        job.remaining.fetch_sub(1);
+    }
+}
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_QUERY_WORKER_POOL_HPP
+#define REALM_QUERY_WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm {
+namespace _impl {
+
+// A small fixed-size fork-join thread pool used to spread partitioned work
+// such as per-row-range query evaluation over multiple cores. Each call to
+// run() blocks the calling thread until every partition has been processed,
+// with the calling thread participating in the work, so a pool of N threads
+// gives N+1 concurrent workers.
+class QueryWorkerPool {
+public:
+    // `thread_init`, if given, is invoked once on each pool thread before it
+    // processes any work, for things like applying scheduling policies. It
+    // is not invoked on calling threads which participate in run().
+    explicit QueryWorkerPool(size_t thread_count, std::function<void ()> thread_init = nullptr);
+    ~QueryWorkerPool();
+
+    QueryWorkerPool(const QueryWorkerPool&) = delete;
+    QueryWorkerPool& operator=(const QueryWorkerPool&) = delete;
+
+    // Number of concurrent workers available, including the calling thread
+    size_t worker_count() const noexcept { return m_threads.size() + 1; }
+
+    // Invoke `fn` once with each partition index in [0, partitions), spread
+    // over the pool's threads and the calling thread, and block until every
+    // invocation has completed. Calls to run() are serialized by the callers
+    // (it must not be called concurrently from multiple threads). If any
+    // invocation throws, the first exception captured is rethrown on the
+    // calling thread after the remaining partitions have been processed.
+    void run(size_t partitions, std::function<void (size_t)> const& fn);
+
+private:
+    struct Job {
+        std::function<void (size_t)> const* fn;
+        size_t partitions;
+        std::atomic<size_t> next_partition;
+        std::atomic<size_t> remaining;
+        // Number of pool threads currently inside do_work() for this job.
+        // Guarded by m_mutex; run() must not return (and so destroy the
+        // stack-allocated Job) until this reaches zero, as workers touch the
+        // Job after completing their final partition.
+        size_t active_workers = 0;
+        std::exception_ptr error;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    Job* m_job = nullptr;
+    bool m_shutdown = false;
+    std::function<void ()> m_thread_init;
+    std::vector<std::thread> m_threads;
+
+    void worker();
+    void do_work(Job& job);
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_QUERY_WORKER_POOL_HPP */
@@ -20,30 +20,54 @@
 
 #include "impl/collection_notifier.hpp"
 #include "impl/external_commit_helper.hpp"
+#include "impl/notification_tracer.hpp"
+#include "impl/query_worker_pool.hpp"
+#include "impl/results_notifier.hpp"
+#include "impl/thread_scheduling.hpp"
 #include "impl/transact_log_handler.hpp"
 #include "impl/weak_realm_notifier.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
 #include "schema.hpp"
+#include "util/event_loop_signal.hpp"
+#include "util/metrics.hpp"
 
 #include <realm/group_shared.hpp>
 #include <realm/lang_bind_helper.hpp>
 #include <realm/string_data.hpp>
+#include <realm/util/file.hpp>
 
 #include <unordered_map>
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 using namespace realm;
 using namespace realm::_impl;
 
-static std::mutex s_coordinator_mutex;
-static std::unordered_map<std::string, std::weak_ptr<RealmCoordinator>> s_coordinators_per_path;
+namespace {
+// The coordinator registry is sharded by path hash so that looking up a
+// coordinator doesn't serialize unrelated threads opening different files
+struct CoordinatorRegistryShard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<RealmCoordinator>> coordinators;
+};
+constexpr size_t s_coordinator_shard_count = 16;
+CoordinatorRegistryShard s_coordinator_shards[s_coordinator_shard_count];
+
+CoordinatorRegistryShard& shard_for_path(StringData path)
+{
+    auto hash = std::hash<std::string>()(std::string(path));
+    return s_coordinator_shards[hash % s_coordinator_shard_count];
+}
+} // anonymous namespace
 
 std::shared_ptr<RealmCoordinator> RealmCoordinator::get_coordinator(StringData path)
 {
-    std::lock_guard<std::mutex> lock(s_coordinator_mutex);
+    auto& shard = shard_for_path(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    auto& weak_coordinator = s_coordinators_per_path[path];
+    auto& weak_coordinator = shard.coordinators[path];
     if (auto coordinator = weak_coordinator.lock()) {
         return coordinator;
     }
@@ -55,15 +79,33 @@ std::shared_ptr<RealmCoordinator> RealmCoordinator::get_coordinator(StringData p
 
 std::shared_ptr<RealmCoordinator> RealmCoordinator::get_existing_coordinator(StringData path)
 {
-    std::lock_guard<std::mutex> lock(s_coordinator_mutex);
-    auto it = s_coordinators_per_path.find(path);
-    return it == s_coordinators_per_path.end() ? nullptr : it->second.lock();
+    auto& shard = shard_for_path(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.coordinators.find(path);
+    return it == shard.coordinators.end() ? nullptr : it->second.lock();
+}
+
+RealmCoordinator::RealmRegistryShard& RealmCoordinator::realm_registry_shard_for_current_thread() noexcept
+{
+    auto hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return m_realm_registry[hash % s_realm_registry_shard_count];
+}
+
+template<typename Fn>
+void RealmCoordinator::for_each_realm_notifier(Fn&& fn)
+{
+    for (auto& shard : m_realm_registry) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& notifier : shard.notifiers) {
+            fn(notifier);
+        }
+    }
 }
 
 std::shared_ptr<Realm> RealmCoordinator::get_realm(Realm::Config config)
 {
     std::lock_guard<std::mutex> lock(m_realm_mutex);
-    if ((!m_config.read_only() && !m_notifier) || (m_config.read_only() && m_weak_realm_notifiers.empty())) {
+    if ((!m_config.read_only() && !m_notifier) || (m_config.read_only() && m_realm_count == 0)) {
         m_config = config;
     }
     else {
@@ -86,7 +128,11 @@ std::shared_ptr<Realm> RealmCoordinator::get_realm(Realm::Config config)
     }
 
     if (config.cache) {
-        for (auto& cached_realm : m_weak_realm_notifiers) {
+        // A Realm is always registered in the shard of the thread which
+        // opened it, so only this thread's shard needs to be searched
+        auto& shard = realm_registry_shard_for_current_thread();
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        for (auto& cached_realm : shard.notifiers) {
             if (cached_realm.is_cached_for_current_thread()) {
                 // can be null if we jumped in between ref count hitting zero and
                 // unregister_realm() getting the lock
@@ -98,6 +144,18 @@ std::shared_ptr<Realm> RealmCoordinator::get_realm(Realm::Config config)
     }
 
     auto realm = Realm::make_shared_realm(std::move(config));
+    if (!m_config.read_only() && !m_config.in_memory && m_realm_count == 0
+        && m_config.should_compact_on_launch_function) {
+        // The new Realm's SharedGroup is the only thing this process
+        // currently has attached to the file, so this is the one point where
+        // compaction can be attempted without tearing everything down first.
+        // compact() returns false (rather than throwing) if another process
+        // has the file open.
+        uint64_t total_bytes = util::File(m_config.path).get_size();
+        if (m_config.should_compact_on_launch_function(total_bytes)) {
+            realm->compact();
+        }
+    }
     if (!config.read_only() && !m_notifier && config.automatic_change_notifications) {
         try {
             m_notifier = std::make_unique<ExternalCommitHelper>(*this);
@@ -108,7 +166,12 @@ std::shared_ptr<Realm> RealmCoordinator::get_realm(Realm::Config config)
     }
     realm->init(shared_from_this());
 
-    m_weak_realm_notifiers.emplace_back(realm, m_config.cache);
+    {
+        auto& shard = realm_registry_shard_for_current_thread();
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        shard.notifiers.emplace_back(realm, m_config.cache);
+        ++m_realm_count;
+    }
     return realm;
 }
 
@@ -117,53 +180,175 @@ std::shared_ptr<Realm> RealmCoordinator::get_realm()
     return get_realm(m_config);
 }
 
-const Schema* RealmCoordinator::get_schema() const noexcept
+namespace {
+struct AsyncOpenDelivery;
+
+// Shared state for an in-progress get_realm_async() call. The background
+// worker populates `error` (if any) and then signals the target thread's
+// event loop. The delivery callback owns the state and the state owns the
+// signal; the cycle is broken when the delivery callback runs.
+struct AsyncOpenState {
+    Realm::Config config;
+    std::function<void (std::shared_ptr<Realm>, std::exception_ptr)> callback;
+    std::exception_ptr error;
+    std::shared_ptr<util::EventLoopSignal<AsyncOpenDelivery>> signal;
+};
+
+struct AsyncOpenDelivery {
+    std::shared_ptr<RealmCoordinator> coordinator;
+    std::shared_ptr<AsyncOpenState> state;
+
+    void operator()()
+    {
+        auto coordinator = std::move(this->coordinator);
+        auto state = std::move(this->state);
+        // Break the ownership cycle. Destroying the signal may destroy
+        // `this`, so only the locals can be used past this point.
+        state->signal.reset();
+
+        std::shared_ptr<Realm> realm;
+        auto error = state->error;
+        if (!error) {
+            try {
+                realm = coordinator->get_realm(std::move(state->config));
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        }
+        state->callback(std::move(realm), std::move(error));
+    }
+};
+} // anonymous namespace
+
+void RealmCoordinator::get_realm_async(Realm::Config config,
+                                       std::function<void (std::shared_ptr<Realm>, std::exception_ptr)> callback)
 {
-    return m_schema_version == uint64_t(-1) ? nullptr : &m_schema;
+    auto state = std::make_shared<AsyncOpenState>();
+    state->config = config;
+    state->callback = std::move(callback);
+    state->signal = std::make_shared<util::EventLoopSignal<AsyncOpenDelivery>>(
+        AsyncOpenDelivery{shared_from_this(), state});
+
+    std::thread([self = shared_from_this(), state, config = std::move(config)]() mutable {
+        try {
+            // Opening a Realm here performs the file open, file format
+            // upgrade, schema initialization and any migration on this
+            // thread. The instance itself is discarded, as Realm instances
+            // are thread-confined; creating another one on the target thread
+            // afterwards is cheap since all of that work is already done.
+            self->get_realm(std::move(config));
+        }
+        catch (...) {
+            state->error = std::current_exception();
+        }
+        state->signal->notify();
+    }).detach();
+}
+
+std::shared_ptr<const Schema> RealmCoordinator::get_schema() const noexcept
+{
+    return m_schema_version == uint64_t(-1) ? nullptr : m_schema;
 }
 
-void RealmCoordinator::update_schema(Schema const& schema, uint64_t schema_version)
+void RealmCoordinator::update_schema(std::shared_ptr<const Schema> schema, uint64_t schema_version,
+                                     uint64_t transaction_version)
 {
-    if (m_schema_version != uint64_t(-1) && m_schema_version != schema_version && m_weak_realm_notifiers.size() > 1) {
+    if (m_schema_version != uint64_t(-1) && m_schema_version != schema_version && m_realm_count > 1) {
         throw MismatchedConfigException("Realm at path '%1' already opened with a different schema version.", m_config.path);
     }
 
-    m_schema = schema;
+    m_schema = std::move(schema);
     m_schema_version = schema_version;
+    m_schema_transaction_version = transaction_version;
+
+    {
+        // The table indexes and link graph may have changed, so any cached
+        // related-table information is no longer valid
+        std::lock_guard<std::mutex> lock(m_related_tables_mutex);
+        m_related_tables_cache.clear();
+    }
 
     // FIXME: notify realms of the schema change
 }
 
+std::shared_ptr<std::vector<DeepChangeChecker::RelatedTable> const>
+RealmCoordinator::get_related_tables(Table const& table)
+{
+    std::lock_guard<std::mutex> lock(m_related_tables_mutex);
+    auto& cached = m_related_tables_cache[table.get_index_in_group()];
+    if (!cached) {
+        auto tables = std::make_shared<std::vector<DeepChangeChecker::RelatedTable>>();
+        DeepChangeChecker::find_related_tables(*tables, table);
+        cached = std::move(tables);
+    }
+    return cached;
+}
+
 RealmCoordinator::RealmCoordinator() = default;
 
 RealmCoordinator::~RealmCoordinator()
 {
-    std::lock_guard<std::mutex> coordinator_lock(s_coordinator_mutex);
-    for (auto it = s_coordinators_per_path.begin(); it != s_coordinators_per_path.end(); ) {
-        if (it->second.expired()) {
-            it = s_coordinators_per_path.erase(it);
-        }
-        else {
-            ++it;
+    // Shut down the write lock waiter thread if it was ever started. This
+    // can block until the current writer finishes if the thread is waiting
+    // on the write lock.
+    {
+        std::lock_guard<std::mutex> lock(m_write_waiter_mutex);
+        m_write_waiter_shutdown = true;
+    }
+    m_write_waiter_cv.notify_one();
+    if (m_write_waiter_thread.joinable()) {
+        m_write_waiter_thread.join();
+    }
+
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> coordinator_lock(shard.mutex);
+        for (auto it = shard.coordinators.begin(); it != shard.coordinators.end(); ) {
+            if (it->second.expired()) {
+                it = shard.coordinators.erase(it);
+            }
+            else {
+                ++it;
+            }
         }
     }
 }
 
 void RealmCoordinator::unregister_realm(Realm* realm)
 {
-    std::lock_guard<std::mutex> lock(m_realm_mutex);
-    auto new_end = remove_if(begin(m_weak_realm_notifiers), end(m_weak_realm_notifiers),
-                             [=](auto& notifier) { return notifier.expired() || notifier.is_for_realm(realm); });
-    m_weak_realm_notifiers.erase(new_end, end(m_weak_realm_notifiers));
+    {
+        std::lock_guard<std::mutex> lock(m_write_waiter_mutex);
+        m_pending_write_requests.erase(remove(begin(m_pending_write_requests), end(m_pending_write_requests), realm),
+                                       end(m_pending_write_requests));
+        m_granted_write_requests.erase(remove(begin(m_granted_write_requests), end(m_granted_write_requests), realm),
+                                       end(m_granted_write_requests));
+    }
+
+    // The Realm is registered in the shard of the thread which opened it,
+    // which isn't necessarily the current thread if the last reference was
+    // released somewhere else, so check each shard until it's found. Expired
+    // entries in the other shards are purged along the way. m_realm_mutex is
+    // deliberately not taken: tearing down a short-lived Realm only contends
+    // with other threads in the same shard, not with every open and close on
+    // the path.
+    for (auto& shard : m_realm_registry) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto new_end = remove_if(begin(shard.notifiers), end(shard.notifiers),
+                                 [=](auto& notifier) { return notifier.expired() || notifier.is_for_realm(realm); });
+        if (new_end != end(shard.notifiers)) {
+            m_realm_count -= end(shard.notifiers) - new_end;
+            shard.notifiers.erase(new_end, end(shard.notifiers));
+        }
+    }
 }
 
 void RealmCoordinator::clear_cache()
 {
     std::vector<WeakRealm> realms_to_close;
-    {
-        std::lock_guard<std::mutex> lock(s_coordinator_mutex);
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        for (auto& weak_coordinator : s_coordinators_per_path) {
+        for (auto& weak_coordinator : shard.coordinators) {
             auto coordinator = weak_coordinator.second.lock();
             if (!coordinator) {
                 continue;
@@ -172,18 +357,18 @@ void RealmCoordinator::clear_cache()
             coordinator->m_notifier = nullptr;
 
             // Gather a list of all of the realms which will be removed
-            for (auto& weak_realm_notifier : coordinator->m_weak_realm_notifiers) {
+            coordinator->for_each_realm_notifier([&](auto& weak_realm_notifier) {
                 if (auto realm = weak_realm_notifier.realm()) {
                     realms_to_close.push_back(realm);
                 }
-            }
+            });
         }
 
-        s_coordinators_per_path.clear();
+        shard.coordinators.clear();
     }
 
     // Close all of the previously cached Realms. This can't be done while
-    // s_coordinator_mutex is held as it may try to re-lock it.
+    // the registry shard mutexes are held as it may try to re-lock them.
     for (auto& weak_realm : realms_to_close) {
         if (auto realm = weak_realm.lock()) {
             realm->close();
@@ -194,9 +379,9 @@ void RealmCoordinator::clear_cache()
 void RealmCoordinator::clear_all_caches()
 {
     std::vector<std::weak_ptr<RealmCoordinator>> to_clear;
-    {
-        std::lock_guard<std::mutex> lock(s_coordinator_mutex);
-        for (auto iter : s_coordinators_per_path) {
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto iter : shard.coordinators) {
             to_clear.push_back(iter.second);
         }
     }
@@ -262,8 +447,55 @@ void RealmCoordinator::register_notifier(std::shared_ptr<CollectionNotifier> not
     }
 }
 
+std::shared_ptr<ResultsNotifier> RealmCoordinator::notifier_for_results(Results& target,
+                                                                        size_t shared_table_ndx)
+{
+    auto realm = target.get_realm();
+    auto& self = Realm::Internal::get_coordinator(*realm);
+
+    if (shared_table_ndx != npos) {
+        std::lock_guard<std::mutex> lock(self.m_notifier_mutex);
+        auto& shareable = self.m_shareable_notifiers;
+        for (size_t i = 0; i < shareable.size(); ) {
+            auto notifier = shareable[i].lock();
+            if (!notifier) {
+                shareable.erase(shareable.begin() + i);
+                continue;
+            }
+            if (notifier->can_deliver_to(realm.get(), shared_table_ndx, target.move_tracking_enabled())) {
+                notifier->add_target(target);
+                return notifier;
+            }
+            ++i;
+        }
+    }
+
+    auto notifier = std::make_shared<ResultsNotifier>(target, shared_table_ndx);
+    if (shared_table_ndx != npos) {
+        std::lock_guard<std::mutex> lock(self.m_notifier_mutex);
+        self.m_shareable_notifiers.push_back(notifier);
+    }
+    register_notifier(notifier);
+    return notifier;
+}
+
 void RealmCoordinator::clean_up_dead_notifiers()
 {
+    auto unassign_shard = [&](CollectionNotifier* notifier) {
+        auto it = m_notifier_shards.find(notifier);
+        if (it == m_notifier_shards.end())
+            return;
+        size_t shard = it->second;
+        m_notifier_shards.erase(it);
+        // As with m_notifier_sg below, release the read version when a
+        // shard's last notifier goes away, but keep the SharedGroup open
+        if (--m_notifier_shard_counts[shard] == 0 && shard > 0) {
+            auto& sg = *m_notifier_shard_sgs[shard - 1];
+            REALM_ASSERT_3(sg.get_transact_stage(), ==, SharedGroup::transact_Reading);
+            sg.end_read();
+        }
+    };
+
     auto swap_remove = [&](auto& container) {
         bool did_remove = false;
         for (size_t i = 0; i < container.size(); ++i) {
@@ -273,6 +505,7 @@ void RealmCoordinator::clean_up_dead_notifiers()
             // Ensure the notifier is destroyed here even if there's lingering refs
             // to the async notifier elsewhere
             container[i]->release_data();
+            unassign_shard(container[i].get());
 
             if (container.size() > i + 1)
                 container[i] = std::move(container.back());
@@ -300,14 +533,143 @@ void RealmCoordinator::clean_up_dead_notifiers()
     }
 }
 
+namespace {
+uint64_t steady_now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // anonymous namespace
+
+void RealmCoordinator::async_request_write_lock(Realm& realm)
+{
+    std::lock_guard<std::mutex> lock(m_write_waiter_mutex);
+    if (find(begin(m_pending_write_requests), end(m_pending_write_requests), &realm) != end(m_pending_write_requests)) {
+        return;
+    }
+    m_pending_write_requests.push_back(&realm);
+    if (!m_write_waiter_thread.joinable()) {
+        m_write_waiter_thread = std::thread([this] { write_lock_waiter_loop(); });
+    }
+    m_write_waiter_cv.notify_one();
+}
+
+bool RealmCoordinator::take_granted_write_request(Realm* realm)
+{
+    std::lock_guard<std::mutex> lock(m_write_waiter_mutex);
+    auto it = find(begin(m_granted_write_requests), end(m_granted_write_requests), realm);
+    if (it == end(m_granted_write_requests)) {
+        return false;
+    }
+    m_granted_write_requests.erase(it);
+    return true;
+}
+
+void RealmCoordinator::write_lock_waiter_loop()
+{
+    apply_worker_thread_scheduling(m_config);
+
+    std::unique_lock<std::mutex> lock(m_write_waiter_mutex);
+    while (true) {
+        m_write_waiter_cv.wait(lock, [&] {
+            return m_write_waiter_shutdown || !m_pending_write_requests.empty();
+        });
+        if (m_write_waiter_shutdown) {
+            return;
+        }
+
+        auto requests = std::move(m_pending_write_requests);
+        m_pending_write_requests = {};
+        lock.unlock();
+
+        if (!m_write_waiter_sg) {
+            try {
+                std::unique_ptr<Group> read_only_group;
+                Realm::open_with_config(m_config, m_write_waiter_history, m_write_waiter_sg, read_only_group, nullptr);
+            }
+            catch (...) {
+                // Grant the requests without waiting; the requesting threads
+                // will surface the error (or block) when they begin their
+                // write transactions
+                m_write_waiter_sg = nullptr;
+                m_write_waiter_history = nullptr;
+            }
+        }
+
+        // Wait for the write lock to become available by acquiring and
+        // immediately releasing it. The lock itself can't be handed over to
+        // the requesting thread, so a different writer can still beat the
+        // requesting thread to it, but the requesting thread's
+        // begin_transaction() will normally be uncontended.
+        if (m_write_waiter_sg) {
+            try {
+                m_write_waiter_sg->begin_write();
+                m_write_waiter_sg->rollback();
+            }
+            catch (...) {
+                // Grant the requests anyway and let the requesting threads
+                // surface the error from their own begin_transaction()
+            }
+        }
+
+        // Record the grants and signal each requesting Realm's thread via
+        // its event loop. Realms which were closed while we were waiting are
+        // no longer registered and are simply dropped.
+        {
+            std::lock_guard<std::mutex> waiter_lock(m_write_waiter_mutex);
+            for (auto realm : requests) {
+                for (auto& shard : m_realm_registry) {
+                    std::lock_guard<std::mutex> realm_lock(shard.mutex);
+                    auto it = find_if(begin(shard.notifiers), end(shard.notifiers),
+                                      [=](auto& notifier) { return notifier.is_for_realm(realm); });
+                    if (it == end(shard.notifiers))
+                        continue;
+                    if (find(begin(m_granted_write_requests), end(m_granted_write_requests), realm) == end(m_granted_write_requests)) {
+                        m_granted_write_requests.push_back(realm);
+                    }
+                    it->notify();
+                    break;
+                }
+            }
+        }
+        lock.lock();
+    }
+}
+
+void RealmCoordinator::record_begin_transaction_time(uint64_t time_us) noexcept
+{
+    m_transaction_metrics.begin_count.fetch_add(1, std::memory_order_relaxed);
+    m_transaction_metrics.total_begin_time_us.fetch_add(time_us, std::memory_order_relaxed);
+    m_transaction_metrics.last_begin_time_us.store(time_us, std::memory_order_relaxed);
+}
+
+void RealmCoordinator::record_commit_transaction_time(uint64_t time_us) noexcept
+{
+    m_transaction_metrics.commit_count.fetch_add(1, std::memory_order_relaxed);
+    m_transaction_metrics.total_commit_time_us.fetch_add(time_us, std::memory_order_relaxed);
+    m_transaction_metrics.last_commit_time_us.store(time_us, std::memory_order_relaxed);
+}
+
 void RealmCoordinator::on_change()
 {
+    m_last_commit_signal_us.store(steady_now_us(), std::memory_order_relaxed);
+
+    // Coalesce bursts of commits into a single notifier run. Each run
+    // advances the notifiers to the latest version, so anything committed
+    // while we wait here is picked up by the same diff computation instead
+    // of getting its own run against an intermediate version.
+    if (m_config.notifier_coalescing_window_ms > 0) {
+        auto window = std::chrono::milliseconds(m_config.notifier_coalescing_window_ms);
+        auto elapsed = std::chrono::steady_clock::now() - m_last_notifier_run;
+        if (elapsed < window) {
+            std::this_thread::sleep_for(window - elapsed);
+        }
+        m_last_notifier_run = std::chrono::steady_clock::now();
+    }
+
     run_async_notifiers();
 
-    std::lock_guard<std::mutex> lock(m_realm_mutex);
-    for (auto& realm : m_weak_realm_notifiers) {
-        realm.notify();
-    }
+    for_each_realm_notifier([](auto& realm) { realm.notify(); });
 }
 
 namespace {
@@ -315,8 +677,9 @@ class IncrementalChangeInfo {
 public:
     IncrementalChangeInfo(SharedGroup& sg,
                           SchemaMode schema_mode,
-                          std::vector<std::shared_ptr<_impl::CollectionNotifier>>& notifiers)
-    : m_sg(sg), m_schema_mode(schema_mode)
+                          std::vector<std::shared_ptr<_impl::CollectionNotifier>>& notifiers,
+                          std::vector<TransactionChangeInfo>& storage)
+    : m_info(storage), m_sg(sg), m_schema_mode(schema_mode)
     {
         if (notifiers.empty())
             return;
@@ -329,15 +692,19 @@ public:
         // all forward to the latest version in a single pass over the transaction log
         std::sort(notifiers.begin(), notifiers.end(), cmp);
 
-        // Preallocate the required amount of space in the vector so that we can
-        // safely give out pointers to within the vector
+        // Size the vector to the exact number of infos needed up front so that
+        // we can safely give out pointers to within the vector. The storage
+        // outlives this object (see RealmCoordinator::m_notifier_change_info),
+        // so in steady state this just resets the infos left over from the
+        // previous run and reuses their buffers rather than allocating
         size_t count = 1;
         for (auto it = notifiers.begin(), next = it + 1; next != notifiers.end(); ++it, ++next) {
             if (cmp(*it, *next))
                 ++count;
         }
-        m_info.reserve(count);
-        m_info.resize(1);
+        m_info.resize(count);
+        for (auto& info : m_info)
+            info.reset();
         m_current = &m_info[0];
     }
 
@@ -347,11 +714,11 @@ public:
     {
         if (version != m_sg.get_version_of_current_transaction()) {
             transaction::advance(m_sg, *m_current, version);
-            m_info.push_back({
-                m_current->table_modifications_needed,
-                m_current->table_moves_needed,
-                std::move(m_current->lists)});
-            m_current = &m_info.back();
+            auto& next = m_info[++m_current_ndx];
+            next.table_modifications_needed = m_current->table_modifications_needed;
+            next.table_moves_needed = m_current->table_moves_needed;
+            next.lists = std::move(m_current->lists);
+            m_current = &next;
             return true;
         }
         return false;
@@ -400,8 +767,9 @@ public:
     }
 
 private:
-    std::vector<TransactionChangeInfo> m_info;
+    std::vector<TransactionChangeInfo>& m_info;
     TransactionChangeInfo* m_current = nullptr;
+    size_t m_current_ndx = 0;
     SharedGroup& m_sg;
     SchemaMode m_schema_mode;
 };
@@ -431,7 +799,8 @@ void RealmCoordinator::run_async_notifiers()
 
     // Advance all of the new notifiers to the most recent version, if any
     auto new_notifiers = std::move(m_new_notifiers);
-    IncrementalChangeInfo new_notifier_change_info(*m_advancer_sg, m_config.schema_mode, new_notifiers);
+    IncrementalChangeInfo new_notifier_change_info(*m_advancer_sg, m_config.schema_mode, new_notifiers,
+                                                   m_new_notifier_change_info);
 
     if (!new_notifiers.empty()) {
         REALM_ASSERT_3(m_advancer_sg->get_transact_stage(), ==, SharedGroup::transact_Reading);
@@ -440,8 +809,11 @@ void RealmCoordinator::run_async_notifiers()
 
         // The advancer SG can be at an older version than the oldest new notifier
         // if a notifier was added and then removed before it ever got the chance
-        // to run, as we don't move the pin forward when removing dead notifiers
-        transaction::advance(*m_advancer_sg, nullptr, m_config.schema_mode, new_notifiers.front()->version());
+        // to run, as we don't move the pin forward when removing dead notifiers.
+        // The versions being skipped over have already been validated by the
+        // SG which the notifier was handed over from, so the logs don't need
+        // to be parsed again here
+        transaction::advance_without_validation(*m_advancer_sg, new_notifiers.front()->version());
 
         // Advance each of the new notifiers to the latest version, attaching them
         // to the SG at their handover version. This requires a unique
@@ -472,24 +844,69 @@ void RealmCoordinator::run_async_notifiers()
 
     // Advance the non-new notifiers to the same version as we advanced the new
     // ones to (or the latest if there were no new ones)
-    IncrementalChangeInfo change_info(*m_notifier_sg, m_config.schema_mode, notifiers);
+    IncrementalChangeInfo change_info(*m_notifier_sg, m_config.schema_mode, notifiers,
+                                      m_notifier_change_info);
     for (auto& notifier : notifiers) {
         notifier->add_required_change_info(change_info.current());
     }
     change_info.advance_to_final(version);
 
-    // Attach the new notifiers to the main SG and move them to the main list
+    auto run_version = m_notifier_sg->get_version_of_current_transaction().version;
+    trace_notification_stage(NotificationTraceStage::CommitObserved, run_version);
+
+    // Advance the shard SharedGroups which have notifiers attached to the
+    // same version as the main notifier SG so that every notifier sees the
+    // same data when it runs. The main notifier SG just validated this exact
+    // version span, so the shards don't need to parse the logs a second
+    // (or fifth) time
+    for (size_t i = 0; i < m_notifier_shard_sgs.size(); ++i) {
+        if (m_notifier_shard_counts[i + 1] > 0) {
+            transaction::advance_without_validation(*m_notifier_shard_sgs[i],
+                                                    m_notifier_sg->get_version_of_current_transaction());
+        }
+    }
+
+    // Attach the new notifiers to their shard's SG and move them to the main list
     for (auto& notifier : new_notifiers) {
-        notifier->attach_to(*m_notifier_sg);
+        notifier->attach_to(assign_notifier_shard(*notifier));
     }
     std::move(new_notifiers.begin(), new_notifiers.end(), std::back_inserter(notifiers));
 
+    m_last_run_version.store(run_version, std::memory_order_relaxed);
+
     // Change info is now all ready, so the notifiers can now perform their
-    // background work
-    for (auto& notifier : notifiers) {
-        notifier->run();
+    // background work. Notifiers in different shards don't share any
+    // accessors and so can safely run concurrently.
+    auto run_start = steady_now_us();
+    size_t shard_count = std::max<size_t>(m_config.parallel_notifier_thread_count, 1);
+    if (shard_count < 2) {
+        for (auto& notifier : notifiers) {
+            notifier->run();
+        }
+    }
+    else {
+        std::vector<std::vector<CollectionNotifier*>> shards(shard_count);
+        for (auto& notifier : notifiers)
+            shards[m_notifier_shards.at(notifier.get())].push_back(notifier.get());
+
+        if (!m_notifier_pool) {
+            m_notifier_pool = std::make_unique<QueryWorkerPool>(shard_count - 1,
+                [this] { apply_worker_thread_scheduling(m_config); });
+        }
+        m_notifier_pool->run(shard_count, [&](size_t shard) {
+            for (auto* notifier : shards[shard])
+                notifier->run();
+        });
     }
 
+    auto run_time = steady_now_us() - run_start;
+    util::g_metric_counters.notifier_runs.fetch_add(1, std::memory_order_relaxed);
+    m_notifier_metrics.run_count.fetch_add(1, std::memory_order_relaxed);
+    m_notifier_metrics.notifiers_run.fetch_add(notifiers.size(), std::memory_order_relaxed);
+    m_notifier_metrics.total_run_time_us.fetch_add(run_time, std::memory_order_relaxed);
+    m_notifier_metrics.last_run_time_us.store(run_time, std::memory_order_relaxed);
+    m_notifier_metrics.last_queue_depth.store(notifiers.size(), std::memory_order_relaxed);
+
     // Reacquire the lock while updating the fields that are actually read on
     // other threads
     lock.lock();
@@ -498,6 +915,8 @@ void RealmCoordinator::run_async_notifiers()
     }
     m_notifiers = std::move(notifiers);
     clean_up_dead_notifiers();
+
+    trace_notification_stage(NotificationTraceStage::NotifiersRun, run_version);
 }
 
 void RealmCoordinator::open_helper_shared_group()
@@ -521,6 +940,45 @@ void RealmCoordinator::open_helper_shared_group()
     }
 }
 
+SharedGroup& RealmCoordinator::assign_notifier_shard(CollectionNotifier& notifier)
+{
+    size_t shard_count = std::max<size_t>(m_config.parallel_notifier_thread_count, 1);
+    size_t shard = m_next_notifier_shard % shard_count;
+
+    if (shard > 0) {
+        try {
+            while (m_notifier_shard_sgs.size() < shard) {
+                std::unique_ptr<Replication> history;
+                std::unique_ptr<SharedGroup> sg;
+                std::unique_ptr<Group> read_only_group;
+                Realm::open_with_config(m_config, history, sg, read_only_group, nullptr);
+                REALM_ASSERT(!read_only_group);
+                m_notifier_shard_histories.push_back(std::move(history));
+                m_notifier_shard_sgs.push_back(std::move(sg));
+            }
+        }
+        catch (...) {
+            // If we can't open the shard's SharedGroup then just run this
+            // notifier on the main one
+            shard = 0;
+        }
+    }
+
+    ++m_next_notifier_shard;
+    if (m_notifier_shard_counts.size() < shard_count)
+        m_notifier_shard_counts.resize(shard_count);
+    m_notifier_shards[&notifier] = shard;
+    bool was_empty = m_notifier_shard_counts[shard]++ == 0;
+
+    if (shard == 0)
+        return *m_notifier_sg;
+
+    auto& sg = *m_notifier_shard_sgs[shard - 1];
+    if (was_empty)
+        sg.begin_read(m_notifier_sg->get_version_of_current_transaction());
+    return sg;
+}
+
 
 std::vector<std::shared_ptr<_impl::CollectionNotifier>> RealmCoordinator::notifiers_to_deliver(Realm& realm)
 {
@@ -545,12 +1003,49 @@ std::vector<std::shared_ptr<_impl::CollectionNotifier>> RealmCoordinator::notifi
     return notifiers;
 }
 
-void RealmCoordinator::advance_to_ready(Realm& realm)
+void RealmCoordinator::advance_read(Realm& realm, SharedGroup::VersionID version)
+{
+    auto& sg = Realm::Internal::get_shared_group(realm);
+    auto begin_version = sg.get_version_of_current_transaction().version;
+
+    // If another Realm on this path has already validated the span we're
+    // about to advance over, the logs don't need to be parsed again just to
+    // re-validate them
+    util::Optional<SchemaMode> schema_mode = m_config.schema_mode;
+    if (version != SharedGroup::VersionID{}) {
+        std::lock_guard<std::mutex> lock(m_validated_versions_mutex);
+        if (m_validated_end_version != 0
+            && begin_version >= m_validated_begin_version
+            && version.version <= m_validated_end_version) {
+            schema_mode = util::none;
+        }
+    }
+
+    transaction::advance(sg, realm.m_binding_context.get(), schema_mode, version);
+
+    // Record the newly-validated span for the benefit of the other Realms.
+    // With no binding context nothing was parsed at all, so there's nothing
+    // to record
+    if (schema_mode && realm.m_binding_context) {
+        auto end_version = sg.get_version_of_current_transaction().version;
+        std::lock_guard<std::mutex> lock(m_validated_versions_mutex);
+        if (m_validated_end_version == 0) {
+            m_validated_begin_version = begin_version;
+            m_validated_end_version = end_version;
+        }
+        else if (begin_version <= m_validated_end_version && end_version >= m_validated_begin_version) {
+            m_validated_begin_version = std::min(m_validated_begin_version, begin_version);
+            m_validated_end_version = std::max(m_validated_end_version, end_version);
+        }
+    }
+}
+
+void RealmCoordinator::advance_to_ready(Realm& realm, std::chrono::steady_clock::time_point deadline)
 {
     auto& sg = Realm::Internal::get_shared_group(realm);
     auto notifiers = notifiers_to_deliver(realm);
     if (notifiers.empty()) {
-        transaction::advance(sg, realm.m_binding_context.get(), m_config.schema_mode);
+        advance_read(realm);
         return;
     }
 
@@ -560,14 +1055,15 @@ void RealmCoordinator::advance_to_ready(Realm& realm)
 
     for (auto& notifier : notifiers)
         notifier->before_advance();
-    transaction::advance(sg, realm.m_binding_context.get(), m_config.schema_mode, version);
+    advance_read(realm, version);
     for (auto& notifier : notifiers)
         notifier->deliver(sg);
-    for (auto& notifier : notifiers)
-        notifier->after_advance();
+    record_delivery_metrics(version.version);
+    trace_notification_stage(NotificationTraceStage::Delivery, version.version);
+    finish_delivery(realm, std::move(notifiers), deadline);
 }
 
-void RealmCoordinator::process_available_async(Realm& realm)
+void RealmCoordinator::process_available_async(Realm& realm, std::chrono::steady_clock::time_point deadline)
 {
     auto notifiers = notifiers_to_deliver(realm);
     if (notifiers.empty())
@@ -580,6 +1076,337 @@ void RealmCoordinator::process_available_async(Realm& realm)
 
     for (auto& notifier : notifiers)
         notifier->deliver(sg);
-    for (auto& notifier : notifiers)
-        notifier->after_advance();
+    record_delivery_metrics(version.version);
+    trace_notification_stage(NotificationTraceStage::Delivery, version.version);
+    finish_delivery(realm, std::move(notifiers), deadline);
+}
+
+void RealmCoordinator::finish_delivery(Realm& realm, std::vector<std::shared_ptr<_impl::CollectionNotifier>> notifiers,
+                                       std::chrono::steady_clock::time_point deadline)
+{
+    for (size_t i = 0; i < notifiers.size(); ++i) {
+        notifiers[i]->after_advance();
+        if (i + 1 < notifiers.size() && std::chrono::steady_clock::now() >= deadline) {
+            // The new changes have all been applied to the Realm at this
+            // point, so deferring the remaining callbacks just spreads the
+            // "did change" notifications over multiple event loop
+            // iterations; each notifier's changeset is retained until its
+            // after_advance() runs
+            auto& deferred = Realm::Internal::get_deferred_notifiers(realm);
+            deferred.insert(deferred.end(), std::make_move_iterator(notifiers.begin() + i + 1),
+                            std::make_move_iterator(notifiers.end()));
+            for_each_realm_notifier([&](WeakRealmNotifier& weak_notifier) {
+                if (weak_notifier.is_for_realm(&realm))
+                    weak_notifier.notify();
+            });
+            return;
+        }
+    }
+}
+
+void RealmCoordinator::record_delivery_metrics(uint_fast64_t delivered_version)
+{
+    auto latest = m_last_run_version.load(std::memory_order_relaxed);
+    auto behind = latest > delivered_version ? latest - delivered_version : 0;
+    m_notifier_metrics.last_versions_behind.store(behind, std::memory_order_relaxed);
+
+    if (auto signal = m_last_commit_signal_us.load(std::memory_order_relaxed)) {
+        m_notifier_metrics.last_signal_to_deliver_us.store(steady_now_us() - signal,
+                                                           std::memory_order_relaxed);
+    }
+}
+
+bool RealmCoordinator::evaluate_query_in_parallel(Realm& realm, Query& query, size_t row_count,
+                                                  std::function<void (Query&, size_t, size_t)> const& fn)
+{
+    size_t thread_count = m_config.parallel_query_thread_count;
+    if (thread_count < 2 || m_config.read_only())
+        return false;
+    // Handover requires a stable read transaction to export from
+    if (!realm.is_in_read_transaction() || realm.is_in_transaction())
+        return false;
+
+    // Below this many rows per worker the handover and thread wakeup overhead
+    // outweighs the scan time, so shrink the partition count to match and
+    // fall back entirely for small tables
+    static const size_t min_rows_per_partition = 8192;
+    size_t partitions = std::min(thread_count, row_count / min_rows_per_partition);
+    if (partitions < 2)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_query_worker_mutex);
+    try {
+        if (!m_query_worker_pool)
+            m_query_worker_pool = std::make_unique<QueryWorkerPool>(thread_count - 1,
+                [this] { apply_worker_thread_scheduling(m_config); });
+        while (m_query_worker_sgs.size() < partitions) {
+            std::unique_ptr<Replication> history;
+            std::unique_ptr<SharedGroup> sg;
+            std::unique_ptr<Group> read_only_group;
+            Realm::open_with_config(m_config, history, sg, read_only_group, nullptr);
+            REALM_ASSERT(!read_only_group);
+            m_query_worker_histories.push_back(std::move(history));
+            m_query_worker_sgs.push_back(std::move(sg));
+        }
+
+        auto& source_sg = Realm::Internal::get_shared_group(realm);
+        auto version = source_sg.get_version_of_current_transaction();
+
+        // Each worker needs its own clone of the query attached to its own
+        // SharedGroup, which requires one handover object per worker
+        std::vector<std::unique_ptr<Query>> queries(partitions);
+        for (size_t i = 0; i < partitions; ++i) {
+            Query copy(query);
+            auto handover = source_sg.export_for_handover(copy, MutableSourcePayload::Move);
+            auto& sg = *m_query_worker_sgs[i];
+            sg.begin_read(version);
+            queries[i] = sg.import_from_handover(std::move(handover));
+        }
+
+        size_t rows_per_partition = (row_count + partitions - 1) / partitions;
+        m_query_worker_pool->run(partitions, [&](size_t partition) {
+            size_t begin = partition * rows_per_partition;
+            size_t end = std::min(begin + rows_per_partition, row_count);
+            if (begin < end)
+                fn(*queries[partition], begin, end);
+        });
+
+        // Release the read locks, but keep the SharedGroups open for reuse
+        for (size_t i = 0; i < partitions; ++i) {
+            queries[i] = nullptr;
+            m_query_worker_sgs[i]->end_read();
+        }
+        return true;
+    }
+    catch (...) {
+        // Some of the worker SharedGroups may be left with a dangling read
+        // transaction, so just drop them all and let the caller evaluate on
+        // its own thread (which will also surface any error from `fn`)
+        m_query_worker_sgs.clear();
+        m_query_worker_histories.clear();
+        return false;
+    }
+}
+
+bool RealmCoordinator::for_each_row_range_in_parallel(Realm& realm, size_t table_ndx, size_t row_count,
+                                                      std::function<void (Table const&, size_t, size_t)> const& fn)
+{
+    size_t thread_count = m_config.parallel_migration_thread_count;
+    if (thread_count < 2 || m_config.read_only())
+        return false;
+    if (!realm.is_in_read_transaction() || realm.is_in_transaction())
+        return false;
+
+    // Per-row transformations are typically much more expensive than query
+    // scans, so the partitioning threshold is correspondingly lower than
+    // evaluate_query_in_parallel()'s
+    static const size_t min_rows_per_partition = 1024;
+    size_t partitions = std::min(thread_count, row_count / min_rows_per_partition);
+    if (partitions < 2)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_query_worker_mutex);
+    try {
+        if (!m_query_worker_pool)
+            m_query_worker_pool = std::make_unique<QueryWorkerPool>(thread_count - 1,
+                [this] { apply_worker_thread_scheduling(m_config); });
+        while (m_query_worker_sgs.size() < partitions) {
+            std::unique_ptr<Replication> history;
+            std::unique_ptr<SharedGroup> sg;
+            std::unique_ptr<Group> read_only_group;
+            Realm::open_with_config(m_config, history, sg, read_only_group, nullptr);
+            REALM_ASSERT(!read_only_group);
+            m_query_worker_histories.push_back(std::move(history));
+            m_query_worker_sgs.push_back(std::move(sg));
+        }
+
+        auto version = Realm::Internal::get_shared_group(realm).get_version_of_current_transaction();
+        std::vector<Group const*> groups(partitions);
+        for (size_t i = 0; i < partitions; ++i) {
+            groups[i] = &m_query_worker_sgs[i]->begin_read(version);
+        }
+
+        size_t rows_per_partition = (row_count + partitions - 1) / partitions;
+        m_query_worker_pool->run(partitions, [&](size_t partition) {
+            size_t begin = partition * rows_per_partition;
+            size_t end = std::min(begin + rows_per_partition, row_count);
+            if (begin < end)
+                fn(*groups[partition]->get_table(table_ndx), begin, end);
+        });
+
+        // Release the read locks, but keep the SharedGroups open for reuse
+        for (size_t i = 0; i < partitions; ++i) {
+            m_query_worker_sgs[i]->end_read();
+        }
+        return true;
+    }
+    catch (...) {
+        m_query_worker_sgs.clear();
+        m_query_worker_histories.clear();
+        return false;
+    }
+}
+
+bool RealmCoordinator::check_rows_in_parallel(SharedGroup::VersionID version,
+                                              TransactionChangeInfo const& info,
+                                              size_t root_table_ndx,
+                                              std::vector<DeepChangeChecker::RelatedTable> const& related_tables,
+                                              std::vector<size_t> const& rows,
+                                              std::vector<char>& modified)
+{
+    size_t thread_count = m_config.parallel_query_thread_count;
+    if (thread_count < 2 || m_config.read_only())
+        return false;
+
+    // Deep checks are much more expensive per row than a query scan and the
+    // cost varies with the depth of each row's link graph, so use smaller
+    // partitions and more of them than there are workers: the pool's dynamic
+    // partition claiming then balances the uneven partitions over the threads
+    static const size_t min_rows_per_partition = 1024;
+    size_t partitions = std::min(thread_count * 4, rows.size() / min_rows_per_partition);
+    if (partitions < 2)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_query_worker_mutex);
+    try {
+        if (!m_query_worker_pool)
+            m_query_worker_pool = std::make_unique<QueryWorkerPool>(thread_count - 1,
+                [this] { apply_worker_thread_scheduling(m_config); });
+        while (m_query_worker_sgs.size() < partitions) {
+            std::unique_ptr<Replication> history;
+            std::unique_ptr<SharedGroup> sg;
+            std::unique_ptr<Group> read_only_group;
+            Realm::open_with_config(m_config, history, sg, read_only_group, nullptr);
+            REALM_ASSERT(!read_only_group);
+            m_query_worker_histories.push_back(std::move(history));
+            m_query_worker_sgs.push_back(std::move(sg));
+        }
+
+        modified.assign(rows.size(), 0);
+        size_t rows_per_partition = (rows.size() + partitions - 1) / partitions;
+        m_query_worker_pool->run(partitions, [&](size_t partition) {
+            size_t begin = partition * rows_per_partition;
+            size_t end = std::min(begin + rows_per_partition, rows.size());
+            if (begin >= end)
+                return;
+
+            // Each partition reads through its own SharedGroup so that the
+            // Table accessors instantiated while traversing links don't race
+            // with the other partitions', and uses its own checker so that
+            // the per-checker not-modified caches need no locking (they stay
+            // effective within the partition's contiguous row range)
+            auto& sg = *m_query_worker_sgs[partition];
+            Group const& group = sg.begin_read(version);
+            DeepChangeChecker checker(info, *group.get_table(root_table_ndx), related_tables);
+            for (size_t i = begin; i < end; ++i)
+                modified[i] = checker(rows[i]);
+            sg.end_read();
+        });
+        return true;
+    }
+    catch (...) {
+        // As in evaluate_query_in_parallel(), some of the worker SharedGroups
+        // may be left with a dangling read transaction, so drop them all and
+        // let the caller check the rows on its own thread
+        m_query_worker_sgs.clear();
+        m_query_worker_histories.clear();
+        return false;
+    }
+}
+
+namespace {
+// Read every column of the given row, discarding the values. The getters
+// pull the leaves of each column's B+-tree through the memory mapping,
+// which is what faults the backing pages in.
+void touch_payload(const char* data, size_t size)
+{
+    // String and binary payloads can span many pages and the getters only
+    // read the leaf metadata, so walk the payload explicitly
+    static const size_t page_size = 4096;
+    volatile char sink = 0;
+    for (size_t i = 0; i < size; i += page_size)
+        sink = data[i];
+    static_cast<void>(sink);
+}
+
+void touch_row(Table const& table, size_t row)
+{
+    for (size_t col = 0, count = table.get_column_count(); col != count; ++col) {
+        switch (table.get_column_type(col)) {
+            case type_Int:
+                if (!table.is_null(col, row))
+                    table.get_int(col, row);
+                break;
+            case type_Bool:
+                if (!table.is_null(col, row))
+                    table.get_bool(col, row);
+                break;
+            case type_OldDateTime:
+                if (!table.is_null(col, row))
+                    table.get_olddatetime(col, row);
+                break;
+            case type_Float:
+                table.get_float(col, row);
+                break;
+            case type_Double:
+                table.get_double(col, row);
+                break;
+            case type_Timestamp:
+                if (!table.is_null(col, row))
+                    table.get_timestamp(col, row);
+                break;
+            case type_String: {
+                auto str = table.get_string(col, row);
+                touch_payload(str.data(), str.size());
+                break;
+            }
+            case type_Binary: {
+                auto data = table.get_binary(col, row);
+                touch_payload(data.data(), data.size());
+                break;
+            }
+            case type_Link:
+                table.is_null_link(col, row);
+                break;
+            case type_LinkList:
+                table.get_link_count(col, row);
+                break;
+            default:
+                // Mixed and subtable columns aren't used by the object store
+                break;
+        }
+    }
+}
+} // anonymous namespace
+
+void RealmCoordinator::prefetch_rows(SharedGroup::VersionID version, size_t table_ndx, std::vector<size_t> rows)
+{
+    if (rows.empty() || m_config.read_only())
+        return;
+
+    std::thread([self = shared_from_this(), version, table_ndx, rows = std::move(rows)] {
+        // Entirely best-effort: the caller may have released its pin on
+        // `version` by the time we begin the read, and any other failure
+        // just means the pages are faulted in on the consuming thread as
+        // they would have been anyway
+        try {
+            std::unique_ptr<Replication> history;
+            std::unique_ptr<SharedGroup> sg;
+            std::unique_ptr<Group> read_only_group;
+            Realm::open_with_config(self->m_config, history, sg, read_only_group, nullptr);
+            REALM_ASSERT(!read_only_group);
+
+            Group const& group = sg->begin_read(version);
+            if (table_ndx < group.size()) {
+                ConstTableRef table = group.get_table(table_ndx);
+                for (auto row : rows) {
+                    if (row < table->size())
+                        touch_row(*table, row);
+                }
+            }
+            sg->end_read();
+        }
+        catch (...) {
+        }
+    }).detach();
 }
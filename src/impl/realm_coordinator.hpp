@@ -19,12 +19,21 @@
 #ifndef REALM_COORDINATOR_HPP
 #define REALM_COORDINATOR_HPP
 
+#include "impl/collection_notifier.hpp"
 #include "shared_realm.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace realm {
+class Query;
 class Replication;
+class Results;
 class Schema;
 class SharedGroup;
 class StringData;
@@ -32,6 +41,8 @@ class StringData;
 namespace _impl {
 class CollectionNotifier;
 class ExternalCommitHelper;
+class QueryWorkerPool;
+class ResultsNotifier;
 class WeakRealmNotifier;
 
 // RealmCoordinator manages the weak cache of Realm instances and communication
@@ -49,10 +60,26 @@ public:
     std::shared_ptr<Realm> get_realm(Realm::Config config);
     std::shared_ptr<Realm> get_realm();
 
+    // Open a Realm with the given configuration on a background thread and
+    // deliver it to the calling thread's event loop once it's ready. All of
+    // the potentially slow parts of a first open -- the file open, file
+    // format upgrade, schema initialization and any migration -- run on the
+    // background thread, so the instance handed to `callback` can be created
+    // on the calling thread without blocking it. If opening fails, `callback`
+    // is instead invoked with a null Realm and the exception.
+    // Must be called from a thread with an event loop.
+    void get_realm_async(Realm::Config config,
+                         std::function<void (std::shared_ptr<Realm>, std::exception_ptr)> callback);
+
     Realm::Config get_config() const { return m_config; }
 
-    const Schema* get_schema() const noexcept;
+    // Get the cached schema, shared by every Realm instance on this path.
+    // Returns null if no Realm has validated a schema yet.
+    std::shared_ptr<const Schema> get_schema() const noexcept;
     uint64_t get_schema_version() const noexcept { return m_schema_version; }
+    // The transaction version at which the cached schema was read from the
+    // group, used to skip re-reading it when nothing has been committed since
+    uint64_t get_schema_transaction_version() const noexcept { return m_schema_transaction_version; }
     const std::string& get_path() const noexcept { return m_config.path; }
     const std::vector<char>& get_encryption_key() const noexcept { return m_config.encryption_key; }
     bool is_in_memory() const noexcept { return m_config.in_memory; }
@@ -80,27 +107,197 @@ public:
     // Called by m_notifier when there's a new commit to send notifications for
     void on_change();
 
-    // Update the cached schema
-    void update_schema(Schema const& new_schema, uint64_t new_schema_version);
+    // Update the cached schema. `transaction_version` is the transaction
+    // version at which `new_schema` matches the group's actual schema; Realms
+    // whose read transaction is at that version can use the cached schema
+    // without introspecting the group at all.
+    void update_schema(std::shared_ptr<const Schema> new_schema, uint64_t new_schema_version,
+                       uint64_t transaction_version);
 
     static void register_notifier(std::shared_ptr<CollectionNotifier> notifier);
 
+    // Get a registered notifier which will deliver async results to `target`,
+    // reusing an existing notifier for an equivalent Results on the same Realm
+    // instance when possible so that any number of Results watching the same
+    // table pay for a single query re-run and diff per commit. Unfiltered,
+    // unsorted and unwindowed table-backed Results are fully interchangeable
+    // and pass the index of their table as `shared_table_ndx`; anything more
+    // complex passes npos and always gets a fresh notifier, as core queries
+    // can be neither compared nor serialized.
+    static std::shared_ptr<_impl::ResultsNotifier> notifier_for_results(Results& target,
+                                                                        size_t shared_table_ndx);
+
     // Advance the Realm to the most recent transaction version which all async
-    // work is complete for
-    void advance_to_ready(Realm& realm);
-    void process_available_async(Realm& realm);
+    // work is complete for. Notification callbacks which don't fit before
+    // `deadline` are deferred onto the Realm and a new wakeup is posted for
+    // them; the default deadline never defers anything.
+    void advance_to_ready(Realm& realm,
+                          std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+    void process_available_async(Realm& realm,
+                                 std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    // Invoke the callbacks of notifiers whose changes have already been
+    // delivered to the Realm, stopping once `deadline` has passed. Any
+    // remainder is parked on the Realm's deferred list and a wakeup is
+    // posted to finish it on the next event loop iteration.
+    void finish_delivery(Realm& realm, std::vector<std::shared_ptr<_impl::CollectionNotifier>> notifiers,
+                         std::chrono::steady_clock::time_point deadline);
+
+    // Advance the Realm's read transaction to the given version (or the
+    // latest version if none is given), sending change notifications to its
+    // binding context. Spans of the transaction log which have already been
+    // validated on behalf of another Realm on the same path are not
+    // re-validated, so only the first Realm to advance over a commit pays
+    // for parsing it.
+    void advance_read(Realm& realm, SharedGroup::VersionID version=SharedGroup::VersionID{});
+
+    // Evaluate `fn` over contiguous row ranges covering [0, row_count) of
+    // `query`'s table, spread over a worker thread pool. Each invocation is
+    // given its own clone of `query` imported into a SharedGroup reading
+    // from the same version as `realm`, so the clones can be evaluated
+    // concurrently; merging the per-range outputs is up to the caller.
+    // Returns false without invoking `fn` if parallel evaluation is disabled
+    // (see Config::parallel_query_thread_count) or cannot be used for this
+    // query, in which case the caller should evaluate on the calling thread.
+    bool evaluate_query_in_parallel(Realm& realm, Query& query, size_t row_count,
+                                    std::function<void (Query&, size_t, size_t)> const& fn);
+
+    // Run the deep modification check for each row index in `rows` (which
+    // must be rows of the table at `root_table_ndx` as of `version`) spread
+    // over the parallel query worker pool, writing one flag per row into
+    // `modified`. Each partition reads through its own SharedGroup and uses
+    // its own DeepChangeChecker, so no synchronization is needed on the
+    // per-checker caches. Returns false without touching `modified` if
+    // parallel evaluation is disabled (see Config::parallel_query_thread_count)
+    // or the batch is too small to benefit, in which case the caller should
+    // check the rows on its own thread.
+    bool check_rows_in_parallel(SharedGroup::VersionID version,
+                                TransactionChangeInfo const& info,
+                                size_t root_table_ndx,
+                                std::vector<DeepChangeChecker::RelatedTable> const& related_tables,
+                                std::vector<size_t> const& rows,
+                                std::vector<char>& modified);
+
+    // Invoke `fn` over contiguous row ranges covering [0, row_count) of the
+    // table at `table_ndx`, spread over the worker thread pool. Each
+    // invocation is given a Table accessor attached to a private SharedGroup
+    // reading from the same version as `realm`, so the ranges can be
+    // processed concurrently. Backs Realm::enumerate_rows_in_parallel();
+    // returns false without invoking `fn` if parallel execution is disabled
+    // (see Config::parallel_migration_thread_count) or the table is too
+    // small to be worth partitioning.
+    bool for_each_row_range_in_parallel(Realm& realm, size_t table_ndx, size_t row_count,
+                                        std::function<void (Table const&, size_t, size_t)> const& fn);
+
+    // Fault in the data for the given rows of the table at `table_ndx` as of
+    // `version` from a background thread, so that a subsequent scan over the
+    // rows on the calling thread finds the backing pages already resident
+    // rather than faulting them in from disk one at a time. Entirely
+    // best-effort: all failures (including `version` no longer being
+    // available) are swallowed, as the rows will simply be read on first
+    // access as usual.
+    void prefetch_rows(SharedGroup::VersionID version, size_t table_ndx, std::vector<size_t> rows);
+
+    // Cheap atomic counters describing the behavior of the background
+    // notifier pipeline, intended for polling by external metrics
+    // collectors. All fields are updated with relaxed ordering, so values
+    // polled from another thread are individually accurate but not
+    // guaranteed to be mutually consistent.
+    struct NotifierMetrics {
+        // Number of times the notifier pipeline has run, and the total
+        // number of notifiers those runs have processed
+        std::atomic<uint64_t> run_count{0};
+        std::atomic<uint64_t> notifiers_run{0};
+        // Time spent running notifiers, in microseconds
+        std::atomic<uint64_t> total_run_time_us{0};
+        std::atomic<uint64_t> last_run_time_us{0};
+        // Number of notifiers processed by the most recent run
+        std::atomic<uint64_t> last_queue_depth{0};
+        // How many versions the most recently delivered notifications were
+        // behind the version which the pipeline last ran at
+        std::atomic<uint64_t> last_versions_behind{0};
+        // Time from the most recent commit signal to the most recent
+        // delivery of notifications, in microseconds
+        std::atomic<uint64_t> last_signal_to_deliver_us{0};
+    };
+
+    NotifierMetrics const& notifier_metrics() const noexcept { return m_notifier_metrics; }
+
+    // Cheap atomic counters describing write transactions across all Realms
+    // on this path, intended for diagnosing write lock contention. Updated
+    // with relaxed ordering like NotifierMetrics.
+    struct TransactionMetrics {
+        // Number of write transactions begun and committed
+        std::atomic<uint64_t> begin_count{0};
+        std::atomic<uint64_t> commit_count{0};
+        // Time spent in begin_transaction() acquiring the write lock and
+        // advancing to the latest version, in microseconds. When writers are
+        // convoying this is dominated by waiting for the write lock.
+        std::atomic<uint64_t> total_begin_time_us{0};
+        std::atomic<uint64_t> last_begin_time_us{0};
+        // Time spent in commit_transaction() writing the commit, in
+        // microseconds
+        std::atomic<uint64_t> total_commit_time_us{0};
+        std::atomic<uint64_t> last_commit_time_us{0};
+    };
+
+    TransactionMetrics const& transaction_metrics() const noexcept { return m_transaction_metrics; }
+
+    // Called by Realm with the measured duration of a write transaction
+    // operation
+    void record_begin_transaction_time(uint64_t time_us) noexcept;
+    void record_commit_transaction_time(uint64_t time_us) noexcept;
+
+    // Called by Realm::async_begin_transaction() to request that the realm's
+    // thread be signaled via its event loop once the write lock for the file
+    // is available
+    void async_request_write_lock(Realm& realm);
+    // If an async write lock request for `realm` has been granted, consume
+    // the grant and return true. Called by Realm::notify().
+    bool take_granted_write_request(Realm* realm);
+
+    // Get the set of tables transitively reachable from `table` via links,
+    // used by DeepChangeChecker. Computing this requires walking the column
+    // descriptors of every reachable table, so the result is cached per root
+    // table and shared by all notifiers rooted at that table. The cache is
+    // discarded when the schema changes; the returned vector is immutable
+    // and remains valid regardless.
+    std::shared_ptr<std::vector<DeepChangeChecker::RelatedTable> const> get_related_tables(Table const& table);
 
 private:
     Realm::Config m_config;
-    Schema m_schema;
+    std::shared_ptr<const Schema> m_schema;
     uint64_t m_schema_version = -1;
+    uint64_t m_schema_transaction_version = -1;
 
     std::mutex m_realm_mutex;
-    std::vector<WeakRealmNotifier> m_weak_realm_notifiers;
+
+    // The Realm instances open on this path, sharded by the id of the thread
+    // which opened them so that threads opening and closing their own
+    // short-lived Realms don't all serialize on one lock. m_realm_mutex is
+    // still taken for the slow path of creating a new instance; the cached
+    // lookup and unregistration paths only take the relevant shard's lock.
+    struct RealmRegistryShard {
+        std::mutex mutex;
+        std::vector<WeakRealmNotifier> notifiers;
+    };
+    static constexpr size_t s_realm_registry_shard_count = 16;
+    RealmRegistryShard m_realm_registry[s_realm_registry_shard_count];
+    // Number of registered Realm instances, updated inside the shard locks
+    // but readable without them
+    std::atomic<size_t> m_realm_count = {0};
+
+    RealmRegistryShard& realm_registry_shard_for_current_thread() noexcept;
+    // Call `fn` with each registered WeakRealmNotifier, locking one shard
+    // at a time
+    template<typename Fn> void for_each_realm_notifier(Fn&& fn);
 
     std::mutex m_notifier_mutex;
     std::vector<std::shared_ptr<_impl::CollectionNotifier>> m_new_notifiers;
     std::vector<std::shared_ptr<_impl::CollectionNotifier>> m_notifiers;
+    // Registered notifiers which can be shared between equivalent Results,
+    // scanned by notifier_for_results(). Dead entries are pruned during scans.
+    std::vector<std::weak_ptr<_impl::ResultsNotifier>> m_shareable_notifiers;
 
     // SharedGroup used for actually running async notifiers
     // Will have a read transaction iff m_notifiers is non-empty
@@ -116,13 +313,88 @@ private:
 
     std::unique_ptr<_impl::ExternalCommitHelper> m_notifier;
 
+    // When the notifier pipeline last ran, used to implement
+    // Config::notifier_coalescing_window_ms. Only used on the thread
+    // delivering external commit notifications.
+    std::chrono::steady_clock::time_point m_last_notifier_run;
+
+    NotifierMetrics m_notifier_metrics;
+    TransactionMetrics m_transaction_metrics;
+    // When the most recent commit signal arrived and the version the
+    // pipeline most recently ran at, used to derive the delivery metrics
+    std::atomic<uint64_t> m_last_commit_signal_us{0};
+    std::atomic<uint64_t> m_last_run_version{0};
+
+    // State used to asynchronously wait for the write lock on behalf of
+    // Realm::async_begin_transaction(). The waiter thread is started the
+    // first time a request is made, and waits for the lock by acquiring and
+    // immediately releasing a write transaction on its own SharedGroup
+    // before signaling the requesting Realms' threads.
+    std::mutex m_write_waiter_mutex;
+    std::condition_variable m_write_waiter_cv;
+    std::thread m_write_waiter_thread;
+    bool m_write_waiter_shutdown = false;
+    std::vector<Realm*> m_pending_write_requests;
+    std::vector<Realm*> m_granted_write_requests;
+    std::unique_ptr<Replication> m_write_waiter_history;
+    std::unique_ptr<SharedGroup> m_write_waiter_sg;
+
+    // Contiguous span of transaction versions which some Realm on this path
+    // has already validated against the object store's schema rules, so that
+    // other Realms advancing within the span don't have to parse the logs a
+    // second time just to re-validate them
+    std::mutex m_validated_versions_mutex;
+    uint64_t m_validated_begin_version = 0;
+    uint64_t m_validated_end_version = 0;
+
+    // Thread pool and per-worker SharedGroups used for parallel query
+    // evaluation, created lazily and all guarded by m_query_worker_mutex
+    // (which also serializes the parallel evaluations themselves)
+    std::mutex m_query_worker_mutex;
+    std::unique_ptr<QueryWorkerPool> m_query_worker_pool;
+    std::vector<std::unique_ptr<Replication>> m_query_worker_histories;
+    std::vector<std::unique_ptr<SharedGroup>> m_query_worker_sgs;
+
+    // State used to spread notifier execution over multiple threads. Each
+    // notifier is permanently assigned to a shard when it is first attached;
+    // shard zero is m_notifier_sg and shard i + 1 is m_notifier_shard_sgs[i].
+    // Notifiers in different shards have their run() executed concurrently
+    // on m_notifier_pool, as they do not share any accessors. All of this
+    // state is only ever used on the worker thread.
+    std::vector<std::unique_ptr<Replication>> m_notifier_shard_histories;
+    std::vector<std::unique_ptr<SharedGroup>> m_notifier_shard_sgs;
+    std::vector<size_t> m_notifier_shard_counts;
+    std::unordered_map<CollectionNotifier*, size_t> m_notifier_shards;
+    std::unique_ptr<QueryWorkerPool> m_notifier_pool;
+    size_t m_next_notifier_shard = 0;
+
+    // Change info storage reused by run_async_notifiers() across runs so
+    // that steady-state runs reset the existing infos rather than
+    // reallocating the per-table changesets every cycle. Only ever used on
+    // the worker thread.
+    std::vector<TransactionChangeInfo> m_new_notifier_change_info;
+    std::vector<TransactionChangeInfo> m_notifier_change_info;
+
+    // Cache of the related-table graphs handed out by get_related_tables(),
+    // keyed by root table index
+    std::mutex m_related_tables_mutex;
+    std::unordered_map<size_t, std::shared_ptr<std::vector<DeepChangeChecker::RelatedTable> const>> m_related_tables_cache;
+
     // must be called with m_notifier_mutex locked
     void pin_version(uint_fast64_t version, uint_fast32_t index);
 
     void run_async_notifiers();
     void open_helper_shared_group();
+    void write_lock_waiter_loop();
+    // Assign `notifier` to a notifier shard and return the SharedGroup it
+    // should be attached to, opening the shard's SharedGroup and beginning
+    // a read at m_notifier_sg's current version if needed
+    SharedGroup& assign_notifier_shard(CollectionNotifier& notifier);
     void advance_helper_shared_group_to_latest();
     void clean_up_dead_notifiers();
+    // Update the delivery-related fields of m_notifier_metrics after
+    // delivering notifications packaged at `delivered_version`
+    void record_delivery_metrics(uint_fast64_t delivered_version);
     std::vector<std::shared_ptr<_impl::CollectionNotifier>> notifiers_to_deliver(Realm&);
 };
 
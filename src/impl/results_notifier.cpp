@@ -18,13 +18,23 @@
 
 #include "impl/results_notifier.hpp"
 
+#include "util/metrics.hpp"
+
 using namespace realm;
 using namespace realm::_impl;
 
-ResultsNotifier::ResultsNotifier(Results& target)
+namespace {
+// The maximum number of changed rows which will be individually rechecked
+// against the query before giving up and rerunning the query in full
+constexpr size_t max_rows_to_recheck = 1024;
+}
+
+ResultsNotifier::ResultsNotifier(Results& target, size_t shared_table_ndx)
 : CollectionNotifier(target.get_realm())
-, m_target_results(&target)
+, m_targets{&target}
+, m_shared_table_ndx(shared_table_ndx)
 , m_target_is_in_table_order(target.is_in_table_order())
+, m_track_moves(target.move_tracking_enabled())
 {
     Query q = target.get_query();
     set_table(*q.get_table());
@@ -36,8 +46,47 @@ void ResultsNotifier::target_results_moved(Results& old_target, Results& new_tar
 {
     auto lock = lock_target();
 
-    REALM_ASSERT(m_target_results == &old_target);
-    m_target_results = &new_target;
+    // As with remove_target(), tolerate Results this notifier doesn't know
+    // about rather than asserting: not every Results holding a handle to a
+    // shared notifier is necessarily a registered target, and moving one
+    // simply has nothing to retarget
+    auto it = std::find(m_targets.begin(), m_targets.end(), &old_target);
+    if (it == m_targets.end())
+        return;
+    *it = &new_target;
+}
+
+bool ResultsNotifier::can_deliver_to(Realm const* realm, size_t table_ndx, bool track_moves) noexcept
+{
+    if (m_shared_table_ndx == npos || m_shared_table_ndx != table_ndx || m_track_moves != track_moves)
+        return false;
+    auto lock = lock_target();
+    return get_realm() == realm && !m_targets.empty();
+}
+
+void ResultsNotifier::add_target(Results& target)
+{
+    auto lock = lock_target();
+    REALM_ASSERT(std::find(m_targets.begin(), m_targets.end(), &target) == m_targets.end());
+    m_targets.push_back(&target);
+}
+
+void ResultsNotifier::remove_target(Results& target) noexcept
+{
+    auto lock = lock_target();
+    auto it = std::find(m_targets.begin(), m_targets.end(), &target);
+    if (it != m_targets.end())
+        m_targets.erase(it);
+}
+
+void ResultsNotifier::unregister() noexcept
+{
+    {
+        auto lock = lock_target();
+        if (!m_targets.empty())
+            return;
+    }
+    CollectionNotifier::unregister();
 }
 
 void ResultsNotifier::release_data() noexcept
@@ -64,7 +113,7 @@ void ResultsNotifier::release_data() noexcept
 //    and call_callbacks()
 //  - call_callbacks() and read members written to in deliver()
 //
-// Separately from the handover data flow, m_target_results is guarded by the target lock
+// Separately from the handover data flow, m_targets is guarded by the target lock
 
 bool ResultsNotifier::do_add_required_change_info(TransactionChangeInfo& info)
 {
@@ -87,7 +136,9 @@ bool ResultsNotifier::need_to_run()
     {
         auto lock = lock_target();
         // Don't run the query if the results aren't actually going to be used
-        if (!get_realm() || (!have_callbacks() && !m_target_results->wants_background_updates())) {
+        bool results_want_updates = std::any_of(m_targets.begin(), m_targets.end(),
+                                                [](auto&& target) { return target->wants_background_updates(); });
+        if (!get_realm() || (!have_callbacks() && !results_want_updates)) {
             return false;
         }
     }
@@ -97,6 +148,70 @@ bool ResultsNotifier::need_to_run()
         return false;
     }
 
+    // Even when the table did change, we may be able to prove that the
+    // changes can't be reflected in the results without rerunning the query
+    if (m_initial_run_complete && changes_cannot_affect_results()) {
+        return false;
+    }
+
+    return true;
+}
+
+// Check if this transaction's changes can be proven not to affect the results
+// without running the query over the whole table, by rechecking just the
+// changed rows against the query. Returns false (i.e. a full rerun is needed)
+// whenever that can't be cheaply established.
+bool ResultsNotifier::changes_cannot_affect_results()
+{
+    REALM_ASSERT(m_info);
+
+    auto table_ndx = m_query->get_table()->get_index_in_group();
+    if (table_ndx >= m_info->tables.size())
+        return false;
+
+    // Modifications to a linked-to table can change which rows match a query
+    // over links, which the per-row rechecks below don't cover
+    for (auto& tbl : related_tables()) {
+        if (tbl.table_ndx != table_ndx && tbl.table_ndx < m_info->tables.size()
+            && !m_info->tables[tbl.table_ndx].empty()) {
+            return false;
+        }
+    }
+
+    auto const& changes = m_info->tables[table_ndx];
+    // Deletions and moves invalidate the row indexes in m_previous_rows, so
+    // a full run is needed to recalculate them
+    if (!changes.deletions.empty() || !changes.moves.empty())
+        return false;
+    if (changes.modifications.count() + changes.insertions.count() > max_rows_to_recheck)
+        return false;
+
+    // m_previous_rows is in view order, which is only sorted by row index if
+    // the results are in table order
+    std::vector<size_t> sorted_rows;
+    auto const* rows = &m_previous_rows;
+    if (m_sort || !m_target_is_in_table_order) {
+        sorted_rows = m_previous_rows;
+        std::sort(sorted_rows.begin(), sorted_rows.end());
+        rows = &sorted_rows;
+    }
+
+    for (auto row : changes.modifications.as_indexes()) {
+        // A modification to a row in the results has to be reported as a
+        // change even if the row still matches
+        if (std::binary_search(rows->begin(), rows->end(), row))
+            return false;
+        // A row not in the results may now match the query
+        if (m_query->count(row, row + 1) != 0)
+            return false;
+    }
+    // Newly inserted rows don't shift the indexes of the existing rows, so
+    // they only matter if they match the query
+    for (auto row : changes.insertions.as_indexes()) {
+        if (m_query->count(row, row + 1) != 0)
+            return false;
+    }
+
     return true;
 }
 
@@ -124,13 +239,61 @@ void ResultsNotifier::calculate_changes()
                 else
                     REALM_ASSERT_DEBUG(!changes->insertions.contains(idx));
             }
-            if (m_target_is_in_table_order && !m_sort)
+            if (m_track_moves && m_target_is_in_table_order && !m_sort)
                 move_candidates = changes->insertions;
         }
 
+        // calculate() only ever probes the modification checker with row
+        // indexes from next_rows, so for large result sets the deep check
+        // for every row can be precomputed in parallel up front and the
+        // checker replaced with a lookup into the precomputed flags
+        std::function<bool (size_t)> row_did_change;
+        std::vector<char> modified;
+        if (check_rows_in_parallel(*m_info, *m_query->get_table(), next_rows, modified)) {
+            std::unordered_map<size_t, bool> modified_rows;
+            modified_rows.reserve(next_rows.size());
+            for (size_t i = 0; i < next_rows.size(); ++i)
+                modified_rows[next_rows[i]] = static_cast<bool>(modified[i]);
+            row_did_change = [modified_rows=std::move(modified_rows)](size_t ndx) {
+                auto it = modified_rows.find(ndx);
+                return it != modified_rows.end() && it->second;
+            };
+        }
+        else {
+            row_did_change = get_modification_checker(*m_info, *m_query->get_table());
+        }
+
         m_changes = CollectionChangeBuilder::calculate(m_previous_rows, next_rows,
-                                                       get_modification_checker(*m_info, *m_query->get_table()),
-                                                       move_candidates);
+                                                       std::move(row_did_change),
+                                                       move_candidates, m_track_moves);
+
+        // Map the table's per-column modification information into view
+        // indices. The table-level changeset is in terms of row indices as of
+        // the end of the transaction, which is what next_rows holds.
+        if (changes && !changes->columns.empty()) {
+            // Gather (table row, view index) for each modified row, sorted by
+            // row index so that the per-column membership checks can be done
+            // as a single batch per column
+            std::vector<std::pair<size_t, size_t>> modified;
+            for (auto ndx : m_changes.modifications.as_indexes())
+                modified.push_back({next_rows[ndx], ndx});
+            std::sort(modified.begin(), modified.end());
+
+            std::vector<size_t> modified_rows;
+            modified_rows.reserve(modified.size());
+            for (auto& row : modified)
+                modified_rows.push_back(row.first);
+
+            std::vector<bool> in_column;
+            m_changes.columns.resize(changes->columns.size());
+            for (size_t col = 0; col < changes->columns.size(); ++col) {
+                changes->columns[col].contains_each(modified_rows, in_column);
+                for (size_t i = 0; i < modified.size(); ++i) {
+                    if (in_column[i])
+                        m_changes.columns[col].add(modified[i].second);
+                }
+            }
+        }
 
         m_previous_rows = std::move(next_rows);
     }
@@ -141,11 +304,12 @@ void ResultsNotifier::calculate_changes()
     }
 }
 
-void ResultsNotifier::run()
+void ResultsNotifier::do_run()
 {
     if (!need_to_run())
         return;
 
+    util::g_metric_counters.table_view_rebuilds.fetch_add(1, std::memory_order_relaxed);
     m_query->sync_view_if_needed();
     m_tv = m_query->find_all();
     if (m_sort) {
@@ -187,12 +351,16 @@ void ResultsNotifier::deliver(SharedGroup& sg)
     }
 
     REALM_ASSERT(!m_query_handover);
-    if (m_tv_to_deliver) {
+    if (m_tv_to_deliver && !m_targets.empty()) {
         m_tv_to_deliver->version = version();
-        Results::Internal::set_table_view(*m_target_results,
-                                          std::move(*sg.import_from_handover(std::move(m_tv_to_deliver))));
+        // The handover object can only be imported once, so import it into
+        // the first target and give the rest copies of the resulting view
+        auto tv = sg.import_from_handover(std::move(m_tv_to_deliver));
+        for (size_t i = 1; i < m_targets.size(); ++i)
+            Results::Internal::set_table_view(*m_targets[i], TableView(*tv));
+        Results::Internal::set_table_view(*m_targets[0], std::move(*tv));
     }
-    REALM_ASSERT(!m_tv_to_deliver);
+    m_tv_to_deliver = nullptr;
 }
 
 bool ResultsNotifier::prepare_to_deliver()
@@ -223,3 +391,244 @@ void ResultsNotifier::do_detach_from(SharedGroup& sg)
     m_query_handover = sg.export_for_handover(*m_query, MutableSourcePayload::Move);
     m_query = nullptr;
 }
+
+ResultsAggregateNotifier::ResultsAggregateNotifier(Results& target,
+                                                   Results::AggregateOperation op,
+                                                   size_t column)
+: CollectionNotifier(target.get_realm())
+, m_op(op)
+, m_column(column)
+{
+    Query q = target.get_query();
+    set_table(*q.get_table());
+    m_query_handover = Realm::Internal::get_shared_group(*get_realm()).export_for_handover(q, MutableSourcePayload::Move);
+}
+
+void ResultsAggregateNotifier::release_data() noexcept
+{
+    m_query = nullptr;
+}
+
+// The data flow between the threads is the same as in ResultsNotifier, with
+// the aggregated value taking the place of the handed-over TableView (being a
+// plain numeric value, it doesn't need an actual handover object).
+
+util::Optional<Mixed> ResultsAggregateNotifier::compute(TableView& tv) const
+{
+    // sum() is zero rather than none for no rows, matching Results::sum()
+    if (tv.size() == 0 && m_op != Results::AggregateOperation::Sum)
+        return util::none;
+
+    using Op = Results::AggregateOperation;
+    switch (tv.get_parent().get_column_type(m_column)) {
+        case type_Int:
+            switch (m_op) {
+                case Op::Maximum: return Mixed(tv.maximum_int(m_column));
+                case Op::Minimum: return Mixed(tv.minimum_int(m_column));
+                case Op::Average: return Mixed(tv.average_int(m_column));
+                case Op::Sum:     return Mixed(tv.sum_int(m_column));
+            }
+            break;
+        case type_Float:
+            switch (m_op) {
+                case Op::Maximum: return Mixed(tv.maximum_float(m_column));
+                case Op::Minimum: return Mixed(tv.minimum_float(m_column));
+                case Op::Average: return Mixed(tv.average_float(m_column));
+                case Op::Sum:     return Mixed(tv.sum_float(m_column));
+            }
+            break;
+        case type_Double:
+            switch (m_op) {
+                case Op::Maximum: return Mixed(tv.maximum_double(m_column));
+                case Op::Minimum: return Mixed(tv.minimum_double(m_column));
+                case Op::Average: return Mixed(tv.average_double(m_column));
+                case Op::Sum:     return Mixed(tv.sum_double(m_column));
+            }
+            break;
+        case type_Timestamp:
+            // Results::async_aggregate() validates the operation on the
+            // target thread before this notifier is ever created
+            switch (m_op) {
+                case Op::Maximum: return Mixed(tv.maximum_timestamp(m_column));
+                case Op::Minimum: return Mixed(tv.minimum_timestamp(m_column));
+                default: break;
+            }
+            break;
+        default:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+bool ResultsAggregateNotifier::do_add_required_change_info(TransactionChangeInfo&)
+{
+    // We don't calculate a changeset, so no change info is ever needed
+    return false;
+}
+
+void ResultsAggregateNotifier::do_run()
+{
+    // Only compute the value once; redelivery is never needed as the value
+    // itself is versioned by the transaction it was read from
+    if (m_initial_run_complete)
+        return;
+
+    {
+        auto lock = lock_target();
+        // Don't bother computing a value no one is going to look at
+        if (!get_realm() || !have_callbacks())
+            return;
+    }
+
+    m_query->sync_view_if_needed();
+    TableView tv = m_query->find_all();
+    m_value = compute(tv);
+    m_has_value = true;
+}
+
+void ResultsAggregateNotifier::do_prepare_handover(SharedGroup&)
+{
+    if (!m_has_value)
+        return;
+    m_initial_run_complete = true;
+}
+
+bool ResultsAggregateNotifier::prepare_to_deliver()
+{
+    auto lock = lock_target();
+    if (!get_realm() || !m_initial_run_complete)
+        return false;
+    m_value_to_deliver = m_value;
+    m_deliver_value = true;
+    return true;
+}
+
+void ResultsAggregateNotifier::deliver(SharedGroup&)
+{
+    auto lock = lock_target();
+
+    // As in ResultsNotifier::deliver(), a null target realm means we were
+    // unregistered from the "wrong" thread mid-delivery
+    if (!get_realm()) {
+        return;
+    }
+
+    if (m_deliver_value) {
+        m_delivered_value = m_value_to_deliver;
+        m_deliver_value = false;
+    }
+}
+
+void ResultsAggregateNotifier::do_attach_to(SharedGroup& sg)
+{
+    REALM_ASSERT(m_query_handover);
+    m_query = sg.import_from_handover(std::move(m_query_handover));
+}
+
+void ResultsAggregateNotifier::do_detach_from(SharedGroup& sg)
+{
+    REALM_ASSERT(m_query);
+    m_query_handover = sg.export_for_handover(*m_query, MutableSourcePayload::Move);
+    m_query = nullptr;
+}
+
+ResultsSnapshotNotifier::ResultsSnapshotNotifier(Results& target)
+: CollectionNotifier(target.get_realm())
+{
+    Query q = target.get_query();
+    set_table(*q.get_table());
+    m_query_handover = Realm::Internal::get_shared_group(*get_realm()).export_for_handover(q, MutableSourcePayload::Move);
+    SortDescriptor::generate_patch(target.get_sort(), m_sort_handover);
+}
+
+void ResultsSnapshotNotifier::release_data() noexcept
+{
+    m_query = nullptr;
+}
+
+bool ResultsSnapshotNotifier::do_add_required_change_info(TransactionChangeInfo&)
+{
+    // The snapshot is delivered exactly once, so no change info is ever needed
+    return false;
+}
+
+void ResultsSnapshotNotifier::do_run()
+{
+    // Only run the query once; the snapshot deliberately doesn't update to
+    // reflect later changes
+    if (m_initial_run_complete)
+        return;
+
+    {
+        auto lock = lock_target();
+        // Don't bother running a query no one is going to look at
+        if (!get_realm() || !have_callbacks())
+            return;
+    }
+
+    m_query->sync_view_if_needed();
+    m_tv = m_query->find_all();
+    if (m_sort) {
+        m_tv.sort(m_sort);
+    }
+    m_tv.sync_if_needed();
+}
+
+void ResultsSnapshotNotifier::do_prepare_handover(SharedGroup& sg)
+{
+    if (!m_tv.is_attached()) {
+        return;
+    }
+
+    REALM_ASSERT(m_tv.is_in_sync());
+
+    m_initial_run_complete = true;
+    m_tv_handover = sg.export_for_handover(m_tv, MutableSourcePayload::Move);
+
+    // detach the TableView as we won't need it again and keeping it around
+    // makes advance_read() much more expensive
+    m_tv = {};
+}
+
+bool ResultsSnapshotNotifier::prepare_to_deliver()
+{
+    auto lock = lock_target();
+    if (!get_realm() || !m_initial_run_complete)
+        return false;
+    m_tv_to_deliver = std::move(m_tv_handover);
+    return true;
+}
+
+void ResultsSnapshotNotifier::deliver(SharedGroup& sg)
+{
+    auto lock = lock_target();
+
+    // As in ResultsNotifier::deliver(), a null target realm means we were
+    // unregistered from the "wrong" thread mid-delivery
+    if (!get_realm()) {
+        return;
+    }
+
+    if (m_tv_to_deliver) {
+        m_tv_to_deliver->version = version();
+        auto tv = sg.import_from_handover(std::move(m_tv_to_deliver));
+        m_snapshot = Results(get_realm()->shared_from_this(), std::move(*tv)).snapshot();
+    }
+}
+
+void ResultsSnapshotNotifier::do_attach_to(SharedGroup& sg)
+{
+    REALM_ASSERT(m_query_handover);
+    m_query = sg.import_from_handover(std::move(m_query_handover));
+    m_sort = SortDescriptor::create_from_and_consume_patch(m_sort_handover, *m_query->get_table());
+}
+
+void ResultsSnapshotNotifier::do_detach_from(SharedGroup& sg)
+{
+    REALM_ASSERT(m_query);
+    REALM_ASSERT(!m_tv.is_attached());
+
+    SortDescriptor::generate_patch(m_sort, m_sort_handover);
+    m_query_handover = sg.export_for_handover(*m_query, MutableSourcePayload::Move);
+    m_query = nullptr;
+}
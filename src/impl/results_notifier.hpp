@@ -23,19 +23,44 @@
 #include "results.hpp"
 
 #include <realm/group_shared.hpp>
+#include <realm/mixed.hpp>
 
 namespace realm {
 namespace _impl {
 class ResultsNotifier : public CollectionNotifier {
 public:
-    ResultsNotifier(Results& target);
+    // `shared_table_ndx` should be the index of the target's table in the
+    // group if the notifier can be shared between equivalent Results (see
+    // RealmCoordinator::notifier_for_results()), and npos otherwise
+    ResultsNotifier(Results& target, size_t shared_table_ndx = npos);
 
     void target_results_moved(Results& old_target, Results& new_target);
 
+    // Check if this notifier can also deliver to a Results for the table at
+    // `table_ndx` created on the given Realm instance. Only ever true for
+    // notifiers created with a valid `shared_table_ndx`.
+    bool can_deliver_to(Realm const* realm, size_t table_ndx, bool track_moves) noexcept;
+
+    // Add or remove a Results which this notifier delivers to. Each target
+    // must detach itself before it is destroyed.
+    void add_target(Results& target);
+    void remove_target(Results& target) noexcept;
+
+    // Shadows CollectionNotifier::unregister() so that one of several Results
+    // sharing this notifier going away doesn't tear the notifier down for the
+    // others. The notifier is only actually unregistered once every target
+    // has been removed.
+    void unregister() noexcept;
+
 private:
-    // Target Results to update
+    // Target Results to update. A notifier created with a valid
+    // `shared_table_ndx` can deliver to any number of equivalent Results.
     // Can only be used with lock_target() held
-    Results* m_target_results;
+    std::vector<Results*> m_targets;
+
+    // The index of the query's table in the group when this notifier can be
+    // shared between Results watching that table, and npos otherwise
+    const size_t m_shared_table_ndx;
 
     // The source Query, in handover form iff m_sg is null
     std::unique_ptr<SharedGroup::Handover<Query>> m_query_handover;
@@ -44,6 +69,7 @@ private:
     SortDescriptor::HandoverPatch m_sort_handover;
     SortDescriptor m_sort;
     bool m_target_is_in_table_order;
+    bool m_track_moves;
 
     // The TableView resulting from running the query. Will be detached unless
     // the query was (re)run since the last time the handover object was created
@@ -67,10 +93,11 @@ private:
     bool m_initial_run_complete = false;
 
     bool need_to_run();
+    bool changes_cannot_affect_results();
     void calculate_changes();
     void deliver(SharedGroup&) override;
 
-    void run() override;
+    void do_run() override;
     void do_prepare_handover(SharedGroup&) override;
     bool do_add_required_change_info(TransactionChangeInfo& info) override;
     bool prepare_to_deliver() override;
@@ -80,6 +107,88 @@ private:
     void do_detach_from(SharedGroup& sg) override;
 };
 
+// A one-shot notifier which computes a single aggregate over the rows
+// matching a query on the worker thread and then delivers the value to the
+// target thread via the normal notification machinery. Unlike ResultsNotifier
+// it does not track changes; once the value has been handed over it never
+// runs again.
+class ResultsAggregateNotifier : public CollectionNotifier {
+public:
+    ResultsAggregateNotifier(Results& target, Results::AggregateOperation op, size_t column);
+
+    // Get the computed value. Must only be called from the target thread,
+    // from within a notification callback.
+    util::Optional<Mixed> value() const noexcept { return m_delivered_value; }
+
+private:
+    const Results::AggregateOperation m_op;
+    const size_t m_column;
+
+    // The source Query, in handover form iff m_sg is null
+    std::unique_ptr<SharedGroup::Handover<Query>> m_query_handover;
+    std::unique_ptr<Query> m_query;
+
+    // The value computed in run() and its journey to the target thread
+    util::Optional<Mixed> m_value;
+    util::Optional<Mixed> m_value_to_deliver;
+    util::Optional<Mixed> m_delivered_value;
+    bool m_has_value = false;
+    bool m_deliver_value = false;
+    bool m_initial_run_complete = false;
+
+    util::Optional<Mixed> compute(TableView& tv) const;
+
+    void do_run() override;
+    void do_prepare_handover(SharedGroup&) override;
+    bool do_add_required_change_info(TransactionChangeInfo&) override;
+    bool prepare_to_deliver() override;
+    void deliver(SharedGroup&) override;
+
+    void release_data() noexcept override;
+    void do_attach_to(SharedGroup& sg) override;
+    void do_detach_from(SharedGroup& sg) override;
+};
+
+// A one-shot notifier which runs a query once on the worker thread and hands
+// the matching rows over to the target thread as a snapshot Results. Unlike
+// ResultsNotifier it performs no change tracking at all; once the snapshot
+// has been delivered it never runs again.
+class ResultsSnapshotNotifier : public CollectionNotifier {
+public:
+    ResultsSnapshotNotifier(Results& target);
+
+    // Get the delivered snapshot. Must only be called from the target thread,
+    // from within a notification callback.
+    Results snapshot() const { return m_snapshot; }
+
+private:
+    // The source Query, in handover form iff m_sg is null
+    std::unique_ptr<SharedGroup::Handover<Query>> m_query_handover;
+    std::unique_ptr<Query> m_query;
+
+    SortDescriptor::HandoverPatch m_sort_handover;
+    SortDescriptor m_sort;
+
+    // The TableView from running the query and its journey to the target
+    // thread, where it becomes m_snapshot
+    TableView m_tv;
+    std::unique_ptr<SharedGroup::Handover<TableView>> m_tv_handover;
+    std::unique_ptr<SharedGroup::Handover<TableView>> m_tv_to_deliver;
+    Results m_snapshot;
+
+    bool m_initial_run_complete = false;
+
+    void do_run() override;
+    void do_prepare_handover(SharedGroup&) override;
+    bool do_add_required_change_info(TransactionChangeInfo&) override;
+    bool prepare_to_deliver() override;
+    void deliver(SharedGroup&) override;
+
+    void release_data() noexcept override;
+    void do_attach_to(SharedGroup& sg) override;
+    void do_detach_from(SharedGroup& sg) override;
+};
+
 } // namespace _impl
 } // namespace realm
 
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/thread_scheduling.hpp"
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+using namespace realm;
+
+void _impl::apply_worker_thread_scheduling(Realm::Config const& config) noexcept
+{
+    if (config.worker_thread_niceness == 0 && config.worker_thread_affinity.empty())
+        return;
+
+#if defined(__APPLE__)
+    // Apple platforms don't support pinning threads to specific cores, so
+    // the affinity list is ignored; the niceness is instead mapped onto the
+    // QoS classes which the scheduler actually honors (including for core
+    // selection on asymmetric processors)
+    if (config.worker_thread_niceness > 0)
+        pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+    else if (config.worker_thread_niceness < 0)
+        pthread_set_qos_class_self_np(QOS_CLASS_USER_INITIATED, 0);
+#elif defined(__linux__)
+    // Covers Android as well. Niceness is per-thread on Linux despite what
+    // POSIX says, so setpriority() on the thread's id adjusts just this
+    // thread. sched_setaffinity() is used rather than the pthread wrapper
+    // as older Android NDKs don't provide the latter.
+    auto tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (config.worker_thread_niceness != 0)
+        setpriority(PRIO_PROCESS, tid, config.worker_thread_niceness);
+    if (!config.worker_thread_affinity.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto core : config.worker_thread_affinity) {
+            if (core < CPU_SETSIZE)
+                CPU_SET(core, &cpus);
+        }
+        if (CPU_COUNT(&cpus) != 0)
+            sched_setaffinity(tid, sizeof(cpus), &cpus);
+    }
+#elif defined(_WIN32)
+    if (config.worker_thread_niceness != 0) {
+        SetThreadPriority(GetCurrentThread(), config.worker_thread_niceness > 0
+                                                  ? THREAD_PRIORITY_BELOW_NORMAL
+                                                  : THREAD_PRIORITY_ABOVE_NORMAL);
+    }
+    if (!config.worker_thread_affinity.empty()) {
+        DWORD_PTR mask = 0;
+        for (auto core : config.worker_thread_affinity) {
+            if (core < sizeof(DWORD_PTR) * 8)
+                mask |= DWORD_PTR(1) << core;
+        }
+        if (mask)
+            SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+#endif
+}
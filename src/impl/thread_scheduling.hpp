@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_THREAD_SCHEDULING_HPP
+#define REALM_THREAD_SCHEDULING_HPP
+
+#include "shared_realm.hpp"
+
+namespace realm {
+namespace _impl {
+
+// Apply the worker-thread scheduling controls from the given config to the
+// calling thread. Must be called on the thread to be configured, before it
+// begins doing real work. Entirely best-effort: controls which the platform
+// doesn't support (or which the process lacks the privileges for) are
+// silently ignored.
+void apply_worker_thread_scheduling(Realm::Config const& config) noexcept;
+
+} // namespace _impl
+} // namespace realm
+
+#endif /* REALM_THREAD_SCHEDULING_HPP */
@@ -22,10 +22,12 @@
 #include "impl/collection_notifier.hpp"
 #include "index_set.hpp"
 #include "shared_realm.hpp"
+#include "util/metrics.hpp"
 
 #include <realm/group_shared.hpp>
 #include <realm/lang_bind_helper.hpp>
 #include <algorithm>
+#include <unordered_map>
 
 using namespace realm;
 
@@ -34,6 +36,7 @@ template<typename Derived>
 struct MarkDirtyMixin  {
     bool mark_dirty(size_t row, size_t col, _impl::Instruction instr=_impl::instr_Set)
     {
+        util::g_metric_counters.transact_log_instructions.fetch_add(1, std::memory_order_relaxed);
         // Ignore SetDefault and SetUnique as those conceptually cannot be
         // changes to existing rows
         if (instr == _impl::instr_Set)
@@ -220,6 +223,46 @@ class TransactLogObserver : public TransactLogValidationMixin, public MarkDirtyM
     // Change information for the currently selected LinkList, if any
     ColumnInfo* m_active_linklist = nullptr;
 
+    // Whether the currently selected table has any observed rows. Cached
+    // when the table is selected so that instructions for unobserved tables
+    // can be skipped with a single check rather than a search per instruction.
+    bool m_has_observers_in_table = false;
+
+    // Hash index from row index to position in m_observers for the rows of
+    // the table m_indexed_table, built the first time a row in that table is
+    // looked up. Structural changes which move rows or observers around
+    // simply discard the index, as rebuilding it on the next lookup costs no
+    // more than updating it would
+    std::unordered_map<size_t, size_t> m_observer_index;
+    size_t m_indexed_table = IndexSet::npos;
+
+    void update_observer_cache()
+    {
+        auto it = lower_bound(begin(m_observers), end(m_observers),
+                              ObserverState{current_table(), 0, nullptr});
+        m_has_observers_in_table = it != end(m_observers) && it->table_ndx == current_table();
+    }
+
+    void invalidate_observer_index() noexcept
+    {
+        m_indexed_table = IndexSet::npos;
+    }
+
+    // Find the observer for the given row of the current table, if any
+    ObserverState* find_observer(size_t row_ndx)
+    {
+        if (m_indexed_table != current_table()) {
+            m_observer_index.clear();
+            auto it = lower_bound(begin(m_observers), end(m_observers),
+                                  ObserverState{current_table(), 0, nullptr});
+            for (; it != end(m_observers) && it->table_ndx == current_table(); ++it)
+                m_observer_index.emplace(it->row_ndx, it - begin(m_observers));
+            m_indexed_table = current_table();
+        }
+        auto it = m_observer_index.find(row_ndx);
+        return it == m_observer_index.end() ? nullptr : &m_observers[it->second];
+    }
+
     // Get the change info for the given column, creating it if needed
     static ColumnInfo& get_change(ObserverState& state, size_t i)
     {
@@ -245,6 +288,7 @@ class TransactLogObserver : public TransactLogValidationMixin, public MarkDirtyM
     {
         invalidated.push_back(o->info);
         m_observers.erase(m_observers.begin() + (o - &m_observers[0]));
+        invalidate_observer_index();
     }
 
 public:
@@ -270,16 +314,25 @@ public:
         }
 
         std::sort(begin(m_observers), end(m_observers));
+        update_observer_cache();
         func(*this);
         context->did_change(m_observers, invalidated);
     }
 
+    bool select_table(size_t group_level_ndx, int len, const size_t* path) noexcept
+    {
+        TransactLogValidationMixin::select_table(group_level_ndx, len, path);
+        update_observer_cache();
+        return true;
+    }
+
     // Mark the given row/col as needing notifications sent
     void mark_dirty(size_t row_ndx, size_t col_ndx)
     {
-        auto it = lower_bound(begin(m_observers), end(m_observers), ObserverState{current_table(), row_ndx, nullptr});
-        if (it != end(m_observers) && it->table_ndx == current_table() && it->row_ndx == row_ndx) {
-            get_change(*it, col_ndx).kind = ColumnInfo::Kind::Set;
+        if (!m_has_observers_in_table)
+            return;
+        if (auto observer = find_observer(row_ndx)) {
+            get_change(*observer, col_ndx).kind = ColumnInfo::Kind::Set;
         }
     }
 
@@ -297,12 +350,15 @@ public:
                 ++observer.table_ndx;
         }
         TransactLogValidationMixin::insert_group_level_table(table_ndx, prior_size, name);
+        update_observer_cache();
+        invalidate_observer_index();
         return true;
     }
 
     bool insert_empty_rows(size_t row_ndx, size_t num_rows, size_t prior_size, bool)
     {
-        if (row_ndx != prior_size) {
+        if (m_has_observers_in_table && row_ndx != prior_size) {
+            invalidate_observer_index();
             for (auto& observer : m_observers) {
                 if (observer.table_ndx == current_table() && observer.row_ndx >= row_ndx)
                     observer.row_ndx += num_rows;
@@ -314,6 +370,9 @@ public:
     bool erase_rows(size_t row_ndx, size_t rows_to_erase, size_t prior_size, bool unordered)
     {
         REALM_ASSERT(unordered || rows_to_erase == 1);
+        if (!m_has_observers_in_table)
+            return true;
+        invalidate_observer_index();
         size_t last_row_ndx = prior_size - 1;
 
         if (unordered) {
@@ -357,6 +416,9 @@ public:
     bool swap_rows(size_t row_ndx_1, size_t row_ndx_2)
     {
         REALM_ASSERT(row_ndx_1 < row_ndx_2); // this is enforced by core
+        if (!m_has_observers_in_table)
+            return true;
+        invalidate_observer_index();
 
         auto end = m_observers.end();
         auto it_1 = lower_bound(begin(m_observers), end, ObserverState{current_table(), row_ndx_1, nullptr});
@@ -383,6 +445,9 @@ public:
     bool merge_rows(size_t from, size_t to)
     {
         REALM_ASSERT(from != to);
+        if (!m_has_observers_in_table)
+            return true;
+        invalidate_observer_index();
 
         auto end = m_observers.end();
         auto from_it = lower_bound(begin(m_observers), end, ObserverState{current_table(), from, nullptr});
@@ -403,6 +468,8 @@ public:
 
     bool clear_table()
     {
+        if (!m_has_observers_in_table)
+            return true;
         for (size_t i = 0; i < m_observers.size(); ) {
             auto& o = m_observers[i];
             if (o.table_ndx == current_table()) {
@@ -418,11 +485,10 @@ public:
     bool select_link_list(size_t col, size_t row, size_t)
     {
         m_active_linklist = nullptr;
-        for (auto& o : m_observers) {
-            if (o.table_ndx == current_table() && o.row_ndx == row) {
-                m_active_linklist = &get_change(o, col);
-                break;
-            }
+        if (!m_has_observers_in_table)
+            return true;
+        if (auto observer = find_observer(row)) {
+            m_active_linklist = &get_change(*observer, col);
         }
         return true;
     }
@@ -532,6 +598,8 @@ public:
 
     bool insert_column(size_t ndx, DataType, StringData, bool)
     {
+        if (!m_has_observers_in_table)
+            return true;
         for (auto& observer : m_observers) {
             if (observer.table_ndx == current_table()) {
                 expand_to(observer, ndx);
@@ -543,6 +611,8 @@ public:
 
     bool move_column(size_t from, size_t to)
     {
+        if (!m_has_observers_in_table)
+            return true;
         for (auto& observer : m_observers) {
             if (observer.table_ndx == current_table()) {
                 // have to initialize the columns one past the moved one so that
@@ -558,6 +628,8 @@ public:
     {
         for (auto& observer : m_observers)
             adjust_for_move(observer.table_ndx, from, to);
+        update_observer_cache();
+        invalidate_observer_index();
         return true;
     }
 
@@ -570,31 +642,49 @@ class LinkViewObserver : public TransactLogValidationMixin, public MarkDirtyMixi
     _impl::TransactionChangeInfo& m_info;
     _impl::CollectionChangeBuilder* m_active = nullptr;
 
-    _impl::CollectionChangeBuilder* get_change()
+    // Per-table state cached when the table is selected, so that instructions
+    // for tables no one is observing can be skipped with a single check
+    // rather than a lookup per instruction
+    _impl::CollectionChangeBuilder* m_active_table = nullptr;
+    bool m_need_move_info = false;
+    bool m_has_lists_in_table = false;
+
+    _impl::CollectionChangeBuilder* get_change() const noexcept { return m_active_table; }
+    bool need_move_info() const noexcept { return m_need_move_info; }
+
+    void update_active_table()
     {
         auto tbl_ndx = current_table();
+        m_need_move_info = tbl_ndx < m_info.table_moves_needed.size() && m_info.table_moves_needed[tbl_ndx];
+        m_has_lists_in_table = std::any_of(begin(m_info.lists), end(m_info.lists),
+                                           [&](auto const& lv) { return lv.table_ndx == tbl_ndx; });
+        m_active_table = nullptr;
         if (tbl_ndx >= m_info.table_modifications_needed.size() || !m_info.table_modifications_needed[tbl_ndx])
-            return nullptr;
+            return;
         if (m_info.tables.size() <= tbl_ndx) {
             m_info.tables.resize(std::max(m_info.tables.size() * 2, tbl_ndx + 1));
         }
-        return &m_info.tables[tbl_ndx];
+        m_active_table = &m_info.tables[tbl_ndx];
     }
 
-    bool need_move_info() const
+public:
+    LinkViewObserver(_impl::TransactionChangeInfo& info)
+    : m_info(info)
     {
-        auto tbl_ndx = current_table();
-        return tbl_ndx < m_info.table_moves_needed.size() && m_info.table_moves_needed[tbl_ndx];
+        update_active_table();
     }
 
-public:
-    LinkViewObserver(_impl::TransactionChangeInfo& info)
-    : m_info(info) { }
+    bool select_table(size_t group_level_ndx, int len, const size_t* path)
+    {
+        TransactLogValidationMixin::select_table(group_level_ndx, len, path);
+        update_active_table();
+        return true;
+    }
 
-    void mark_dirty(size_t row, size_t)
+    void mark_dirty(size_t row, size_t col)
     {
         if (auto change = get_change())
-            change->modify(row);
+            change->modify(row, col);
     }
 
     void parse_complete()
@@ -612,6 +702,8 @@ public:
         mark_dirty(row, col);
 
         m_active = nullptr;
+        if (!m_has_lists_in_table)
+            return true;
         // When there are multiple source versions there could be multiple
         // change objects for a single LinkView, in which case we need to use
         // the last one
@@ -676,9 +768,11 @@ public:
         REALM_ASSERT(!unordered);
         if (auto change = get_change())
             change->insert(row_ndx, num_rows_to_insert, need_move_info());
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table() && list.row_ndx >= row_ndx)
-                list.row_ndx += num_rows_to_insert;
+        if (m_has_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table() && list.row_ndx >= row_ndx)
+                    list.row_ndx += num_rows_to_insert;
+            }
         }
 
         return true;
@@ -689,17 +783,19 @@ public:
         REALM_ASSERT(unordered);
         size_t last_row = prior_num_rows - 1;
 
-        for (auto it = begin(m_info.lists); it != end(m_info.lists); ) {
-            if (it->table_ndx == current_table()) {
-                if (it->row_ndx == row_ndx) {
-                    *it = std::move(m_info.lists.back());
-                    m_info.lists.pop_back();
-                    continue;
+        if (m_has_lists_in_table) {
+            for (auto it = begin(m_info.lists); it != end(m_info.lists); ) {
+                if (it->table_ndx == current_table()) {
+                    if (it->row_ndx == row_ndx) {
+                        *it = std::move(m_info.lists.back());
+                        m_info.lists.pop_back();
+                        continue;
+                    }
+                    if (it->row_ndx == last_row)
+                        it->row_ndx = row_ndx;
                 }
-                if (it->row_ndx == last_row)
-                    it->row_ndx = row_ndx;
+                ++it;
             }
-            ++it;
         }
 
         if (auto change = get_change())
@@ -709,12 +805,14 @@ public:
 
     bool swap_rows(size_t row_ndx_1, size_t row_ndx_2) {
         REALM_ASSERT(row_ndx_1 < row_ndx_2);
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table()) {
-                if (list.row_ndx == row_ndx_1)
-                    list.row_ndx = row_ndx_2;
-                else if (list.row_ndx == row_ndx_2)
-                    list.row_ndx = row_ndx_1;
+        if (m_has_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table()) {
+                    if (list.row_ndx == row_ndx_1)
+                        list.row_ndx = row_ndx_2;
+                    else if (list.row_ndx == row_ndx_2)
+                        list.row_ndx = row_ndx_1;
+                }
             }
         }
         if (auto change = get_change())
@@ -724,9 +822,11 @@ public:
 
     bool merge_rows(size_t from, size_t to)
     {
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table() && list.row_ndx == from)
-                list.row_ndx = to;
+        if (m_has_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table() && list.row_ndx == from)
+                    list.row_ndx = to;
+            }
         }
         if (auto change = get_change())
             change->subsume(from, to, need_move_info());
@@ -735,10 +835,13 @@ public:
 
     bool clear_table()
     {
-        auto tbl_ndx = current_table();
-        auto it = remove_if(begin(m_info.lists), end(m_info.lists),
-                            [&](auto const& lv) { return lv.table_ndx == tbl_ndx; });
-        m_info.lists.erase(it, end(m_info.lists));
+        if (m_has_lists_in_table) {
+            auto tbl_ndx = current_table();
+            auto it = remove_if(begin(m_info.lists), end(m_info.lists),
+                                [&](auto const& lv) { return lv.table_ndx == tbl_ndx; });
+            m_info.lists.erase(it, end(m_info.lists));
+            m_has_lists_in_table = false;
+        }
         if (auto change = get_change())
             change->clear(std::numeric_limits<size_t>::max());
         return true;
@@ -746,9 +849,11 @@ public:
 
     bool insert_column(size_t ndx, DataType, StringData, bool)
     {
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table() && list.col_ndx >= ndx)
-                ++list.col_ndx;
+        if (m_has_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table() && list.col_ndx >= ndx)
+                    ++list.col_ndx;
+            }
         }
         return true;
     }
@@ -762,14 +867,17 @@ public:
         insert_empty_at(m_info.tables, ndx);
         insert_empty_at(m_info.table_moves_needed, ndx);
         insert_empty_at(m_info.table_modifications_needed, ndx);
+        update_active_table();
         return true;
     }
 
     bool move_column(size_t from, size_t to)
     {
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table())
-                adjust_for_move(list.col_ndx, from, to);
+        if (m_has_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table())
+                    adjust_for_move(list.col_ndx, from, to);
+            }
         }
         return true;
     }
@@ -781,6 +889,7 @@ public:
         rotate(m_info.tables, from, to);
         rotate(m_info.table_modifications_needed, from, to);
         rotate(m_info.table_moves_needed, from, to);
+        update_active_table();
         return true;
     }
 
@@ -792,8 +901,15 @@ public:
 namespace realm {
 namespace _impl {
 namespace transaction {
-void advance(SharedGroup& sg, BindingContext* context, SchemaMode schema_mode, SharedGroup::VersionID version)
+void advance(SharedGroup& sg, BindingContext* context, util::Optional<SchemaMode> schema_mode, SharedGroup::VersionID version)
 {
+    if (!context) {
+        // With no binding context there's no one to send notifications to,
+        // so we can skip parsing the transaction logs entirely. Realms with a
+        // binding context still validate the span when they advance over it
+        LangBindHelper::advance_read(sg, version);
+        return;
+    }
     TransactLogObserver(context, sg, [&](auto&&... args) {
         LangBindHelper::advance_read(sg, std::move(args)..., version);
     }, schema_mode);
@@ -840,6 +956,11 @@ void advance(SharedGroup& sg,
 
 }
 
+void advance_without_validation(SharedGroup& sg, SharedGroup::VersionID version)
+{
+    LangBindHelper::advance_read(sg, version);
+}
+
 } // namespace transaction
 } // namespace _impl
 } // namespace realm
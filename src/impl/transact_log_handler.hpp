@@ -20,6 +20,7 @@
 #define REALM_TRANSACT_LOG_HANDLER_HPP
 
 #include <realm/group_shared.hpp>
+#include <realm/util/optional.hpp>
 
 namespace realm {
 class BindingContext;
@@ -31,8 +32,11 @@ struct TransactionChangeInfo;
 namespace transaction {
 // Advance the read transaction version, with change notifications sent to delegate
 // Must not be called from within a write transaction.
+// If `schema_mode` is none the transaction logs are not validated against the
+// object store's schema rules, which is only valid when the version span has
+// already been validated on another SharedGroup for the same file.
 void advance(SharedGroup& sg, BindingContext* binding_context,
-             SchemaMode schema_mode,
+             util::Optional<SchemaMode> schema_mode,
              SharedGroup::VersionID version=SharedGroup::VersionID{});
 
 // Begin a write transaction
@@ -52,6 +56,12 @@ void cancel(SharedGroup& sg, BindingContext* binding_context);
 void advance(SharedGroup& sg,
              TransactionChangeInfo& info,
              SharedGroup::VersionID version=SharedGroup::VersionID{});
+
+// Advance the read transaction version without parsing the transaction logs
+// at all. Should only be used when the version span being advanced over has
+// been (or will be) validated by an observed advance on another SharedGroup.
+void advance_without_validation(SharedGroup& sg,
+                                SharedGroup::VersionID version=SharedGroup::VersionID{});
 } // namespace transaction
 } // namespace _impl
 } // namespace realm
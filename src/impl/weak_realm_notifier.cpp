@@ -28,7 +28,8 @@ WeakRealmNotifier::WeakRealmNotifier(const std::shared_ptr<Realm>& realm, bool c
 : m_realm(realm)
 , m_realm_key(realm.get())
 , m_cache(cache)
-, m_signal(std::make_shared<util::EventLoopSignal<Callback>>(Callback{realm}))
+, m_pending(std::make_shared<std::atomic<bool>>(false))
+, m_signal(std::make_shared<util::EventLoopSignal<Callback>>(Callback{realm, m_pending}))
 {
 }
 
@@ -36,6 +37,11 @@ WeakRealmNotifier::~WeakRealmNotifier() = default;
 
 void WeakRealmNotifier::Callback::operator()()
 {
+    // Clear the flag before notifying rather than after so that a commit
+    // made while notify() is running posts a new wakeup instead of being
+    // lost. Realm::notify() advances to the newest ready version, so the
+    // commits coalesced into this wakeup are all delivered by it.
+    pending->store(false);
     if (auto realm = weak_realm.lock()) {
         realm->notify();
     }
@@ -43,5 +49,7 @@ void WeakRealmNotifier::Callback::operator()()
 
 void WeakRealmNotifier::notify()
 {
-    m_signal->notify();
+    if (!m_pending->exchange(true)) {
+        m_signal->notify();
+    }
 }
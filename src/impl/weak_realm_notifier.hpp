@@ -19,6 +19,7 @@
 #ifndef REALM_WEAK_REALM_NOTIFIER_HPP
 #define REALM_WEAK_REALM_NOTIFIER_HPP
 
+#include <atomic>
 #include <memory>
 #include <thread>
 
@@ -54,6 +55,10 @@ public:
 
     bool is_for_current_thread() const { return m_thread_id == std::this_thread::get_id(); }
 
+    // Wake up the Realm's thread to have it call Realm::notify(). Bursts of
+    // calls are coalesced: if a previous wakeup has not yet been processed by
+    // the target thread no new one is posted, as the pending one will advance
+    // the Realm to the newest ready version anyway.
     void notify();
 
 private:
@@ -64,8 +69,13 @@ private:
 
     struct Callback {
         std::weak_ptr<Realm> weak_realm;
+        std::shared_ptr<std::atomic<bool>> pending;
         void operator()();
     };
+    // Whether a wakeup has been posted but not yet processed. Shared with the
+    // callback, which outlives this object if the signal is still queued when
+    // the Realm is unregistered.
+    std::shared_ptr<std::atomic<bool>> m_pending;
     std::shared_ptr<util::EventLoopSignal<Callback>> m_signal;
 };
 
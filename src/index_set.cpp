@@ -18,6 +18,8 @@
 
 #include "index_set.hpp"
 
+#include "util/metrics.hpp"
+
 #include <realm/util/assert.hpp>
 
 #include <algorithm>
@@ -69,8 +71,23 @@ void MutableChunkedRangeVectorIterator<T>::shift(ptrdiff_t distance)
     this->m_inner->second += distance;
 }
 
+std::vector<size_t> const& ChunkedRangeVector::prefix_counts() const
+{
+    if (!m_prefix_counts_valid) {
+        m_prefix_counts.resize(m_data.size());
+        size_t total = 0;
+        for (size_t i = 0; i < m_data.size(); ++i) {
+            total += m_data[i].count;
+            m_prefix_counts[i] = total;
+        }
+        m_prefix_counts_valid = true;
+    }
+    return m_prefix_counts;
+}
+
 void ChunkedRangeVector::push_back(value_type value)
 {
+    invalidate_prefix_counts();
     if (!empty() && m_data.back().data.size() < max_size) {
         auto& range = m_data.back();
         REALM_ASSERT(range.end <= value.first);
@@ -87,6 +104,7 @@ void ChunkedRangeVector::push_back(value_type value)
 
 ChunkedRangeVector::iterator ChunkedRangeVector::insert(iterator pos, value_type value)
 {
+    invalidate_prefix_counts();
     if (pos.m_outer == m_data.end()) {
         push_back(std::move(value));
         return std::prev(end());
@@ -108,6 +126,8 @@ ChunkedRangeVector::iterator ChunkedRangeVector::ensure_space(iterator pos)
     if (pos.m_outer->data.size() + 1 <= max_size)
         return pos;
 
+    util::g_metric_counters.index_set_chunk_splits.fetch_add(1, std::memory_order_relaxed);
+
     auto offset = pos.offset();
 
     // Split the chunk in half to make space for the new insertion
@@ -143,6 +163,7 @@ ChunkedRangeVector::iterator ChunkedRangeVector::ensure_space(iterator pos)
 
 ChunkedRangeVector::iterator ChunkedRangeVector::erase(iterator pos)
 {
+    invalidate_prefix_counts();
     auto offset = pos.offset();
     auto& chunk = *pos.m_outer;
     chunk.count -= pos->second - pos->first;
@@ -197,20 +218,27 @@ class ChunkedRangeVectorBuilder {
 public:
     using value_type = std::pair<size_t, size_t>;
 
-    ChunkedRangeVectorBuilder(ChunkedRangeVector const& expected);
+    ChunkedRangeVectorBuilder(ChunkedRangeVector& expected);
     void push_back(size_t index);
     void push_back(std::pair<size_t, size_t> range);
     std::vector<ChunkedRangeVector::Chunk> finalize();
+    // Replace `rv`'s ranges with the built ones, stashing the storage they
+    // were previously using for the next rebuild of the set to reuse
+    void finalize_into(ChunkedRangeVector& rv);
 private:
     std::vector<ChunkedRangeVector::Chunk> m_data;
     size_t m_outer_pos = 0;
 };
 
-ChunkedRangeVectorBuilder::ChunkedRangeVectorBuilder(ChunkedRangeVector const& expected)
+ChunkedRangeVectorBuilder::ChunkedRangeVectorBuilder(ChunkedRangeVector& expected)
 {
     size_t size = 0;
     for (auto const& chunk : expected.m_data)
         size += chunk.data.size();
+    // Reuse the chunk storage stashed by the previous rebuild of the set (if
+    // any) rather than allocating fresh buffers each time
+    m_data = std::move(expected.m_spare_data);
+    expected.m_spare_data.clear();
     m_data.resize(size / ChunkedRangeVector::max_size + 1);
     for (size_t i = 0; i < m_data.size() - 1; ++i)
         m_data[i].data.reserve(ChunkedRangeVector::max_size);
@@ -241,7 +269,7 @@ void ChunkedRangeVectorBuilder::push_back(std::pair<size_t, size_t> range)
         chunk.end = chunk.data.back().second;
         ++m_outer_pos;
         if (m_outer_pos >= m_data.size())
-            m_data.push_back({{range}, range.first, 0, 1});
+            m_data.push_back({{range}, range.first, 0, range.second - range.first});
         else {
             auto& chunk = m_data[m_outer_pos];
             chunk.data.push_back(range);
@@ -262,6 +290,19 @@ std::vector<ChunkedRangeVector::Chunk> ChunkedRangeVectorBuilder::finalize()
     }
     return std::move(m_data);
 }
+
+void ChunkedRangeVectorBuilder::finalize_into(ChunkedRangeVector& rv)
+{
+    auto old = std::move(rv.m_data);
+    rv.m_data = finalize();
+    rv.invalidate_prefix_counts();
+
+    // Empty out the old chunks but keep their buffers around to back the
+    // next rebuild of the set
+    for (auto& chunk : old)
+        chunk.data.clear();
+    rv.m_spare_data = std::move(old);
+}
 }
 
 IndexSet::IndexSet(std::initializer_list<size_t> values)
@@ -276,47 +317,53 @@ bool IndexSet::contains(size_t index) const
     return it != end() && it->first <= index;
 }
 
-size_t IndexSet::count(size_t start_index, size_t end_index) const
+void IndexSet::contains_each(std::vector<size_t> const& indexes, std::vector<bool>& results) const
 {
-    auto it = const_cast<IndexSet*>(this)->find(start_index);
-    const auto end = this->end();
-    if (it == end || it->first >= end_index) {
-        return 0;
-    }
-    if (it->second >= end_index)
-        return std::min(it->second, end_index) - std::max(it->first, start_index);
+    REALM_ASSERT_DEBUG(std::is_sorted(indexes.begin(), indexes.end()));
+    results.assign(indexes.size(), false);
 
-    size_t ret = 0;
-
-    if (start_index > it->first || it.offset() != 0) {
-        // Start index is in the middle of a chunk, so start by counting the
-        // rest of that chunk
-        ret = it->second - std::max(it->first, start_index);
-        for (++it; it != end && it->second < end_index && it.offset() != 0; ++it) {
-            ret += it->second - it->first;
+    auto it = cbegin(), last = cend();
+    for (size_t i = 0; i < indexes.size() && it != last; ++i) {
+        // Skip entire chunks which lie below the index before advancing
+        // range-by-range within the chunk containing it
+        while (it.outer()->end <= indexes[i]) {
+            it.next_chunk();
+            if (it == last)
+                return;
+        }
+        while (it->second <= indexes[i]) {
+            ++it;
+            if (it == last)
+                return;
         }
-        if (it != end && it->first < end_index && it.offset() != 0)
-            ret += end_index - it->first;
-        if (it == end || it->second >= end_index)
-            return ret;
+        results[i] = it->first <= indexes[i];
     }
+}
 
-    // Now count all complete chunks that fall within the range
-    while (it != end && it.outer()->end <= end_index) {
-        REALM_ASSERT_DEBUG(it.offset() == 0);
-        ret += it.outer()->count;
-        it.next_chunk();
-    }
+size_t IndexSet::count(size_t start_index, size_t end_index) const
+{
+    if (end_index <= start_index)
+        return 0;
+    return rank(end_index) - rank(start_index);
+}
 
-    // Cound all complete ranges within the last chunk
-    while (it != end && it->second <= end_index) {
-        ret += it->second - it->first;
-        ++it;
-    }
+size_t IndexSet::rank(size_t index) const
+{
+    auto& prefix_counts = this->prefix_counts();
 
-    // And finally add in the partial last range
-    if (it != end && it->first < end_index)
-        ret += end_index - it->first;
+    // Find the first chunk which has ranges at or past `index`; all chunks
+    // before it lie entirely below it
+    auto it = std::lower_bound(m_data.begin(), m_data.end(), index,
+                               [](auto const& chunk, size_t index) { return chunk.end <= index; });
+    size_t ret = it == m_data.begin() ? 0 : prefix_counts[it - m_data.begin() - 1];
+    if (it == m_data.end() || it->begin >= index)
+        return ret;
+
+    for (auto& range : it->data) {
+        if (range.first >= index)
+            break;
+        ret += std::min(range.second, index) - range.first;
+    }
     return ret;
 }
 
@@ -327,8 +374,15 @@ IndexSet::iterator IndexSet::find(size_t index)
 
 IndexSet::iterator IndexSet::find(size_t index, iterator begin)
 {
-    auto it = std::find_if(begin.outer(), m_data.end(),
-                           [&](auto const& lft) { return lft.end > index; });
+    // The chunks are ordered and disjoint, so we can skip the search entirely
+    // for appends (the common case when adding indexes in ascending order)
+    // and otherwise binary search rather than scanning the chunk vector. This
+    // matters for dense changesets, where a commit touching a large portion
+    // of the table can produce many thousands of chunks.
+    if (m_data.empty() || m_data.back().end <= index)
+        return end();
+    auto it = std::lower_bound(begin.outer(), m_data.end(), index,
+                               [](auto const& lft, size_t index) { return lft.end <= index; });
     if (it == m_data.end())
         return end();
     if (index < it->begin)
@@ -402,8 +456,7 @@ void IndexSet::add_shifted_by(IndexSet const& shifted_by, IndexSet const& values
             continue;
 
         for (; old_it != old_end && old_it->first <= index - new_shift + old_shift; ++old_it) {
-            for (size_t i = old_it->first; i < old_it->second; ++i)
-                builder.push_back(i);
+            builder.push_back(*old_it);
             old_shift += old_it->second - old_it->first;
         }
 
@@ -412,7 +465,7 @@ void IndexSet::add_shifted_by(IndexSet const& shifted_by, IndexSet const& values
     }
 
     copy(old_it, old_end, std::back_inserter(builder));
-    m_data = builder.finalize();
+    builder.finalize_into(*this);
 
 #ifdef REALM_DEBUG
     REALM_ASSERT((size_t)std::distance(as_indexes().begin(), as_indexes().end()) == expected);
@@ -430,6 +483,7 @@ void IndexSet::set(size_t len)
 void IndexSet::insert_at(size_t index, size_t count)
 {
     REALM_ASSERT(count > 0);
+    invalidate_prefix_counts();
 
     auto pos = find(index);
     auto end = this->end();
@@ -462,6 +516,27 @@ void IndexSet::insert_at(IndexSet const& positions)
         return;
     }
 
+    // Insertions past the end of the existing ranges don't shift anything,
+    // so the new ranges can be appended directly rather than rebuilding the
+    // whole set. This keeps merging a small append into a large accumulated
+    // changeset proportional to the append.
+    if (positions.m_data.front().begin >= m_data.back().end) {
+        invalidate_prefix_counts();
+        auto pos = positions.begin(), end = positions.end();
+        if (pos->first == m_data.back().end) {
+            // Extend the last range rather than leaving two adjacent ranges
+            auto& chunk = m_data.back();
+            chunk.count += pos->second - pos->first;
+            chunk.end = pos->second;
+            chunk.data.back().second = pos->second;
+            ++pos;
+        }
+        for (; pos != end; ++pos)
+            push_back(*pos);
+        verify();
+        return;
+    }
+
     IndexIterator begin1 = cbegin(), begin2 = positions.cbegin();
     IndexIterator end1 = cend(), end2 = positions.cend();
 
@@ -481,12 +556,13 @@ void IndexSet::insert_at(IndexSet const& positions)
     for (; begin2 != end2; ++begin2)
         builder.push_back(*begin2);
 
-    m_data = builder.finalize();
+    builder.finalize_into(*this);
 }
 
 void IndexSet::shift_for_insert_at(size_t index, size_t count)
 {
     REALM_ASSERT(count > 0);
+    invalidate_prefix_counts();
 
     auto it = find(index);
     if (it == end())
@@ -529,7 +605,7 @@ void IndexSet::shift_for_insert_at(realm::IndexSet const& values)
     for (; begin1 != end1; ++begin1)
         builder.push_back(*begin1 + shift);
 
-    m_data = builder.finalize();
+    builder.finalize_into(*this);
 }
 
 void IndexSet::erase_at(size_t index)
@@ -543,6 +619,10 @@ void IndexSet::erase_at(IndexSet const& positions)
 {
     if (empty() || positions.empty())
         return;
+    // Erasing at positions past the end of the existing ranges removes and
+    // shifts nothing
+    if (positions.m_data.front().begin >= m_data.back().end)
+        return;
 
     ChunkedRangeVectorBuilder builder(*this);
 
@@ -567,7 +647,7 @@ void IndexSet::erase_at(IndexSet const& positions)
     for (; begin1 != end1; ++begin1)
         builder.push_back(*begin1 - shift);
 
-    m_data = builder.finalize();
+    builder.finalize_into(*this);
 }
 
 size_t IndexSet::erase_or_unshift(size_t index)
@@ -596,6 +676,7 @@ size_t IndexSet::erase_or_unshift(size_t index)
 
 void IndexSet::do_erase(iterator it, size_t index)
 {
+    invalidate_prefix_counts();
     if (it->first <= index) {
         if (it->first + 1 == it->second) {
             it = erase(it);
@@ -616,6 +697,7 @@ void IndexSet::do_erase(iterator it, size_t index)
 
 IndexSet::iterator IndexSet::do_remove(iterator it, size_t begin, size_t end)
 {
+    invalidate_prefix_counts();
     for (it = find(begin, it); it != this->end() && it->first < end; it = find(begin, it)) {
         // Trim off any part of the range to remove that's before the matching range
         begin = std::max(it->first, begin);
@@ -655,8 +737,27 @@ void IndexSet::remove(realm::IndexSet const& values)
 
 size_t IndexSet::shift(size_t index) const
 {
-    // FIXME: optimize
-    for (auto range : *this) {
+    if (m_data.empty() || m_data.front().begin > index)
+        return index;
+    auto& prefix_counts = this->prefix_counts();
+
+    // The shifted index is the `index`-th value not in the set, so find the
+    // first chunk whose first range begins after more than `index` absent
+    // values, then walk the ranges of the chunk before it
+    auto first = std::lower_bound(m_data.begin(), m_data.end(), index,
+                                  [&](auto const& chunk, size_t index) {
+                                      size_t i = &chunk - &m_data[0];
+                                      size_t before = i == 0 ? 0 : prefix_counts[i - 1];
+                                      return chunk.begin - before <= index;
+                                  });
+    if (first == m_data.begin())
+        return index;
+
+    auto const& chunk = *std::prev(first);
+    size_t i = &chunk - &m_data[0];
+    if (i > 0)
+        index += prefix_counts[i - 1];
+    for (auto& range : chunk.data) {
         if (range.first > index)
             break;
         index += range.second - range.first;
@@ -673,11 +774,13 @@ size_t IndexSet::unshift(size_t index) const
 void IndexSet::clear()
 {
     m_data.clear();
+    invalidate_prefix_counts();
 }
 
 IndexSet::iterator IndexSet::do_add(iterator it, size_t index)
 {
     verify();
+    invalidate_prefix_counts();
     bool more_before = it != begin(), valid = it != end();
     REALM_ASSERT(!more_before || index >= std::prev(it)->second);
     if (valid && it->first <= index && it->second > index) {
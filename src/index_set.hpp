@@ -95,6 +95,10 @@ struct ChunkedRangeVector {
         size_t count;
     };
     std::vector<Chunk> m_data;
+    // Chunk storage retained from the previous bulk rebuild of this set,
+    // reused by the next rebuild so that steady-state merging of changesets
+    // does not have to allocate
+    std::vector<Chunk> m_spare_data;
 
     using value_type = std::pair<size_t, size_t>;
     using iterator = MutableChunkedRangeVectorIterator<typename decltype(m_data)::iterator>;
@@ -120,7 +124,18 @@ struct ChunkedRangeVector {
     void push_back(value_type value);
     iterator ensure_space(iterator pos);
 
+    // Get the cumulative count of the indexes in each chunk and all chunks
+    // before it, used to answer rank queries in O(log n) rather than walking
+    // the chunks. Built lazily on first use and discarded by
+    // invalidate_prefix_counts(), which every mutation must call.
+    std::vector<size_t> const& prefix_counts() const;
+    void invalidate_prefix_counts() noexcept { m_prefix_counts_valid = false; }
+
     void verify() const noexcept;
+
+private:
+    mutable std::vector<size_t> m_prefix_counts;
+    mutable bool m_prefix_counts_valid = false;
 };
 } // namespace _impl
 
@@ -142,6 +157,13 @@ public:
     // Check if the index set contains the given index
     bool contains(size_t index) const;
 
+    // Check each of the given indexes for membership in the set, setting the
+    // corresponding entry of `results` to true for the ones which are present.
+    // `indexes` must be sorted in ascending order. This is equivalent to
+    // calling contains() on each index, but performs a single merge over the
+    // set rather than a separate search per index.
+    void contains_each(std::vector<size_t> const& indexes, std::vector<bool>& results) const;
+
     // Counts the number of indices in the set in the given range
     size_t count(size_t start_index=0, size_t end_index=-1) const;
 
@@ -240,6 +262,8 @@ private:
     // none do
     iterator find(size_t index);
     iterator find(size_t index, iterator it);
+    // Get the number of indexes in the set which are less than `index`
+    size_t rank(size_t index) const;
     // Insert the index before the given position, combining existing ranges as
     // applicable
     // returns inserted position
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "lazy_schema.hpp"
+
+#include "object_store.hpp"
+#include "schema.hpp"
+
+#include <realm/group.hpp>
+
+using namespace realm;
+
+LazySchema::LazySchema(Group const& group)
+: m_group(group)
+, m_object_schemas(group.size())
+{
+    // Counting the classes only looks at the table names, not their shapes
+    for (size_t i = 0, count = group.size(); i < count; ++i) {
+        if (ObjectStore::object_type_for_table_name(group.get_table_name(i)).size()) {
+            ++m_class_count;
+        }
+    }
+}
+
+std::vector<StringData> LazySchema::object_types() const
+{
+    std::vector<StringData> types;
+    types.reserve(m_class_count);
+    for (size_t i = 0, count = m_group.size(); i < count; ++i) {
+        auto object_type = ObjectStore::object_type_for_table_name(m_group.get_table_name(i));
+        if (object_type.size()) {
+            types.push_back(object_type);
+        }
+    }
+    return types;
+}
+
+ObjectSchema const* LazySchema::get(StringData object_type)
+{
+    auto table = ObjectStore::table_for_object_type(m_group, object_type);
+    if (!table) {
+        return nullptr;
+    }
+    auto& object_schema = m_object_schemas[table->get_index_in_group()];
+    if (!object_schema) {
+        object_schema = ObjectSchema(m_group, object_type, table->get_index_in_group());
+    }
+    return &*object_schema;
+}
+
+std::vector<SchemaChange> LazySchema::compare(ObjectSchema const& target)
+{
+    if (auto existing = get(target.name)) {
+        return Schema::compare(*existing, target);
+    }
+    return {schema_change::AddTable{&target}};
+}
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_LAZY_SCHEMA_HPP
+#define REALM_LAZY_SCHEMA_HPP
+
+#include "object_schema.hpp"
+
+#include <realm/util/optional.hpp>
+
+#include <vector>
+
+namespace realm {
+class Group;
+class SchemaChange;
+
+// A read-only view of the schema stored in a Group which resolves each
+// class's ObjectSchema from the Group the first time that class is asked
+// for, rather than reading every class up front the way
+// ObjectStore::schema_from_group() does. Tooling which opens dynamic Realms
+// containing many classes but only inspects a few of them should prefer
+// this over materializing a full Schema, as the work done is proportional
+// to the number of classes actually touched rather than the size of the
+// file's schema.
+//
+// The view reads from the Group it was constructed with and caches what it
+// reads, so it is valid only as long as the Group is, and must be discarded
+// if the Group's schema may have changed (e.g. when the owning transaction
+// is advanced to a different version).
+class LazySchema {
+public:
+    explicit LazySchema(Group const& group);
+
+    // number of object classes stored in the group
+    size_t size() const noexcept { return m_class_count; }
+
+    // names of all of the object classes stored in the group, in table
+    // order. Only the table names are read; none of the classes are
+    // resolved.
+    std::vector<StringData> object_types() const;
+
+    // get the schema for a single class, resolving it from the group on
+    // first access. Returns nullptr if the group has no such class. The
+    // returned pointer remains valid for the lifetime of the view.
+    ObjectSchema const* get(StringData object_type);
+
+    // Get the changes which must be applied to the class in the group with
+    // target's name to produce target, resolving only that class. Produces
+    // AddTable if the group does not contain the class. As with
+    // Schema::compare(), the returned changes hold pointers into the view's
+    // classes and into `target`.
+    std::vector<SchemaChange> compare(ObjectSchema const& target);
+
+private:
+    Group const& m_group;
+    // One slot per table in the group, in table order; slots for tables
+    // which are not object classes are never populated. Sized up front so
+    // that resolving a class never moves previously returned ObjectSchemas.
+    std::vector<util::Optional<ObjectSchema>> m_object_schemas;
+    size_t m_class_count = 0;
+};
+}
+
+#endif /* defined(REALM_LAZY_SCHEMA_HPP) */
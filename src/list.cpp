@@ -28,6 +28,8 @@
 
 #include <realm/link_view.hpp>
 
+#include <algorithm>
+
 using namespace realm;
 using namespace realm::_impl;
 
@@ -162,6 +164,59 @@ void List::remove_all()
     m_link_view->clear();
 }
 
+void List::add_all(std::vector<size_t> const& target_row_ndxs)
+{
+    verify_in_transaction();
+    for (auto target_row_ndx : target_row_ndxs) {
+        m_link_view->add(target_row_ndx);
+    }
+}
+
+void List::insert_all(size_t list_ndx, std::vector<size_t> const& target_row_ndxs)
+{
+    verify_in_transaction();
+    verify_valid_row(list_ndx, true);
+    for (auto target_row_ndx : target_row_ndxs) {
+        m_link_view->insert(list_ndx++, target_row_ndx);
+    }
+}
+
+void List::remove_range(size_t begin, size_t end)
+{
+    verify_in_transaction();
+    if (begin > end) {
+        throw OutOfBoundsIndexException{begin, end};
+    }
+    verify_valid_row(end, true);
+    // back to front so that the elements before `begin` are the only ones
+    // which ever shift
+    while (end > begin) {
+        m_link_view->remove(--end);
+    }
+}
+
+void List::assign(std::vector<size_t> const& target_row_ndxs)
+{
+    verify_in_transaction();
+    size_t old_size = m_link_view->size();
+    size_t new_size = target_row_ndxs.size();
+
+    // overwrite the common prefix in place, skipping unchanged elements so
+    // that they do not appear in the change set at all
+    size_t common = std::min(old_size, new_size);
+    for (size_t i = 0; i < common; ++i) {
+        if (m_link_view->get(i).get_index() != target_row_ndxs[i]) {
+            m_link_view->set(i, target_row_ndxs[i]);
+        }
+    }
+    for (size_t i = common; i < new_size; ++i) {
+        m_link_view->add(target_row_ndxs[i]);
+    }
+    while (old_size > new_size) {
+        m_link_view->remove(--old_size);
+    }
+}
+
 void List::set(size_t row_ndx, size_t target_row_ndx)
 {
     verify_in_transaction();
@@ -27,6 +27,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace realm {
 using RowExpr = BasicRowExpr<Table>;
@@ -71,6 +72,19 @@ public:
     void set(size_t row_ndx, size_t target_row_ndx);
     void swap(size_t ndx1, size_t ndx2);
 
+    // Batch mutations: one verification for the whole batch, and the
+    // contiguous modifications coalesce into a single range in the change
+    // set delivered to notifiers rather than one entry per element.
+    void add_all(std::vector<size_t> const& target_row_ndxs);
+    void insert_all(size_t list_ndx, std::vector<size_t> const& target_row_ndxs);
+    // Remove the half-open range [begin, end)
+    void remove_range(size_t begin, size_t end);
+    // Replace the contents with the given targets in one pass: matching
+    // prefix elements are left untouched, differing ones are overwritten in
+    // place, and the length is adjusted at the tail, so assigning a mostly
+    // unchanged list emits instructions only for what actually changed.
+    void assign(std::vector<size_t> const& target_row_ndxs);
+
     void delete_all();
 
     Results sort(SortDescriptor order);
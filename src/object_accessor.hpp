@@ -27,9 +27,13 @@
 #include "shared_realm.hpp"
 #include "util/format.hpp"
 
+#include <array>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <realm/link_view.hpp>
 #include <realm/table_view.hpp>
+#include <realm/util/optional.hpp>
 
 namespace realm {
 
@@ -38,15 +42,42 @@ namespace realm {
         Object(SharedRealm r, const ObjectSchema &s, Row o) : m_realm(r), m_object_schema(&s), m_row(o) {}
 
         // property getter/setter
+        // when `only_if_changed` is set, the current cell is read first and
+        // identical writes are skipped, so that re-saving unchanged data does
+        // not grow the transaction log or mark the object as modified for
+        // notification purposes
         template<typename ValueType, typename ContextType>
-        inline void set_property_value(ContextType ctx, std::string prop_name, ValueType value, bool try_update);
+        inline void set_property_value(ContextType ctx, std::string prop_name, ValueType value, bool try_update, bool only_if_changed = false);
 
         template<typename ValueType, typename ContextType>
         inline ValueType get_property_value(ContextType ctx, std::string prop_name);
 
+        // zero-copy reads for string and binary properties. The returned
+        // view points directly into the Realm file's mapped memory; nothing
+        // is copied through the accessor layer. The Realm's active read
+        // transaction pins the data: the view remains valid only while the
+        // object stays attached and the Realm stays on its current version,
+        // so refresh(), beginning or committing a write transaction, or
+        // delivering notifications all invalidate it. Copy the data out
+        // before letting the Realm advance if it needs to outlive that.
+        inline StringData get_string_view(std::string const& prop_name);
+        inline BinaryData get_binary_view(std::string const& prop_name);
+
         // create an Object from a native representation
         template<typename ValueType, typename ContextType>
-        static inline Object create(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType value, bool try_update);
+        static inline Object create(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType value, bool try_update, bool only_if_changed = false);
+
+        // create multiple Objects from native representations in one batch.
+        // All of the rows are added up front and then populated
+        // column-by-column, so each column's type dispatch and default value
+        // lookup is resolved once per column rather than once per cell.
+        // Types with a primary key are populated row-wise (updates may target
+        // arbitrary existing rows), but the per-object primary key search is
+        // replaced by one pass building a PK -> row map which is then probed
+        // per object, so upserting a batch does O(1) lookups instead of a
+        // find_first() per object.
+        template<typename ValueType, typename ContextType>
+        static std::vector<Object> create_bulk(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, std::vector<ValueType> values, bool try_update, bool only_if_changed = false);
 
         template<typename ValueType, typename ContextType>
         static Object get_for_primary_key(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType primary_value);
@@ -63,10 +94,15 @@ namespace realm {
         Row m_row;
 
         template<typename ValueType, typename ContextType>
-        inline void set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update);
+        inline void set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update, bool only_if_changed = false);
         template<typename ValueType, typename ContextType>
         inline ValueType get_property_value_impl(ContextType ctx, const Property &property);
 
+        // set every non-primary property from the native representation,
+        // applying default values and nullability rules for newly created rows
+        template<typename ValueType, typename ContextType>
+        inline void populate_properties(ContextType ctx, ValueType value, bool created, bool try_update, bool only_if_changed = false);
+
         template<typename ValueType, typename ContextType>
         static size_t get_for_primary_key_impl(ContextType ctx, const ConstTableRef &table, const Property &primary_prop, ValueType primary_value);
         
@@ -166,14 +202,14 @@ namespace realm {
     // template method implementations
     //
     template <typename ValueType, typename ContextType>
-    inline void Object::set_property_value(ContextType ctx, std::string prop_name, ValueType value, bool try_update)
+    inline void Object::set_property_value(ContextType ctx, std::string prop_name, ValueType value, bool try_update, bool only_if_changed)
     {
         const Property *prop = m_object_schema->property_for_name(prop_name);
         if (!prop) {
             throw InvalidPropertyException(m_object_schema->name, prop_name,
                 "Setting invalid property '" + prop_name + "' on object '" + m_object_schema->name + "'.");
         }
-        set_property_value_impl(ctx, *prop, value, try_update);
+        set_property_value_impl(ctx, *prop, value, try_update, only_if_changed);
     }
 
     template <typename ValueType, typename ContextType>
@@ -188,7 +224,7 @@ namespace realm {
     }
 
     template <typename ValueType, typename ContextType>
-    inline void Object::set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update)
+    inline void Object::set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update, bool only_if_changed)
     {
         using Accessor = NativeAccessor<ValueType, ContextType>;
 
@@ -201,73 +237,136 @@ namespace realm {
         size_t column = property.table_column;
         if (property.is_nullable && Accessor::is_null(ctx, value)) {
             if (property.type == PropertyType::Object) {
-                m_row.nullify_link(column);
+                if (!only_if_changed || !m_row.is_null_link(column))
+                    m_row.nullify_link(column);
             }
-            else {
+            else if (!only_if_changed || !m_row.is_null(column)) {
                 m_row.set_null(column);
             }
             return;
         }
 
-        switch (property.type) {
-            case PropertyType::Bool:
-                m_row.set_bool(column, Accessor::to_bool(ctx, value));
-                break;
-            case PropertyType::Int:
-                if (property.is_primary)
-                    m_row.set_int_unique(column, Accessor::to_long(ctx, value));
+        // when writing only changed values, a currently-null cell always
+        // needs the write, and must not be read as its type
+        bool cell_is_null = only_if_changed && property.is_nullable && m_row.is_null(column);
+
+        // Flat dispatch table indexed by the property's type, built once per
+        // accessor instantiation. The equivalent switch predicts poorly on
+        // objects mixing many property types; this makes each write a single
+        // indexed indirect call.
+        using Setter = void (*)(Object&, ContextType, const Property&, ValueType&, bool, bool, bool);
+        static const std::array<Setter, 16> s_setters = [] {
+            std::array<Setter, 16> table{};
+            auto add = [&](PropertyType type, Setter setter) {
+                table[static_cast<size_t>(type)] = setter;
+            };
+            add(PropertyType::Bool, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
+                bool new_value = Accessor::to_bool(ctx, value);
+                if (!only_if_changed || cell_is_null || obj.m_row.get_bool(column) != new_value)
+                    obj.m_row.set_bool(column, new_value);
+            });
+            add(PropertyType::Int, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
+                long long new_value = Accessor::to_long(ctx, value);
+                if (only_if_changed && !cell_is_null && obj.m_row.get_int(column) == new_value)
+                    return;
+                if (prop.is_primary)
+                    obj.m_row.set_int_unique(column, new_value);
                 else
-                    m_row.set_int(column, Accessor::to_long(ctx, value));
-                break;
-            case PropertyType::Float:
-                m_row.set_float(column, Accessor::to_float(ctx, value));
-                break;
-            case PropertyType::Double:
-                m_row.set_double(column, Accessor::to_double(ctx, value));
-                break;
-            case PropertyType::String: {
+                    obj.m_row.set_int(column, new_value);
+            });
+            add(PropertyType::Float, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
+                float new_value = Accessor::to_float(ctx, value);
+                if (!only_if_changed || cell_is_null || obj.m_row.get_float(column) != new_value)
+                    obj.m_row.set_float(column, new_value);
+            });
+            add(PropertyType::Double, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
+                double new_value = Accessor::to_double(ctx, value);
+                if (!only_if_changed || cell_is_null || obj.m_row.get_double(column) != new_value)
+                    obj.m_row.set_double(column, new_value);
+            });
+            add(PropertyType::String, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
                 auto string_value = Accessor::to_string(ctx, value);
-                if (property.is_primary)
-                    m_row.set_string_unique(column, string_value);
+                if (only_if_changed && !cell_is_null && obj.m_row.get_string(column) == StringData(string_value))
+                    return;
+                if (prop.is_primary)
+                    obj.m_row.set_string_unique(column, string_value);
                 else
-                    m_row.set_string(column, string_value);
-                break;
-            }
-            case PropertyType::Data:
-                m_row.set_binary(column, BinaryData(Accessor::to_binary(ctx, value)));
-                break;
-            case PropertyType::Any:
-                m_row.set_mixed(column, Accessor::to_mixed(ctx, value));
-                break;
-            case PropertyType::Date:
-                m_row.set_timestamp(column, Accessor::to_timestamp(ctx, value));
-                break;
-            case PropertyType::Object: {
+                    obj.m_row.set_string(column, string_value);
+            });
+            add(PropertyType::Data, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
+                auto binary_value = Accessor::to_binary(ctx, value);
+                if (!only_if_changed || cell_is_null || obj.m_row.get_binary(column) != BinaryData(binary_value))
+                    obj.m_row.set_binary(column, BinaryData(binary_value));
+            });
+            add(PropertyType::Any, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool, bool) {
+                obj.m_row.set_mixed(prop.table_column, Accessor::to_mixed(ctx, value));
+            });
+            add(PropertyType::Date, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool, bool only_if_changed, bool cell_is_null) {
+                size_t column = prop.table_column;
+                auto new_value = Accessor::to_timestamp(ctx, value);
+                if (!only_if_changed || cell_is_null || obj.m_row.get_timestamp(column) != new_value)
+                    obj.m_row.set_timestamp(column, new_value);
+            });
+            add(PropertyType::Object, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool try_update, bool only_if_changed, bool) {
+                size_t column = prop.table_column;
                 if (Accessor::is_null(ctx, value)) {
-                    m_row.nullify_link(column);
+                    if (!only_if_changed || !obj.m_row.is_null_link(column))
+                        obj.m_row.nullify_link(column);
                 }
                 else {
-                    m_row.set_link(column, Accessor::to_object_index(ctx, m_realm, value, property.object_type, try_update));
+                    size_t target = Accessor::to_object_index(ctx, obj.m_realm, value, prop.object_type, try_update);
+                    if (!only_if_changed || obj.m_row.is_null_link(column) || obj.m_row.get_link(column) != target)
+                        obj.m_row.set_link(column, target);
+                }
+            });
+            add(PropertyType::Array, [](Object& obj, ContextType ctx, const Property& prop, ValueType& value, bool try_update, bool only_if_changed, bool) {
+                realm::LinkViewRef link_view = obj.m_row.get_linklist(prop.table_column);
+                if (only_if_changed) {
+                    // resolve the new contents first (which may create linked
+                    // objects) and rewrite the list only if it actually differs
+                    std::vector<size_t> new_rows;
+                    if (!Accessor::is_null(ctx, value)) {
+                        size_t count = Accessor::list_size(ctx, value);
+                        new_rows.reserve(count);
+                        for (size_t i = 0; i < count; i++) {
+                            ValueType element = Accessor::list_value_at_index(ctx, value, i);
+                            new_rows.push_back(Accessor::to_object_index(ctx, obj.m_realm, element, prop.object_type, try_update));
+                        }
+                    }
+                    bool changed = link_view->size() != new_rows.size();
+                    for (size_t i = 0; !changed && i < new_rows.size(); i++) {
+                        changed = link_view->get(i).get_index() != new_rows[i];
+                    }
+                    if (changed) {
+                        link_view->clear();
+                        for (auto row : new_rows)
+                            link_view->add(row);
+                    }
+                    return;
                 }
-                break;
-            }
-            case PropertyType::Array: {
-                realm::LinkViewRef link_view = m_row.get_linklist(column);
                 link_view->clear();
                 if (!Accessor::is_null(ctx, value)) {
                     size_t count = Accessor::list_size(ctx, value);
                     for (size_t i = 0; i < count; i++) {
                         ValueType element = Accessor::list_value_at_index(ctx, value, i);
-                        link_view->add(Accessor::to_object_index(ctx, m_realm, element, property.object_type, try_update));
+                        link_view->add(Accessor::to_object_index(ctx, obj.m_realm, element, prop.object_type, try_update));
                     }
                 }
-                break;
-            }
-            case PropertyType::LinkingObjects:
-                throw ReadOnlyPropertyException(m_object_schema->name, property.name,
+            });
+            add(PropertyType::LinkingObjects, [](Object& obj, ContextType, const Property& prop, ValueType&, bool, bool, bool) {
+                throw ReadOnlyPropertyException(obj.m_object_schema->name, prop.name,
                                                 util::format("Cannot modify read-only property '%1.%2'",
-                                                             m_object_schema->name, property.name));
-        }
+                                                             obj.m_object_schema->name, prop.name));
+            });
+            return table;
+        }();
+        s_setters[static_cast<size_t>(property.type)](*this, ctx, property, value, try_update, only_if_changed, cell_is_null);
     }
 
     template <typename ValueType, typename ContextType>
@@ -282,46 +381,64 @@ namespace realm {
             return Accessor::null_value(ctx);
         }
 
-        switch (property.type) {
-            case PropertyType::Bool:
-                return Accessor::from_bool(ctx, m_row.get_bool(column));
-            case PropertyType::Int:
-                return Accessor::from_long(ctx, m_row.get_int(column));
-            case PropertyType::Float:
-                return Accessor::from_float(ctx, m_row.get_float(column));
-            case PropertyType::Double:
-                return Accessor::from_double(ctx, m_row.get_double(column));
-            case PropertyType::String:
-                return Accessor::from_string(ctx, m_row.get_string(column));
-            case PropertyType::Data:
-                return Accessor::from_binary(ctx, m_row.get_binary(column));
-            case PropertyType::Any:
+        // Flat dispatch table indexed by the property's type; see
+        // set_property_value_impl() for the rationale.
+        using Getter = ValueType (*)(Object&, ContextType, const Property&);
+        static const std::array<Getter, 16> s_getters = [] {
+            std::array<Getter, 16> table{};
+            auto add = [&](PropertyType type, Getter getter) {
+                table[static_cast<size_t>(type)] = getter;
+            };
+            add(PropertyType::Bool, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_bool(ctx, obj.m_row.get_bool(prop.table_column));
+            });
+            add(PropertyType::Int, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_long(ctx, obj.m_row.get_int(prop.table_column));
+            });
+            add(PropertyType::Float, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_float(ctx, obj.m_row.get_float(prop.table_column));
+            });
+            add(PropertyType::Double, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_double(ctx, obj.m_row.get_double(prop.table_column));
+            });
+            add(PropertyType::String, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_string(ctx, obj.m_row.get_string(prop.table_column));
+            });
+            add(PropertyType::Data, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_binary(ctx, obj.m_row.get_binary(prop.table_column));
+            });
+            add(PropertyType::Any, [](Object&, ContextType, const Property&) -> ValueType {
                 throw "Any not supported";
-            case PropertyType::Date:
-                return Accessor::from_timestamp(ctx, m_row.get_timestamp(column));
-            case PropertyType::Object: {
-                auto linkObjectSchema = m_realm->schema().find(property.object_type);
-                TableRef table = ObjectStore::table_for_object_type(m_realm->read_group(), linkObjectSchema->name);
-                if (m_row.is_null_link(property.table_column)) {
+            });
+            add(PropertyType::Date, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_timestamp(ctx, obj.m_row.get_timestamp(prop.table_column));
+            });
+            add(PropertyType::Object, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                auto linkObjectSchema = obj.m_realm->schema().find(prop.object_type);
+                TableRef table = ObjectStore::table_for_object_type(obj.m_realm->read_group(), *linkObjectSchema);
+                if (obj.m_row.is_null_link(prop.table_column)) {
                     return Accessor::null_value(ctx);
                 }
-                return Accessor::from_object(ctx, std::move(Object(m_realm, *linkObjectSchema, table->get(m_row.get_link(column)))));
-            }
-            case PropertyType::Array:
-                return Accessor::from_list(ctx, List(m_realm, static_cast<LinkViewRef>(m_row.get_linklist(column))));
-            case PropertyType::LinkingObjects: {
-                auto target_object_schema = m_realm->config().schema->find(property.object_type);
-                auto link_property = target_object_schema->property_for_name(property.link_origin_property_name);
-                TableRef table = ObjectStore::table_for_object_type(m_realm->read_group(), target_object_schema->name);
-                auto tv = m_row.get_table()->get_backlink_view(m_row.get_index(), table.get(), link_property->table_column);
-                Results results(m_realm, std::move(tv));
+                return Accessor::from_object(ctx, std::move(Object(obj.m_realm, *linkObjectSchema, table->get(obj.m_row.get_link(prop.table_column)))));
+            });
+            add(PropertyType::Array, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                return Accessor::from_list(ctx, List(obj.m_realm, static_cast<LinkViewRef>(obj.m_row.get_linklist(prop.table_column))));
+            });
+            add(PropertyType::LinkingObjects, [](Object& obj, ContextType ctx, const Property& prop) -> ValueType {
+                auto target_object_schema = obj.m_realm->config().schema->find(prop.object_type);
+                auto link_property = target_object_schema->property_for_name(prop.link_origin_property_name);
+                TableRef table = ObjectStore::table_for_object_type(obj.m_realm->read_group(), *target_object_schema);
+                auto tv = obj.m_row.get_table()->get_backlink_view(obj.m_row.get_index(), table.get(), link_property->table_column);
+                Results results(obj.m_realm, std::move(tv));
                 return Accessor::from_results(ctx, std::move(results));
-            }
-        }
+            });
+            return table;
+        }();
+        return s_getters[static_cast<size_t>(property.type)](*this, ctx, property);
     }
 
     template<typename ValueType, typename ContextType>
-    inline Object Object::create(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType value, bool try_update)
+    inline Object Object::create(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType value, bool try_update, bool only_if_changed)
     {
         using Accessor = NativeAccessor<ValueType, ContextType>;
 
@@ -334,7 +451,7 @@ namespace realm {
 
         // try to get existing row if updating
         size_t row_index = realm::not_found;
-        realm::TableRef table = ObjectStore::table_for_object_type(realm->read_group(), object_schema.name);
+        realm::TableRef table = ObjectStore::table_for_object_type(realm->read_group(), object_schema);
         const Property *primary_prop = object_schema.primary_key_property();
 
         if (primary_prop) {
@@ -359,17 +476,27 @@ namespace realm {
 
         // populate
         Object object(realm, object_schema, table->get(row_index));
+        object.populate_properties(ctx, value, created, try_update, only_if_changed && !created);
+        return object;
+    }
+
+    template <typename ValueType, typename ContextType>
+    inline void Object::populate_properties(ContextType ctx, ValueType value, bool created, bool try_update, bool only_if_changed)
+    {
+        using Accessor = NativeAccessor<ValueType, ContextType>;
+
+        auto& object_schema = *m_object_schema;
         for (const Property& prop : object_schema.persisted_properties) {
             if (!prop.is_primary) {
                 if (Accessor::dict_has_value_for_key(ctx, value, prop.name)) {
-                    object.set_property_value_impl(ctx, prop, Accessor::dict_value_for_key(ctx, value, prop.name), try_update);
+                    set_property_value_impl(ctx, prop, Accessor::dict_value_for_key(ctx, value, prop.name), try_update, only_if_changed);
                 }
                 else if (created) {
-                    if (Accessor::has_default_value_for_property(ctx, realm.get(), object_schema, prop.name)) {
-                        object.set_property_value_impl(ctx, prop, Accessor::default_value_for_property(ctx, realm.get(), object_schema, prop.name), try_update);
+                    if (Accessor::has_default_value_for_property(ctx, m_realm.get(), object_schema, prop.name)) {
+                        set_property_value_impl(ctx, prop, Accessor::default_value_for_property(ctx, m_realm.get(), object_schema, prop.name), try_update);
                     }
                     else if (prop.is_nullable || prop.type == PropertyType::Array) {
-                        object.set_property_value_impl(ctx, prop, Accessor::null_value(ctx), try_update);
+                        set_property_value_impl(ctx, prop, Accessor::null_value(ctx), try_update);
                     }
                     else {
                         throw MissingPropertyValueException(object_schema.name, prop.name,
@@ -378,7 +505,211 @@ namespace realm {
                 }
             }
         }
-        return object;
+    }
+
+    template<typename ValueType, typename ContextType>
+    std::vector<Object> Object::create_bulk(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, std::vector<ValueType> values, bool try_update, bool only_if_changed)
+    {
+        using Accessor = NativeAccessor<ValueType, ContextType>;
+
+        if (!realm->is_in_transaction()) {
+            throw MutationOutsideTransactionException("Can only create objects within a transaction.");
+        }
+
+        std::vector<Object> objects;
+        objects.reserve(values.size());
+
+        realm::TableRef table = ObjectStore::table_for_object_type(realm->read_group(), object_schema);
+
+        if (const Property* primary_prop = object_schema.primary_key_property()) {
+            // updates may target existing non-contiguous rows, so there is no
+            // column-wise population to be had here, but the per-object
+            // find_first() on the primary key column can be replaced by one
+            // pass building a PK -> row map which is then probed per object
+            size_t pk_column = primary_prop->table_column;
+            size_t row_count = table->size();
+            bool string_pk = primary_prop->type == PropertyType::String;
+
+            std::unordered_map<std::string, size_t> string_pks;
+            std::unordered_map<int64_t, size_t> int_pks;
+            if (string_pk) {
+                string_pks.reserve(row_count + values.size());
+                for (size_t i = 0; i < row_count; i++) {
+                    string_pks.emplace(std::string(table->get_string(pk_column, i)), i);
+                }
+            }
+            else {
+                int_pks.reserve(row_count + values.size());
+                for (size_t i = 0; i < row_count; i++) {
+                    int_pks.emplace(table->get_int(pk_column, i), i);
+                }
+            }
+
+            for (auto& value : values) {
+                ValueType primary_value = Accessor::dict_value_for_key(ctx, value, object_schema.primary_key);
+                size_t row_index = realm::not_found;
+                bool created = false;
+                if (string_pk) {
+                    auto key = Accessor::to_string(ctx, primary_value);
+                    auto it = string_pks.find(key);
+                    if (it != string_pks.end()) {
+                        row_index = it->second;
+                    }
+                    else {
+                        row_index = table->add_empty_row();
+                        string_pks.emplace(std::move(key), row_index);
+                        created = true;
+                    }
+                }
+                else {
+                    auto key = Accessor::to_long(ctx, primary_value);
+                    auto it = int_pks.find(key);
+                    if (it != int_pks.end()) {
+                        row_index = it->second;
+                    }
+                    else {
+                        row_index = table->add_empty_row();
+                        int_pks.emplace(key, row_index);
+                        created = true;
+                    }
+                }
+
+                Object object(realm, object_schema, table->get(row_index));
+                if (created) {
+                    object.set_property_value_impl(ctx, *primary_prop, primary_value, try_update);
+                }
+                else if (!try_update) {
+                    throw std::logic_error(util::format("Attempting to create an object of type '%1' with an existing primary key value.", object_schema.name));
+                }
+                object.populate_properties(ctx, value, created, try_update, only_if_changed && !created);
+                objects.push_back(std::move(object));
+            }
+            return objects;
+        }
+
+        size_t count = values.size();
+        size_t first_row = table->add_empty_row(count);
+
+        for (const Property& prop : object_schema.persisted_properties) {
+            size_t column = prop.table_column;
+
+            util::Optional<ValueType> default_value;
+            if (Accessor::has_default_value_for_property(ctx, realm.get(), object_schema, prop.name)) {
+                default_value = Accessor::default_value_for_property(ctx, realm.get(), object_schema, prop.name);
+            }
+
+            // resolve the value for this property in row `i`, applying the
+            // same default/null/missing rules as create()
+            auto cell = [&](size_t i) -> ValueType {
+                if (Accessor::dict_has_value_for_key(ctx, values[i], prop.name)) {
+                    return Accessor::dict_value_for_key(ctx, values[i], prop.name);
+                }
+                if (default_value) {
+                    return *default_value;
+                }
+                if (prop.is_nullable || prop.type == PropertyType::Array) {
+                    return Accessor::null_value(ctx);
+                }
+                throw MissingPropertyValueException(object_schema.name, prop.name,
+                    "Missing property value for property " + prop.name);
+            };
+            auto set_null_if_needed = [&](size_t i, ValueType& v) {
+                if (prop.is_nullable && Accessor::is_null(ctx, v)) {
+                    table->set_null(column, first_row + i);
+                    return true;
+                }
+                return false;
+            };
+
+            switch (prop.type) {
+                case PropertyType::Bool:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_bool(column, first_row + i, Accessor::to_bool(ctx, v));
+                    }
+                    break;
+                case PropertyType::Int:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_int(column, first_row + i, Accessor::to_long(ctx, v));
+                    }
+                    break;
+                case PropertyType::Float:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_float(column, first_row + i, Accessor::to_float(ctx, v));
+                    }
+                    break;
+                case PropertyType::Double:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_double(column, first_row + i, Accessor::to_double(ctx, v));
+                    }
+                    break;
+                case PropertyType::String:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_string(column, first_row + i, Accessor::to_string(ctx, v));
+                    }
+                    break;
+                case PropertyType::Data:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_binary(column, first_row + i, BinaryData(Accessor::to_binary(ctx, v)));
+                    }
+                    break;
+                case PropertyType::Any:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        table->set_mixed(column, first_row + i, Accessor::to_mixed(ctx, v));
+                    }
+                    break;
+                case PropertyType::Date:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (!set_null_if_needed(i, v))
+                            table->set_timestamp(column, first_row + i, Accessor::to_timestamp(ctx, v));
+                    }
+                    break;
+                case PropertyType::Object:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (Accessor::is_null(ctx, v))
+                            table->nullify_link(column, first_row + i);
+                        else
+                            table->set_link(column, first_row + i, Accessor::to_object_index(ctx, realm, v, prop.object_type, try_update));
+                    }
+                    break;
+                case PropertyType::Array:
+                    for (size_t i = 0; i < count; i++) {
+                        ValueType v = cell(i);
+                        if (Accessor::is_null(ctx, v))
+                            continue; // freshly added rows have empty lists
+                        realm::LinkViewRef link_view = table->get_linklist(column, first_row + i);
+                        size_t list_count = Accessor::list_size(ctx, v);
+                        for (size_t j = 0; j < list_count; j++) {
+                            ValueType element = Accessor::list_value_at_index(ctx, v, j);
+                            link_view->add(Accessor::to_object_index(ctx, realm, element, prop.object_type, try_update));
+                        }
+                    }
+                    break;
+                case PropertyType::LinkingObjects:
+                    throw ReadOnlyPropertyException(object_schema.name, prop.name,
+                                                    util::format("Cannot modify read-only property '%1.%2'",
+                                                                 object_schema.name, prop.name));
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            objects.push_back(Object(realm, object_schema, table->get(first_row + i)));
+        }
+        return objects;
     }
 
     template<typename ValueType, typename ContextType>
@@ -389,7 +720,7 @@ namespace realm {
             throw MissingPrimaryKeyException(object_schema.name, object_schema.name + " does not have a primary key");
         }
 
-        auto table = ObjectStore::table_for_object_type(realm->read_group(), object_schema.name);
+        auto table = ObjectStore::table_for_object_type(realm->read_group(), object_schema);
         auto row_index = get_for_primary_key_impl(ctx, table, *primary_prop, primary_value);
 
         return Object(realm, object_schema, row_index == realm::not_found ? Row() : table->get(row_index));
@@ -408,6 +739,36 @@ namespace realm {
         }
     }
 
+    inline StringData Object::get_string_view(std::string const& prop_name)
+    {
+        verify_attached();
+        const Property *prop = m_object_schema->property_for_name(prop_name);
+        if (!prop) {
+            throw InvalidPropertyException(m_object_schema->name, prop_name,
+                "Getting invalid property '" + prop_name + "' on object '" + m_object_schema->name + "'.");
+        }
+        if (prop->type != PropertyType::String) {
+            throw InvalidPropertyException(m_object_schema->name, prop_name,
+                "Property '" + prop_name + "' on object '" + m_object_schema->name + "' is not a string property.");
+        }
+        return m_row.get_string(prop->table_column);
+    }
+
+    inline BinaryData Object::get_binary_view(std::string const& prop_name)
+    {
+        verify_attached();
+        const Property *prop = m_object_schema->property_for_name(prop_name);
+        if (!prop) {
+            throw InvalidPropertyException(m_object_schema->name, prop_name,
+                "Getting invalid property '" + prop_name + "' on object '" + m_object_schema->name + "'.");
+        }
+        if (prop->type != PropertyType::Data) {
+            throw InvalidPropertyException(m_object_schema->name, prop_name,
+                "Property '" + prop_name + "' on object '" + m_object_schema->name + "' is not a binary property.");
+        }
+        return m_row.get_binary(prop->table_column);
+    }
+
     inline void Object::verify_attached() {
         if (!m_row.is_attached()) {
             throw InvalidatedObjectException(m_object_schema->name,
@@ -58,7 +58,15 @@ ObjectSchema::ObjectSchema(std::string name, std::initializer_list<Property> per
     }
 }
 
-ObjectSchema::ObjectSchema(Group const& group, StringData name, size_t index) : name(name) {
+ObjectSchema::ObjectSchema(Group const& group, StringData name, size_t index)
+: ObjectSchema(group, name, index, ObjectStore::get_primary_key_for_object(group, name))
+{
+}
+
+ObjectSchema::ObjectSchema(Group const& group, StringData name, size_t index, StringData primary_key)
+: name(name)
+, primary_key(primary_key)
+{
     ConstTableRef table;
     if (index < group.size()) {
         table = group.get_table(index);
@@ -84,22 +92,50 @@ ObjectSchema::ObjectSchema(Group const& group, StringData name, size_t index) :
         persisted_properties.push_back(std::move(property));
     }
 
-    primary_key = realm::ObjectStore::get_primary_key_for_object(group, name);
+    table_index = table->get_index_in_group();
+
     set_primary_key_property();
 }
 
+void ObjectSchema::rebuild_property_index() {
+    m_property_index.clear();
+    m_property_index.reserve(persisted_properties.size() + computed_properties.size());
+    for (size_t i = 0; i < persisted_properties.size(); ++i) {
+        m_property_index.emplace(persisted_properties[i].name, i);
+    }
+    for (size_t i = 0; i < computed_properties.size(); ++i) {
+        m_property_index.emplace(computed_properties[i].name, persisted_properties.size() + i);
+    }
+}
+
+Property *ObjectSchema::property_at(size_t index) {
+    if (index < persisted_properties.size()) {
+        return &persisted_properties[index];
+    }
+    return &computed_properties[index - persisted_properties.size()];
+}
+
 Property *ObjectSchema::property_for_name(StringData name) {
-    for (auto& prop : persisted_properties) {
-        if (StringData(prop.name) == name) {
-            return &prop;
-        }
+    if (m_property_index.size() != persisted_properties.size() + computed_properties.size()) {
+        rebuild_property_index();
+    }
+
+    auto it = m_property_index.find(std::string(name));
+    if (it == m_property_index.end()) {
+        return nullptr;
     }
-    for (auto& prop : computed_properties) {
-        if (StringData(prop.name) == name) {
-            return &prop;
+
+    auto prop = property_at(it->second);
+    if (StringData(prop->name) != name) {
+        // A property was renamed in place, making the index entry stale
+        rebuild_property_index();
+        it = m_property_index.find(std::string(name));
+        if (it == m_property_index.end()) {
+            return nullptr;
         }
+        prop = property_at(it->second);
     }
-    return nullptr;
+    return prop;
 }
 
 const Property *ObjectSchema::property_for_name(StringData name) const {
@@ -22,6 +22,7 @@
 #include <realm/string_data.hpp>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace realm {
@@ -40,11 +41,22 @@ public:
     // if no table is provided it is looked up in the group
     ObjectSchema(Group const& group, StringData name, size_t index=-1);
 
+    // as above, with the primary key supplied by the caller rather than
+    // searched for in the pk metadata table, for callers which have already
+    // read that table
+    ObjectSchema(Group const& group, StringData name, size_t index, StringData primary_key);
+
     std::string name;
     std::vector<Property> persisted_properties;
     std::vector<Property> computed_properties;
     std::string primary_key;
 
+    // Index of this class's table in the Group, cached when the schema is
+    // read from or applied to a Group so that resolving the table can be an
+    // array index rather than a name lookup. ObjectStore verifies it against
+    // the table's actual name before use, so a stale value is safe.
+    size_t table_index = size_t(-1);
+
     Property *property_for_name(StringData name);
     const Property *property_for_name(StringData name) const;
     Property *primary_key_property() {
@@ -59,6 +71,19 @@ public:
     friend bool operator==(ObjectSchema const& a, ObjectSchema const& b);
 
 private:
+    // Index over the property vectors which makes property_for_name() a hash
+    // lookup rather than a linear scan with string compares. Keyed by a copy
+    // of each property's name, with values >= persisted_properties.size()
+    // referring to positions in computed_properties. It's built lazily on
+    // first lookup; adding or removing properties via the public vectors is
+    // detected by the size check in property_for_name() and triggers a
+    // rebuild, and a stale hit (a property renamed in place) rebuilds and
+    // retries, so direct mutation stays safe.
+    std::unordered_map<std::string, size_t> m_property_index;
+
+    void rebuild_property_index();
+    Property* property_at(size_t index);
+
     void set_primary_key_property();
 };
 }
@@ -28,7 +28,9 @@
 #include <realm/table_view.hpp>
 #include <realm/util/assert.hpp>
 
+#include <algorithm>
 #include <string.h>
+#include <unordered_map>
 
 using namespace realm;
 
@@ -75,7 +77,7 @@ void set_schema_version(Group& group, uint64_t version) {
 template<typename Group>
 auto table_for_object_schema(Group& group, ObjectSchema const& object_schema)
 {
-    return ObjectStore::table_for_object_type(group, object_schema.name);
+    return ObjectStore::table_for_object_type(group, object_schema);
 }
 
 void add_index(Table& table, size_t col)
@@ -256,14 +258,54 @@ std::string ObjectStore::table_name_for_object_type(StringData object_type) {
     return std::string(c_object_table_prefix) + std::string(object_type);
 }
 
+StringData ObjectStore::table_name_for_object_type(StringData object_type, TableNameBuffer& buffer) {
+    constexpr size_t prefix_size = sizeof(c_object_table_prefix) - 1;
+    if (prefix_size + object_type.size() > buffer.size()) {
+        return StringData();
+    }
+    char* p = std::copy_n(c_object_table_prefix, prefix_size, buffer.data());
+    p = std::copy_n(object_type.data(), object_type.size(), p);
+    return StringData(buffer.data(), p - buffer.data());
+}
+
 TableRef ObjectStore::table_for_object_type(Group& group, StringData object_type) {
-    auto name = table_name_for_object_type(object_type);
-    return group.get_table(name);
+    TableNameBuffer buffer;
+    auto name = table_name_for_object_type(object_type, buffer);
+    if (!name.is_null()) {
+        return group.get_table(name);
+    }
+    return group.get_table(table_name_for_object_type(object_type));
 }
 
 ConstTableRef ObjectStore::table_for_object_type(Group const& group, StringData object_type) {
-    auto name = table_name_for_object_type(object_type);
-    return group.get_table(name);
+    TableNameBuffer buffer;
+    auto name = table_name_for_object_type(object_type, buffer);
+    if (!name.is_null()) {
+        return group.get_table(name);
+    }
+    return group.get_table(table_name_for_object_type(object_type));
+}
+
+TableRef ObjectStore::table_for_object_type(Group& group, ObjectSchema const& object_schema) {
+    if (object_schema.table_index < group.size()) {
+        TableRef table = group.get_table(object_schema.table_index);
+        TableNameBuffer buffer;
+        if (table->get_name() == table_name_for_object_type(object_schema.name, buffer)) {
+            return table;
+        }
+    }
+    return table_for_object_type(group, object_schema.name);
+}
+
+ConstTableRef ObjectStore::table_for_object_type(Group const& group, ObjectSchema const& object_schema) {
+    if (object_schema.table_index < group.size()) {
+        ConstTableRef table = group.get_table(object_schema.table_index);
+        TableNameBuffer buffer;
+        if (table->get_name() == table_name_for_object_type(object_schema.name, buffer)) {
+            return table;
+        }
+    }
+    return table_for_object_type(group, object_schema.name);
 }
 
 namespace {
@@ -656,17 +698,37 @@ void ObjectStore::apply_schema_changes(Group& group, Schema& schema, uint64_t& s
 }
 
 Schema ObjectStore::schema_from_group(Group const& group) {
+    // Load the pk metadata table into a map up front rather than searching
+    // it again for every class
+    std::unordered_map<std::string, std::string> primary_keys;
+    if (auto pk_table = group.get_table(c_primaryKeyTableName)) {
+        for (size_t i = 0, count = pk_table->size(); i < count; ++i) {
+            primary_keys.emplace(std::string(pk_table->get_string(c_primaryKeyObjectClassColumnIndex, i)),
+                                 std::string(pk_table->get_string(c_primaryKeyPropertyNameColumnIndex, i)));
+        }
+    }
+
     std::vector<ObjectSchema> schema;
     schema.reserve(group.size());
     for (size_t i = 0; i < group.size(); i++) {
         auto object_type = object_type_for_table_name(group.get_table_name(i));
         if (object_type.size()) {
-            schema.emplace_back(group, object_type, i);
+            auto it = primary_keys.find(std::string(object_type));
+            schema.emplace_back(group, object_type, i,
+                                it == primary_keys.end() ? StringData("") : StringData(it->second));
         }
     }
     return schema;
 }
 
+util::Optional<ObjectSchema> ObjectStore::object_schema_from_group(Group const& group, StringData object_type) {
+    auto table = table_for_object_type(group, object_type);
+    if (!table) {
+        return util::none;
+    }
+    return ObjectSchema(group, object_type, table->get_index_in_group());
+}
+
 void ObjectStore::set_schema_columns(Group const& group, Schema& schema)
 {
     for (auto& object_schema : schema) {
@@ -674,6 +736,7 @@ void ObjectStore::set_schema_columns(Group const& group, Schema& schema)
         if (!table) {
             continue;
         }
+        object_schema.table_index = table->get_index_in_group();
         for (auto& property : object_schema.persisted_properties) {
             property.table_column = table->get_column_index(property.name);
         }
@@ -22,13 +22,16 @@
 #include "property.hpp"
 
 #include <realm/table_ref.hpp>
+#include <realm/util/optional.hpp>
 
+#include <array>
 #include <functional>
 #include <string>
 #include <vector>
 
 namespace realm {
 class Group;
+class ObjectSchema;
 class Schema;
 class SchemaChange;
 class StringData;
@@ -74,9 +77,21 @@ public:
     static realm::TableRef table_for_object_type(Group& group, StringData object_type);
     static realm::ConstTableRef table_for_object_type(Group const& group, StringData object_type);
 
+    // get a table for an object schema, using the table index cached on the
+    // schema to make the lookup an array index when possible. The cached
+    // index is verified against the table's name, so a stale index falls
+    // back to the name lookup rather than returning the wrong table.
+    static realm::TableRef table_for_object_type(Group& group, ObjectSchema const& object_schema);
+    static realm::ConstTableRef table_for_object_type(Group const& group, ObjectSchema const& object_schema);
+
     // get existing Schema from a group
     static Schema schema_from_group(Group const& group);
 
+    // get the schema for a single object type from a group without reading
+    // any of the other classes the group contains. Returns none if the
+    // group has no table for the type.
+    static util::Optional<ObjectSchema> object_schema_from_group(Group const& group, StringData object_type);
+
     static void set_schema_columns(Group const& group, Schema& schema);
 
     // deletes the table for the given type
@@ -98,6 +113,15 @@ public:
     static std::string table_name_for_object_type(StringData class_name);
     static StringData object_type_for_table_name(StringData table_name);
 
+    // Stack buffer used to construct class table names without allocating.
+    // Large enough for the table prefix plus any reasonable class name;
+    // longer names fall back to the allocating overload above.
+    using TableNameBuffer = std::array<char, 96>;
+
+    // get the table name for an object type, backed by `buffer`. Returns a
+    // null StringData if the name does not fit in the buffer.
+    static StringData table_name_for_object_type(StringData class_name, TableNameBuffer& buffer);
+
 private:
     friend class ObjectSchema;
 };
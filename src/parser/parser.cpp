@@ -18,7 +18,13 @@
 
 #include "parser.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 
 #include <pegtl.hh>
 #include <pegtl/analyze.hh>
@@ -32,6 +38,20 @@ using namespace pegtl;
 namespace realm {
 namespace parser {
 
+void *Arena::allocate(size_t size, size_t align)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_used = (m_used + align - 1) & ~(align - 1);
+    if (m_blocks.empty() || m_used + size > m_capacity) {
+        m_capacity = std::max(size_t(block_size), size);
+        m_blocks.emplace_back(new char[m_capacity]);
+        m_used = 0;
+    }
+    void *ptr = m_blocks.back().get() + m_used;
+    m_used += size;
+    return ptr;
+}
+
 // strings
 struct unicode : list< seq< one< 'u' >, rep< 4, must< xdigit > > >, one< '\\' > > {};
 struct escaped_char : one< '"', '\'', '\\', '/', 'b', 'f', 'n', 'r', 't', '0' > {};
@@ -109,6 +129,7 @@ struct pred : seq< and_pred, star< or_ext > > {};
 struct ParserState
 {
     std::vector<Predicate *> group_stack;
+    ArenaAllocator<Predicate> allocator;
 
     Predicate *current_group()
     {
@@ -126,7 +147,7 @@ struct ParserState
 
     void add_predicate_to_current_group(Predicate::Type type)
     {
-        current_group()->cpnd.sub_predicates.emplace_back(type, negate_next);
+        current_group()->cpnd.sub_predicates.emplace_back(type, negate_next, allocator);
         negate_next = false;
 
         if (current_group()->cpnd.sub_predicates.size() > 1) {
@@ -164,12 +185,17 @@ struct ParserState
         // convert to OR
         group->type = Predicate::Type::Or;
         if (group->cpnd.sub_predicates.size() > 2) {
-            // split the current group into an AND group ORed with the last subpredicate
-            Predicate new_sub(Predicate::Type::And);
+            // split the current group into an AND group ORed with the last subpredicate.
+            // Moves rather than copies throughout, as copying a predicate
+            // would move the subtree off the parse arena and onto the heap
+            Predicate new_sub(Predicate::Type::And, false, allocator);
             new_sub.cpnd.sub_predicates = std::move(group->cpnd.sub_predicates);
+            Predicate last = std::move(new_sub.cpnd.sub_predicates.back());
+            new_sub.cpnd.sub_predicates.pop_back();
 
-            group->cpnd.sub_predicates = { new_sub, std::move(new_sub.cpnd.sub_predicates.back()) };
-            group->cpnd.sub_predicates[0].cpnd.sub_predicates.pop_back();
+            group->cpnd.sub_predicates.clear();
+            group->cpnd.sub_predicates.emplace_back(std::move(new_sub));
+            group->cpnd.sub_predicates.emplace_back(std::move(last));
         }
     }
 
@@ -188,8 +214,10 @@ struct ParserState
         }
         else {
             // otherwise combine last two into a new AND group
-            Predicate pred(Predicate::Type::And);
-            pred.cpnd.sub_predicates.insert(pred.cpnd.sub_predicates.begin(), second_last, sub_preds.end());
+            Predicate pred(Predicate::Type::And, false, allocator);
+            pred.cpnd.sub_predicates.insert(pred.cpnd.sub_predicates.begin(),
+                                            std::make_move_iterator(second_last),
+                                            std::make_move_iterator(sub_preds.end()));
             sub_preds.erase(second_last, sub_preds.end());
             sub_preds.emplace_back(std::move(pred));
         }
@@ -245,7 +273,7 @@ template<> struct action< true_pred >
     static void apply(const input& in, ParserState & state)
     {
         DEBUG_PRINT_TOKEN(in.string());
-        state.current_group()->cpnd.sub_predicates.emplace_back(Predicate::Type::True);
+        state.current_group()->cpnd.sub_predicates.emplace_back(Predicate::Type::True, false, state.allocator);
     }
 };
 
@@ -254,7 +282,7 @@ template<> struct action< false_pred >
     static void apply(const input& in, ParserState & state)
     {
         DEBUG_PRINT_TOKEN(in.string());
-        state.current_group()->cpnd.sub_predicates.emplace_back(Predicate::Type::False);
+        state.current_group()->cpnd.sub_predicates.emplace_back(Predicate::Type::False, false, state.allocator);
     }
 };
 
@@ -329,13 +357,16 @@ const std::string error_message_control< chars >::error_message = "Invalid chara
 template< typename Rule>
 const std::string error_message_control< Rule >::error_message = "Invalid predicate.";
 
-Predicate parse(const std::string &query)
+namespace {
+Predicate parse_uncached(const std::string &query)
 {
     DEBUG_PRINT_TOKEN(query);
 
-    Predicate out_predicate(Predicate::Type::And);
+    ArenaAllocator<Predicate> allocator(std::make_shared<Arena>());
+    Predicate out_predicate(Predicate::Type::And, false, allocator);
 
     ParserState state;
+    state.allocator = allocator;
     state.group_stack.push_back(&out_predicate);
 
     pegtl::parse< must< pred, eof >, action, error_message_control >(query, query, state);
@@ -345,6 +376,45 @@ Predicate parse(const std::string &query)
     return out_predicate;
 }
 
+// Bindings tend to issue the same small set of query strings over and over, so
+// parses are memoized in a LRU cache keyed by the raw query string. Only
+// successful parses are cached; a parse error is rethrown on every call.
+class PredicateCache {
+public:
+    Predicate parse(const std::string &query)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(query);
+        if (it != m_index.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return m_entries.front().second;
+        }
+
+        Predicate predicate = parse_uncached(query);
+        m_entries.emplace_front(query, predicate);
+        m_index[query] = m_entries.begin();
+        if (m_entries.size() > max_entries) {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+        return predicate;
+    }
+
+private:
+    static const size_t max_entries = 256;
+
+    std::mutex m_mutex;
+    std::list<std::pair<std::string, Predicate>> m_entries;
+    std::unordered_map<std::string, std::list<std::pair<std::string, Predicate>>::iterator> m_index;
+};
+} // anonymous namespace
+
+Predicate parse(const std::string &query)
+{
+    static PredicateCache cache;
+    return cache.parse(query);
+}
+
 void analyze_grammar()
 {
     analyze<pred>();
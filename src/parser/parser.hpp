@@ -19,6 +19,8 @@
 #ifndef REALM_PARSER_HPP
 #define REALM_PARSER_HPP
 
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -33,6 +35,82 @@ struct Expression
     Expression(Type t = Type::None, std::string s = "") : type(t), s(s) {}
 };
 
+// A bump allocator which hands out memory from a chain of fixed-size blocks
+// and frees everything at once when destroyed. The predicate tree built by
+// parse() places its sub-predicate vectors in one of these so that a nested
+// query is a handful of block allocations rather than one heap allocation
+// per compound node, and so that walking the tree touches contiguous memory.
+class Arena {
+public:
+    void *allocate(size_t size, size_t align);
+
+private:
+    static const size_t block_size = 4096;
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    size_t m_used = 0;
+    size_t m_capacity = 0;
+};
+
+// A std::allocator-compatible wrapper over a shared Arena. A
+// default-constructed instance has no arena and falls back to the heap, so
+// Predicate remains default-constructible and copyable as a plain value type.
+// Copying an arena-backed predicate produces a heap-backed copy; the arena
+// only ever holds the nodes built while parsing.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() = default;
+    ArenaAllocator(std::shared_ptr<Arena> arena) : m_arena(std::move(arena)) { }
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : m_arena(other.arena()) { }
+
+    T *allocate(size_t count)
+    {
+        if (m_arena)
+            return static_cast<T *>(m_arena->allocate(count * sizeof(T), alignof(T)));
+        return static_cast<T *>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t)
+    {
+        // arena memory is released only when the arena itself is destroyed
+        if (!m_arena)
+            ::operator delete(ptr);
+    }
+
+    // Containers copy-construct with a default (heap-backed) allocator
+    // rather than inheriting the arena. Copies get made long after parsing
+    // is done — most notably when the predicate cache hands out a cached
+    // tree — and since deallocate() can never return arena memory, every
+    // such copy would otherwise permanently grow an arena for the lifetime
+    // of its cache entry.
+    ArenaAllocator select_on_container_copy_construction() const
+    {
+        return ArenaAllocator();
+    }
+
+    std::shared_ptr<Arena> const& arena() const { return m_arena; }
+
+private:
+    std::shared_ptr<Arena> m_arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return !(a == b);
+}
+
 struct Predicate
 {
     enum class Type
@@ -73,7 +151,8 @@ struct Predicate
 
     struct Compound
     {
-        std::vector<Predicate> sub_predicates;
+        std::vector<Predicate, ArenaAllocator<Predicate>> sub_predicates;
+        Compound(ArenaAllocator<Predicate> alloc = {}) : sub_predicates(alloc) {}
     };
 
     Comparison cmpr;
@@ -81,7 +160,8 @@ struct Predicate
 
     bool negate = false;
 
-    Predicate(Type t, bool n = false) : type(t), negate(n) {}
+    Predicate(Type t, bool n = false, ArenaAllocator<Predicate> alloc = {})
+    : type(t), cpnd(alloc), negate(n) {}
 };
 
 Predicate parse(const std::string &query);
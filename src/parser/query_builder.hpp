@@ -21,15 +21,30 @@
 
 #include "parser.hpp"
 #include "object_accessor.hpp"
+#include "object_store.hpp"
+#include "schema.hpp"
+#include "util/compiler.hpp"
+#include "util/format.hpp"
 
-namespace realm {
-class Query;
-class Schema;
+#include <realm.hpp>
+#include <functional>
+#include <sstream>
+
+// check a precondition and throw an exception if it is not met
+// this should be used iff the condition being false indicates a bug in the caller
+// of the function checking its preconditions
+#define realm_precondition(condition, message) if (!__builtin_expect(condition, 1)) {  throw std::logic_error(message); }
 
+namespace realm {
 namespace query_builder {
 class Arguments;
 
-void apply_predicate(Query &query, const parser::Predicate &predicate, Arguments &arguments,
+// Build the query for a predicate. The query-building machinery is templated
+// on the concrete arguments type: passing an `Arguments&` gives the dynamic
+// path, while bindings which pass their `ArgumentConverter` directly get a
+// fully devirtualized instantiation with the conversions inlined.
+template<typename ArgumentsType>
+void apply_predicate(Query &query, const parser::Predicate &predicate, ArgumentsType &arguments,
                      const Schema &schema, const std::string &objectType);
 
 class Arguments {
@@ -46,21 +61,21 @@ class Arguments {
 };
 
 template<typename ValueType, typename ContextType>
-class ArgumentConverter : public Arguments {
+class ArgumentConverter final : public Arguments {
   public:
     ArgumentConverter(ContextType context, SharedRealm realm, std::vector<ValueType> arguments)
         : m_arguments(arguments), m_ctx(context), m_realm(std::move(realm)) {}
 
     using Accessor = realm::NativeAccessor<ValueType, ContextType>;
-    virtual bool bool_for_argument(size_t argument_index) { return Accessor::to_bool(m_ctx, argument_at(argument_index)); }
-    virtual long long long_for_argument(size_t argument_index) { return Accessor::to_long(m_ctx, argument_at(argument_index)); }
-    virtual float float_for_argument(size_t argument_index) { return Accessor::to_float(m_ctx, argument_at(argument_index)); }
-    virtual double double_for_argument(size_t argument_index) { return Accessor::to_double(m_ctx, argument_at(argument_index)); }
-    virtual std::string string_for_argument(size_t argument_index) { return Accessor::to_string(m_ctx, argument_at(argument_index)); }
-    virtual std::string binary_for_argument(size_t argument_index) { return Accessor::to_binary(m_ctx, argument_at(argument_index)); }
-    virtual Timestamp timestamp_for_argument(size_t argument_index) { return Accessor::to_timestamp(m_ctx, argument_at(argument_index)); }
-    virtual size_t object_index_for_argument(size_t argument_index) { return Accessor::to_existing_object_index(m_ctx, m_realm, argument_at(argument_index)); }
-    virtual bool is_argument_null(size_t argument_index) { return Accessor::is_null(m_ctx, argument_at(argument_index)); }
+    bool bool_for_argument(size_t argument_index) override { return Accessor::to_bool(m_ctx, argument_at(argument_index)); }
+    long long long_for_argument(size_t argument_index) override { return Accessor::to_long(m_ctx, argument_at(argument_index)); }
+    float float_for_argument(size_t argument_index) override { return Accessor::to_float(m_ctx, argument_at(argument_index)); }
+    double double_for_argument(size_t argument_index) override { return Accessor::to_double(m_ctx, argument_at(argument_index)); }
+    std::string string_for_argument(size_t argument_index) override { return Accessor::to_string(m_ctx, argument_at(argument_index)); }
+    std::string binary_for_argument(size_t argument_index) override { return Accessor::to_binary(m_ctx, argument_at(argument_index)); }
+    Timestamp timestamp_for_argument(size_t argument_index) override { return Accessor::to_timestamp(m_ctx, argument_at(argument_index)); }
+    size_t object_index_for_argument(size_t argument_index) override { return Accessor::to_existing_object_index(m_ctx, m_realm, argument_at(argument_index)); }
+    bool is_argument_null(size_t argument_index) override { return Accessor::is_null(m_ctx, argument_at(argument_index)); }
 
   private:
     std::vector<ValueType> m_arguments;
@@ -71,6 +86,708 @@ class ArgumentConverter : public Arguments {
         return m_arguments.at(index);
     }
 };
+
+namespace _impl {
+template<typename T>
+T stot(std::string const& s) {
+    std::istringstream iss(s);
+    T value;
+    iss >> value;
+    if (iss.fail()) {
+        throw std::invalid_argument(util::format("Cannot convert string '%1'", s));
+    }
+    return value;
+}
+
+// FIXME: TrueExpression and FalseExpression should be supported by core in some way
+struct TrueExpression : realm::Expression {
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (start != end)
+            return start;
+
+        return realm::not_found;
+    }
+    void set_base_table(const Table*) override {}
+    const Table* get_base_table() const override { return nullptr; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new TrueExpression(*this));
+    }
+};
+
+struct FalseExpression : realm::Expression {
+    size_t find_first(size_t, size_t) const override { return realm::not_found; }
+    void set_base_table(const Table*) override {}
+    const Table* get_base_table() const override { return nullptr; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new FalseExpression(*this));
+    }
+};
+
+using KeyPath = std::vector<std::string>;
+inline KeyPath key_path_from_string(const std::string &s) {
+    std::stringstream ss(s);
+    std::string item;
+    KeyPath key_path;
+    while (std::getline(ss, item, '.')) {
+        key_path.push_back(item);
+    }
+    return key_path;
+}
+
+// resolve a key path to the property it terminates in and the chain of link
+// columns leading to it
+inline const Property *resolve_key_path(const Schema &schema, Schema::const_iterator desc,
+                                        const std::string &key_path_string, std::vector<size_t> &indexes)
+{
+    const Property *prop = nullptr;
+    KeyPath key_path = key_path_from_string(key_path_string);
+    for (size_t index = 0; index < key_path.size(); index++) {
+        if (prop) {
+            realm_precondition(prop->type == PropertyType::Object || prop->type == PropertyType::Array,
+                               util::format("Property '%1' is not a link in object of type '%2'", key_path[index], desc->name));
+            indexes.push_back(prop->table_column);
+
+        }
+        prop = desc->property_for_name(key_path[index]);
+        realm_precondition(prop != nullptr,
+                           util::format("No property '%1' on object of type '%2'", key_path[index], desc->name));
+
+        if (prop->object_type.size()) {
+            desc = schema.find(prop->object_type);
+        }
+    }
+    return prop;
+}
+
+struct PropertyExpression
+{
+    const Property *prop = nullptr;
+    std::vector<size_t> indexes;
+    std::function<Table *()> table_getter;
+
+    PropertyExpression(Query &query, const Schema &schema, Schema::const_iterator desc, const std::string &key_path_string)
+    {
+        prop = resolve_key_path(schema, desc, key_path_string, indexes);
+        bind_table_getter(query);
+    }
+
+    // construct from an already-resolved key path
+    PropertyExpression(Query &query, const Property *resolved_prop, std::vector<size_t> resolved_indexes)
+    : prop(resolved_prop), indexes(std::move(resolved_indexes))
+    {
+        bind_table_getter(query);
+    }
+
+private:
+    void bind_table_getter(Query &query)
+    {
+        table_getter = [&] {
+            auto& tbl = query.get_table();
+            for (size_t col : indexes) {
+                tbl->link(col); // mutates m_link_chain on table
+            }
+            return tbl.get();
+        };
+    }
+};
+
+
+// add a clause for numeric constraints based on operator type
+template <typename A, typename B>
+void add_numeric_constraint_to_query(Query& query,
+                                     parser::Predicate::Operator operatorType,
+                                     A lhs,
+                                     B rhs)
+{
+    switch (operatorType) {
+        case parser::Predicate::Operator::LessThan:
+            query.and_query(lhs < rhs);
+            break;
+        case parser::Predicate::Operator::LessThanOrEqual:
+            query.and_query(lhs <= rhs);
+            break;
+        case parser::Predicate::Operator::GreaterThan:
+            query.and_query(lhs > rhs);
+            break;
+        case parser::Predicate::Operator::GreaterThanOrEqual:
+            query.and_query(lhs >= rhs);
+            break;
+        case parser::Predicate::Operator::Equal:
+            query.and_query(lhs == rhs);
+            break;
+        case parser::Predicate::Operator::NotEqual:
+            query.and_query(lhs != rhs);
+            break;
+        default:
+            throw std::logic_error("Unsupported operator for numeric queries.");
+    }
+}
+
+template <typename A, typename B>
+void add_bool_constraint_to_query(Query &query, parser::Predicate::Operator operatorType, A lhs, B rhs) {
+    switch (operatorType) {
+        case parser::Predicate::Operator::Equal:
+            query.and_query(lhs == rhs);
+            break;
+        case parser::Predicate::Operator::NotEqual:
+            query.and_query(lhs != rhs);
+            break;
+        default:
+            throw std::logic_error("Unsupported operator for numeric queries.");
+    }
+}
+
+inline void add_string_constraint_to_query(Query &query,
+                                           parser::Predicate::Comparison cmp,
+                                           Columns<String> &&column,
+                                           std::string &&value) {
+    bool case_sensitive = (cmp.option != parser::Predicate::OperatorOption::CaseInsensitive);
+    switch (cmp.op) {
+        case parser::Predicate::Operator::BeginsWith:
+            query.and_query(column.begins_with(value, case_sensitive));
+            break;
+        case parser::Predicate::Operator::EndsWith:
+            query.and_query(column.ends_with(value, case_sensitive));
+            break;
+        case parser::Predicate::Operator::Contains:
+            query.and_query(column.contains(value, case_sensitive));
+            break;
+        case parser::Predicate::Operator::Equal:
+            query.and_query(column.equal(value, case_sensitive));
+            break;
+        case parser::Predicate::Operator::NotEqual:
+            query.and_query(column.not_equal(value, case_sensitive));
+            break;
+        default:
+            throw std::logic_error("Unsupported operator for string queries.");
+    }
+}
+
+inline void add_string_constraint_to_query(realm::Query &query,
+                                           parser::Predicate::Comparison cmp,
+                                           std::string &&value,
+                                           Columns<String> &&column) {
+    bool case_sensitive = (cmp.option != parser::Predicate::OperatorOption::CaseInsensitive);
+    switch (cmp.op) {
+        case parser::Predicate::Operator::Equal:
+            query.and_query(column.equal(value, case_sensitive));
+            break;
+        case parser::Predicate::Operator::NotEqual:
+            query.and_query(column.not_equal(value, case_sensitive));
+            break;
+        default:
+            throw std::logic_error("Substring comparison not supported for keypath substrings.");
+    }
+}
+
+inline void add_binary_constraint_to_query(Query &query,
+                                           parser::Predicate::Operator op,
+                                           Columns<Binary> &&column,
+                                           std::string &&value) {
+    switch (op) {
+        case parser::Predicate::Operator::BeginsWith:
+            query.begins_with(column.column_ndx(), BinaryData(value));
+            break;
+        case parser::Predicate::Operator::EndsWith:
+            query.ends_with(column.column_ndx(), BinaryData(value));
+            break;
+        case parser::Predicate::Operator::Contains:
+            query.contains(column.column_ndx(), BinaryData(value));
+            break;
+        case parser::Predicate::Operator::Equal:
+            query.equal(column.column_ndx(), BinaryData(value));
+            break;
+        case parser::Predicate::Operator::NotEqual:
+            query.not_equal(column.column_ndx(), BinaryData(value));
+            break;
+        default:
+            throw std::logic_error("Unsupported operator for binary queries.");
+    }
+}
+
+inline void add_binary_constraint_to_query(realm::Query &query,
+                                           parser::Predicate::Operator op,
+                                           std::string value,
+                                           Columns<Binary> &&column) {
+    switch (op) {
+        case parser::Predicate::Operator::Equal:
+            query.equal(column.column_ndx(), BinaryData(value));
+            break;
+        case parser::Predicate::Operator::NotEqual:
+            query.not_equal(column.column_ndx(), BinaryData(value));
+            break;
+        default:
+            throw std::logic_error("Substring comparison not supported for keypath substrings.");
+    }
+}
+
+inline void add_link_constraint_to_query(realm::Query &query,
+                                         parser::Predicate::Operator op,
+                                         const PropertyExpression &prop_expr,
+                                         size_t row_index) {
+    realm_precondition(prop_expr.indexes.empty(), "KeyPath queries not supported for object comparisons.");
+    switch (op) {
+        case parser::Predicate::Operator::NotEqual:
+            query.Not();
+            REALM_FALLTHROUGH;
+        case parser::Predicate::Operator::Equal: {
+            size_t col = prop_expr.prop->table_column;
+            query.links_to(col, query.get_table()->get_link_target(col)->get(row_index));
+            break;
+        }
+        default:
+            throw std::logic_error("Only 'equal' and 'not equal' operators supported for object comparison.");
+    }
+}
+
+template<typename ArgumentsType>
+auto link_argument(const PropertyExpression&, const parser::Expression &argExpr, ArgumentsType &args)
+{
+    return args.object_index_for_argument(stot<int>(argExpr.s));
+}
+
+template<typename ArgumentsType>
+auto link_argument(const parser::Expression &argExpr, const PropertyExpression&, ArgumentsType &args)
+{
+    return args.object_index_for_argument(stot<int>(argExpr.s));
+}
+
+
+template <typename RetType, typename TableGetter>
+struct ColumnGetter {
+    template<typename ArgumentsType>
+    static Columns<RetType> convert(TableGetter&& table, const PropertyExpression& expr, ArgumentsType&)
+    {
+        return table()->template column<RetType>(expr.prop->table_column);
+    }
+};
+
+template <typename RequestedType, typename TableGetter>
+struct ValueGetter;
+
+template <typename TableGetter>
+struct ValueGetter<Timestamp, TableGetter> {
+    template<typename ArgumentsType>
+    static Timestamp convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type != parser::Expression::Type::Argument) {
+            throw std::logic_error("You must pass in a date argument to compare");
+        }
+        return args.timestamp_for_argument(stot<int>(value.s));
+    }
+};
+
+template <typename TableGetter>
+struct ValueGetter<bool, TableGetter> {
+    template<typename ArgumentsType>
+    static bool convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type == parser::Expression::Type::Argument) {
+            return args.bool_for_argument(stot<int>(value.s));
+        }
+        if (value.type != parser::Expression::Type::True && value.type != parser::Expression::Type::False) {
+            throw std::logic_error("Attempting to compare bool property to a non-bool value");
+        }
+        return value.type == parser::Expression::Type::True;
+    }
+};
+
+template <typename TableGetter>
+struct ValueGetter<Double, TableGetter> {
+    template<typename ArgumentsType>
+    static Double convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type == parser::Expression::Type::Argument) {
+            return args.double_for_argument(stot<int>(value.s));
+        }
+        return stot<double>(value.s);
+    }
+};
+
+template <typename TableGetter>
+struct ValueGetter<Float, TableGetter> {
+    template<typename ArgumentsType>
+    static Float convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type == parser::Expression::Type::Argument) {
+            return args.float_for_argument(stot<int>(value.s));
+        }
+        return stot<float>(value.s);
+    }
+};
+
+template <typename TableGetter>
+struct ValueGetter<Int, TableGetter> {
+    template<typename ArgumentsType>
+    static Int convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type == parser::Expression::Type::Argument) {
+            return args.long_for_argument(stot<int>(value.s));
+        }
+        return stot<long long>(value.s);
+    }
+};
+
+template <typename TableGetter>
+struct ValueGetter<String, TableGetter> {
+    template<typename ArgumentsType>
+    static std::string convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type == parser::Expression::Type::Argument) {
+            return args.string_for_argument(stot<int>(value.s));
+        }
+        if (value.type != parser::Expression::Type::String) {
+            throw std::logic_error("Attempting to compare String property to a non-String value");
+        }
+        return value.s;
+    }
+};
+
+template <typename TableGetter>
+struct ValueGetter<Binary, TableGetter> {
+    template<typename ArgumentsType>
+    static std::string convert(TableGetter&&, const parser::Expression & value, ArgumentsType &args)
+    {
+        if (value.type == parser::Expression::Type::Argument) {
+            return args.binary_for_argument(stot<int>(value.s));
+        }
+        throw std::logic_error("Binary properties must be compared against a binary argument.");
+    }
+};
+
+template <typename RetType, typename Value, typename TableGetter, typename ArgumentsType>
+auto value_of_type_for_query(TableGetter&& tables, Value&& value, ArgumentsType &args)
+{
+    const bool isColumn = std::is_same<PropertyExpression, typename std::remove_reference<Value>::type>::value;
+    using helper = std::conditional_t<isColumn, ColumnGetter<RetType, TableGetter>, ValueGetter<RetType, TableGetter>>;
+    return helper::convert(tables, value, args);
+}
+
+template <typename A, typename B, typename ArgumentsType>
+void do_add_comparison_to_query(Query &query, parser::Predicate::Comparison cmp,
+                                const PropertyExpression &expr, A &lhs, B &rhs, ArgumentsType &args)
+{
+    auto type = expr.prop->type;
+    switch (type) {
+        case PropertyType::Bool:
+            add_bool_constraint_to_query(query, cmp.op, value_of_type_for_query<bool>(expr.table_getter, lhs, args),
+                                                        value_of_type_for_query<bool>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::Date:
+            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Timestamp>(expr.table_getter, lhs, args),
+                                                           value_of_type_for_query<Timestamp>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::Double:
+            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Double>(expr.table_getter, lhs, args),
+                                                           value_of_type_for_query<Double>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::Float:
+            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Float>(expr.table_getter, lhs, args),
+                                                           value_of_type_for_query<Float>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::Int:
+            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Int>(expr.table_getter, lhs, args),
+                                                           value_of_type_for_query<Int>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::String:
+            add_string_constraint_to_query(query, cmp, value_of_type_for_query<String>(expr.table_getter, lhs, args),
+                                                       value_of_type_for_query<String>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::Data:
+            add_binary_constraint_to_query(query, cmp.op, value_of_type_for_query<Binary>(expr.table_getter, lhs, args),
+                                                          value_of_type_for_query<Binary>(expr.table_getter, rhs, args));
+            break;
+        case PropertyType::Object:
+        case PropertyType::Array:
+            add_link_constraint_to_query(query, cmp.op, expr, link_argument(lhs, rhs, args));
+            break;
+        default:
+            throw std::logic_error(util::format("Object type '%1' not supported", string_for_property_type(type)));
+    }
+}
+
+template<typename T>
+void do_add_null_comparison_to_query(Query &query, parser::Predicate::Operator op, const PropertyExpression &expr)
+{
+    Columns<T> column = expr.table_getter()->template column<T>(expr.prop->table_column);
+    switch (op) {
+        case parser::Predicate::Operator::NotEqual:
+            query.and_query(column != realm::null());
+            break;
+        case parser::Predicate::Operator::Equal:
+            query.and_query(column == realm::null());
+            break;
+        default:
+            throw std::logic_error("Only 'equal' and 'not equal' operators supported when comparing against 'null'.");
+    }
+}
+
+template<>
+inline void do_add_null_comparison_to_query<Binary>(Query &query, parser::Predicate::Operator op, const PropertyExpression &expr)
+{
+    realm_precondition(expr.indexes.empty(), "KeyPath queries not supported for data comparisons.");
+    Columns<Binary> column = expr.table_getter()->template column<Binary>(expr.prop->table_column);
+    switch (op) {
+        case parser::Predicate::Operator::NotEqual:
+            query.not_equal(expr.prop->table_column, realm::null());
+            break;
+        case parser::Predicate::Operator::Equal:
+            query.equal(expr.prop->table_column, realm::null());
+            break;
+        default:
+            throw std::logic_error("Only 'equal' and 'not equal' operators supported when comparing against 'null'.");
+    }
+}
+
+template<>
+inline void do_add_null_comparison_to_query<Link>(Query &query, parser::Predicate::Operator op, const PropertyExpression &expr)
+{
+    realm_precondition(expr.indexes.empty(), "KeyPath queries not supported for object comparisons.");
+    switch (op) {
+        case parser::Predicate::Operator::NotEqual:
+            query.Not();
+            REALM_FALLTHROUGH;
+        case parser::Predicate::Operator::Equal:
+            query.and_query(query.get_table()->column<Link>(expr.prop->table_column).is_null());
+            break;
+        default:
+            throw std::logic_error("Only 'equal' and 'not equal' operators supported for object comparison.");
+    }
+}
+
+inline void do_add_null_comparison_to_query(Query &query, parser::Predicate::Comparison cmp, const PropertyExpression &expr)
+{
+    auto type = expr.prop->type;
+    switch (type) {
+        case realm::PropertyType::Bool:
+            do_add_null_comparison_to_query<bool>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Date:
+            do_add_null_comparison_to_query<Timestamp>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Double:
+            do_add_null_comparison_to_query<Double>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Float:
+            do_add_null_comparison_to_query<Float>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Int:
+            do_add_null_comparison_to_query<Int>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::String:
+            do_add_null_comparison_to_query<String>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Data:
+            do_add_null_comparison_to_query<Binary>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Object:
+            do_add_null_comparison_to_query<Link>(query, cmp.op, expr);
+            break;
+        case realm::PropertyType::Array:
+            throw std::logic_error("Comparing Lists to 'null' is not supported");
+        default:
+            throw std::logic_error(util::format("Object type '%1' not supported", string_for_property_type(type)));
+    }
+}
+
+template<typename ArgumentsType>
+bool expression_is_null(const parser::Expression &expr, ArgumentsType &args) {
+    if (expr.type == parser::Expression::Type::Null) {
+        return true;
+    }
+    else if (expr.type == parser::Expression::Type::Argument) {
+        return args.is_argument_null(stot<int>(expr.s));
+    }
+    return false;
+}
+
+template<typename ArgumentsType>
+void add_comparison_to_query(Query &query, const parser::Predicate &pred, ArgumentsType &args,
+                             const Schema &schema, const std::string &type)
+{
+    const parser::Predicate::Comparison &cmpr = pred.cmpr;
+    auto t0 = cmpr.expr[0].type, t1 = cmpr.expr[1].type;
+    auto object_schema = schema.find(type);
+    if (t0 == parser::Expression::Type::KeyPath && t1 != parser::Expression::Type::KeyPath) {
+        PropertyExpression expr(query, schema, object_schema, cmpr.expr[0].s);
+        if (expression_is_null(cmpr.expr[1], args)) {
+            do_add_null_comparison_to_query(query, cmpr, expr);
+        }
+        else {
+            do_add_comparison_to_query(query, cmpr, expr, expr, cmpr.expr[1], args);
+        }
+    }
+    else if (t0 != parser::Expression::Type::KeyPath && t1 == parser::Expression::Type::KeyPath) {
+        PropertyExpression expr(query, schema, object_schema, cmpr.expr[1].s);
+        if (expression_is_null(cmpr.expr[0], args)) {
+            do_add_null_comparison_to_query(query, cmpr, expr);
+        }
+        else {
+            do_add_comparison_to_query(query, cmpr, expr, cmpr.expr[0], expr, args);
+        }
+    }
+    else {
+        throw std::logic_error("Predicate expressions must compare a keypath and another keypath or a constant value");
+    }
+}
+
+template<typename ArgumentsType>
+void update_query_with_predicate(Query &query, const parser::Predicate &pred, ArgumentsType &arguments,
+                                 const Schema &schema, const std::string &type)
+{
+    if (pred.negate) {
+        query.Not();
+    }
+
+    switch (pred.type) {
+        case parser::Predicate::Type::And:
+            query.group();
+            for (auto &sub : pred.cpnd.sub_predicates) {
+                update_query_with_predicate(query, sub, arguments, schema, type);
+            }
+            if (!pred.cpnd.sub_predicates.size()) {
+                query.and_query(std::unique_ptr<realm::Expression>(new TrueExpression));
+            }
+            query.end_group();
+            break;
+
+        case parser::Predicate::Type::Or:
+            query.group();
+            for (auto &sub : pred.cpnd.sub_predicates) {
+                query.Or();
+                update_query_with_predicate(query, sub, arguments, schema, type);
+            }
+            if (!pred.cpnd.sub_predicates.size()) {
+                query.and_query(std::unique_ptr<realm::Expression>(new FalseExpression));
+            }
+            query.end_group();
+            break;
+
+        case parser::Predicate::Type::Comparison: {
+            add_comparison_to_query(query, pred, arguments, schema, type);
+            break;
+        }
+        case parser::Predicate::Type::True:
+            query.and_query(std::unique_ptr<realm::Expression>(new TrueExpression));
+            break;
+
+        case parser::Predicate::Type::False:
+            query.and_query(std::unique_ptr<realm::Expression>(new FalseExpression));
+            break;
+
+        default:
+            throw std::logic_error("Invalid predicate type");
+    }
+}
+} // namespace _impl
+
+template<typename ArgumentsType>
+void apply_predicate(Query &query, const parser::Predicate &predicate, ArgumentsType &arguments,
+                     const Schema &schema, const std::string &objectType)
+{
+    _impl::update_query_with_predicate(query, predicate, arguments, schema, objectType);
+
+    // Test the constructed query in core
+    std::string validateMessage = query.validate();
+    realm_precondition(validateMessage.empty(), validateMessage.c_str());
+}
+
+// A predicate compiled once against a schema. Construction resolves every
+// key path in the predicate to its property and link-column chain, so the
+// same parameterized query can be re-applied with fresh argument values
+// without re-parsing or re-resolving names in the schema.
+class PreparedQuery {
+public:
+    PreparedQuery(parser::Predicate predicate, const Schema &schema, std::string object_type);
+
+    // Add the compiled predicate to `query` using the supplied argument values
+    template<typename ArgumentsType>
+    void apply(Query &query, ArgumentsType &arguments) const
+    {
+        size_t next_comparison = 0;
+        apply(query, m_predicate, arguments, next_comparison);
+
+        // Test the constructed query in core
+        std::string validateMessage = query.validate();
+        realm_precondition(validateMessage.empty(), validateMessage.c_str());
+    }
+
+private:
+    struct CompiledComparison {
+        const Property *property;
+        std::vector<size_t> link_indexes;
+        bool key_path_on_left;
+    };
+
+    void compile(const parser::Predicate &predicate, const Schema &schema, const std::string &object_type);
+
+    template<typename ArgumentsType>
+    void apply(Query &query, const parser::Predicate &pred, ArgumentsType &arguments,
+               size_t &next_comparison) const
+    {
+        if (pred.negate) {
+            query.Not();
+        }
+
+        switch (pred.type) {
+            case parser::Predicate::Type::And:
+                query.group();
+                for (auto &sub : pred.cpnd.sub_predicates) {
+                    apply(query, sub, arguments, next_comparison);
+                }
+                if (!pred.cpnd.sub_predicates.size()) {
+                    query.and_query(std::unique_ptr<realm::Expression>(new _impl::TrueExpression));
+                }
+                query.end_group();
+                break;
+
+            case parser::Predicate::Type::Or:
+                query.group();
+                for (auto &sub : pred.cpnd.sub_predicates) {
+                    query.Or();
+                    apply(query, sub, arguments, next_comparison);
+                }
+                if (!pred.cpnd.sub_predicates.size()) {
+                    query.and_query(std::unique_ptr<realm::Expression>(new _impl::FalseExpression));
+                }
+                query.end_group();
+                break;
+
+            case parser::Predicate::Type::Comparison: {
+                const CompiledComparison &compiled = m_comparisons[next_comparison++];
+                _impl::PropertyExpression expr(query, compiled.property, compiled.link_indexes);
+                const parser::Expression &value = pred.cmpr.expr[compiled.key_path_on_left ? 1 : 0];
+                if (_impl::expression_is_null(value, arguments)) {
+                    _impl::do_add_null_comparison_to_query(query, pred.cmpr, expr);
+                }
+                else if (compiled.key_path_on_left) {
+                    _impl::do_add_comparison_to_query(query, pred.cmpr, expr, expr, value, arguments);
+                }
+                else {
+                    _impl::do_add_comparison_to_query(query, pred.cmpr, expr, value, expr, arguments);
+                }
+                break;
+            }
+
+            case parser::Predicate::Type::True:
+                query.and_query(std::unique_ptr<realm::Expression>(new _impl::TrueExpression));
+                break;
+
+            case parser::Predicate::Type::False:
+                query.and_query(std::unique_ptr<realm::Expression>(new _impl::FalseExpression));
+                break;
+
+            default:
+                throw std::logic_error("Invalid predicate type");
+        }
+    }
+
+    parser::Predicate m_predicate;
+    std::vector<CompiledComparison> m_comparisons;
+};
 }
 }
 
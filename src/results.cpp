@@ -26,12 +26,24 @@
 #include "util/compiler.hpp"
 #include "util/format.hpp"
 
+#include <realm/mixed.hpp>
+
+#include <mutex>
 #include <stdexcept>
+#include <type_traits>
 
 using namespace realm;
 
 Results::Results() = default;
-Results::~Results() = default;
+
+Results::~Results()
+{
+    // Detach from the notifier before m_notifier's destructor unregisters it,
+    // as a notifier shared with other Results must not be torn down and must
+    // not be left with a dangling target
+    if (m_notifier)
+        m_notifier->remove_target(*this);
+}
 
 Results::Results(SharedRealm r, Query q, SortDescriptor s)
 : m_realm(std::move(r))
@@ -64,15 +76,55 @@ Results::Results(SharedRealm r, LinkViewRef lv, util::Optional<Query> q, SortDes
 
 Results::Results(SharedRealm r, TableView tv, SortDescriptor s)
 : m_realm(std::move(r))
-, m_table_view(std::move(tv))
-, m_table(&m_table_view.get_parent())
+, m_table_view(std::make_shared<TableView>(std::move(tv)))
+, m_table(&m_table_view->get_parent())
 , m_sort(std::move(s))
 , m_mode(Mode::TableView)
 {
 }
 
-Results::Results(const Results&) = default;
-Results& Results::operator=(const Results&) = default;
+Results::Results(const Results& other)
+: m_realm(other.m_realm)
+, m_object_schema(other.m_object_schema)
+, m_query(other.m_query)
+, m_table_view(other.m_table_view)
+, m_link_view(other.m_link_view)
+, m_table(other.m_table)
+, m_sort(other.m_sort)
+, m_mode(other.m_mode)
+, m_update_policy(other.m_update_policy)
+, m_has_used_table_view(other.m_has_used_table_view)
+, m_wants_background_updates(other.m_wants_background_updates)
+, m_track_moves(other.m_track_moves)
+, m_cached_count(other.m_cached_count)
+, m_cached_count_version(other.m_cached_count_version)
+, m_cached_aggregates(other.m_cached_aggregates)
+, m_cached_aggregate_version(other.m_cached_aggregate_version)
+, m_offset(other.m_offset)
+, m_limit(other.m_limit)
+, m_table_view_is_windowed(other.m_table_view_is_windowed)
+{
+    // m_notifier is deliberately left disengaged: the copy is not a
+    // registered target of the source's notifier, so it must not share the
+    // handle (the handle's destructor would unregister a notifier which
+    // still has the source as a target). The copy lazily acquires its own —
+    // possibly shared — notifier the next time one is needed.
+}
+
+Results& Results::operator=(const Results& other)
+{
+    // Not defaulted as the current notifier (if any) needs to be detached
+    // from. Copy-construct first so that if the copy throws (copying the
+    // Query or the aggregate cache can allocate) *this is left untouched,
+    // then let the move assignment tear down the current state and adopt
+    // the copy. The temporary carries no notifier, so the move does not
+    // touch the source's notifier registration.
+    if (this != &other) {
+        Results copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
 
 Results::Results(Results&& other)
 : m_realm(std::move(other.m_realm))
@@ -87,6 +139,14 @@ Results::Results(Results&& other)
 , m_update_policy(other.m_update_policy)
 , m_has_used_table_view(other.m_has_used_table_view)
 , m_wants_background_updates(other.m_wants_background_updates)
+, m_track_moves(other.m_track_moves)
+, m_cached_count(other.m_cached_count)
+, m_cached_count_version(other.m_cached_count_version)
+, m_cached_aggregates(std::move(other.m_cached_aggregates))
+, m_cached_aggregate_version(other.m_cached_aggregate_version)
+, m_offset(other.m_offset)
+, m_limit(other.m_limit)
+, m_table_view_is_windowed(other.m_table_view_is_windowed)
 {
     if (m_notifier) {
         m_notifier->target_results_moved(other, *this);
@@ -130,18 +190,50 @@ size_t Results::size()
     validate_read();
     switch (m_mode) {
         case Mode::Empty:    return 0;
-        case Mode::Table:    return m_table->size();
-        case Mode::LinkView: return m_link_view->size();
-        case Mode::Query:
+        case Mode::Table:    return apply_window(m_table->size());
+        case Mode::LinkView: return apply_window(m_link_view->size());
+        case Mode::Query: {
+            // Answer from the query directly rather than materializing the
+            // TableView, and memoize the count per read version since
+            // dashboards tend to poll it
+            if (!m_realm->is_in_transaction()) {
+                auto version = m_realm->current_transaction_version();
+                if (version && m_cached_count && *version == m_cached_count_version)
+                    return apply_window(*m_cached_count);
+                m_query.sync_view_if_needed();
+                size_t count = count_matching_rows();
+                if (version) {
+                    m_cached_count = count;
+                    m_cached_count_version = *version;
+                }
+                return apply_window(count);
+            }
             m_query.sync_view_if_needed();
-            return m_query.count();
+            return apply_window(m_query.count());
+        }
         case Mode::TableView:
             update_tableview();
-            return m_table_view.size();
+            return apply_window(m_table_view->size());
     }
     REALM_UNREACHABLE();
 }
 
+size_t Results::count_matching_rows()
+{
+    // Counts over disjoint row ranges sum to the count over the whole table,
+    // so this can be spread over the worker pool when that's enabled
+    size_t total = 0;
+    std::mutex merge_mutex;
+    auto& coordinator = Realm::Internal::get_coordinator(*m_realm);
+    bool ran = coordinator.evaluate_query_in_parallel(*m_realm, m_query, m_table->size(),
+        [&](Query& query, size_t begin, size_t end) {
+            size_t count = query.count(begin, end);
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            total += count;
+        });
+    return ran ? total : m_query.count();
+}
+
 const ObjectSchema& Results::get_object_schema() const
 {
     validate_read();
@@ -169,35 +261,134 @@ StringData Results::get_object_type() const noexcept
 RowExpr Results::get(size_t row_ndx)
 {
     validate_read();
+    if (row_ndx < m_limit) {
+        size_t target_ndx = row_ndx + m_offset;
+        switch (m_mode) {
+            case Mode::Empty: break;
+            case Mode::Table:
+                if (target_ndx < m_table->size())
+                    return m_table->get(target_ndx);
+                break;
+            case Mode::LinkView:
+                if (update_linkview()) {
+                    if (target_ndx < m_link_view->size())
+                        return m_link_view->get(target_ndx);
+                    break;
+                }
+                REALM_FALLTHROUGH;
+            case Mode::Query:
+            case Mode::TableView:
+                update_tableview();
+                if (target_ndx >= m_table_view->size())
+                    break;
+                if (m_update_policy == UpdatePolicy::Never && !m_table_view->is_row_attached(target_ndx))
+                    return {};
+                return m_table_view->get(target_ndx);
+        }
+    }
+
+    throw OutOfBoundsIndexException{row_ndx, size()};
+}
+
+void Results::prefetch_hint(size_t start, size_t count)
+{
+    validate_read();
+    if (count == 0 || !m_table)
+        return;
+    // A write transaction's version can't be read from another SharedGroup
+    // until it commits, and read-only Realms have no versions at all
+    if (m_realm->config().read_only() || m_realm->is_in_transaction())
+        return;
+    if (start >= m_limit)
+        return;
+    size_t end = count < m_limit - start ? start + count : m_limit;
+
+    // Resolve the window to row indexes of the target table up front; this
+    // only touches the index structures and not the row data which we want
+    // prefetched. The background thread can't share our accessors, so it
+    // re-resolves the rows from the indexes in its own read transaction.
+    std::vector<size_t> rows;
+    rows.reserve(end - start);
     switch (m_mode) {
-        case Mode::Empty: break;
+        case Mode::Empty:
+            return;
         case Mode::Table:
-            if (row_ndx < m_table->size())
-                return m_table->get(row_ndx);
+            for (size_t i = start; i < end && i + m_offset < m_table->size(); ++i)
+                rows.push_back(i + m_offset);
             break;
         case Mode::LinkView:
             if (update_linkview()) {
-                if (row_ndx < m_link_view->size())
-                    return m_link_view->get(row_ndx);
+                for (size_t i = start; i < end && i + m_offset < m_link_view->size(); ++i)
+                    rows.push_back(m_link_view->get(i + m_offset).get_index());
                 break;
             }
             REALM_FALLTHROUGH;
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            if (row_ndx >= m_table_view.size())
-                break;
-            if (m_update_policy == UpdatePolicy::Never && !m_table_view.is_row_attached(row_ndx))
-                return {};
-            return m_table_view.get(row_ndx);
+            for (size_t i = start; i < end && i + m_offset < m_table_view->size(); ++i) {
+                size_t target_ndx = i + m_offset;
+                if (m_table_view->is_row_attached(target_ndx))
+                    rows.push_back(m_table_view->get(target_ndx).get_index());
+            }
+            break;
     }
+    if (rows.empty())
+        return;
 
-    throw OutOfBoundsIndexException{row_ndx, size()};
+    auto version = Realm::Internal::get_shared_group(*m_realm).get_version_of_current_transaction();
+    Realm::Internal::get_coordinator(*m_realm).prefetch_rows(version, m_table->get_index_in_group(),
+                                                             std::move(rows));
+}
+
+Results::Iterator Results::begin()
+{
+    validate_read();
+    switch (m_mode) {
+        case Mode::Empty:
+        case Mode::Table:
+            break;
+        case Mode::LinkView:
+            update_linkview();
+            break;
+        case Mode::Query:
+        case Mode::TableView:
+            update_tableview();
+            break;
+    }
+    return Iterator(this, 0);
+}
+
+Results::Iterator Results::end()
+{
+    return Iterator(this, size());
+}
+
+RowExpr Results::unchecked_get(size_t row_ndx)
+{
+    row_ndx += m_offset;
+    switch (m_mode) {
+        case Mode::Empty:
+            break;
+        case Mode::Table:
+            return m_table->get(row_ndx);
+        case Mode::LinkView:
+            return m_link_view->get(row_ndx);
+        case Mode::Query:
+        case Mode::TableView:
+            if (m_update_policy == UpdatePolicy::Never && !m_table_view->is_row_attached(row_ndx))
+                return {};
+            return m_table_view->get(row_ndx);
+    }
+    REALM_UNREACHABLE();
 }
 
 util::Optional<RowExpr> Results::first()
 {
     validate_read();
+    if (m_offset != 0 || m_limit != size_t(-1)) {
+        return size() == 0 ? util::none : util::make_optional(get(0));
+    }
     switch (m_mode) {
         case Mode::Empty:
             return none;
@@ -210,7 +401,7 @@ util::Optional<RowExpr> Results::first()
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            return m_table_view.size() == 0 ? util::none : util::make_optional(m_table_view.front());
+            return m_table_view->size() == 0 ? util::none : util::make_optional(m_table_view->front());
     }
     REALM_UNREACHABLE();
 }
@@ -218,6 +409,10 @@ util::Optional<RowExpr> Results::first()
 util::Optional<RowExpr> Results::last()
 {
     validate_read();
+    if (m_offset != 0 || m_limit != size_t(-1)) {
+        size_t count = size();
+        return count == 0 ? util::none : util::make_optional(get(count - 1));
+    }
     switch (m_mode) {
         case Mode::Empty:
             return none;
@@ -230,7 +425,7 @@ util::Optional<RowExpr> Results::last()
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            return m_table_view.size() == 0 ? util::none : util::make_optional(m_table_view.back());
+            return m_table_view->size() == 0 ? util::none : util::make_optional(m_table_view->back());
     }
     REALM_UNREACHABLE();
 }
@@ -248,6 +443,24 @@ bool Results::update_linkview()
     return true;
 }
 
+TableView& Results::writable_table_view(bool preserve_contents) const
+{
+    // The caller is going to mutate the view's contents in some way, so any
+    // positions memoized from them are about to go stale
+    m_row_to_position_valid = false;
+
+    // Snapshots (and copies) share the box with the Results they were taken
+    // from and must continue to see the pre-mutation contents, so break the
+    // sharing before mutating. The old box stays with the snapshots;
+    // copying the contents into the new one is skipped when the caller is
+    // about to overwrite them anyway.
+    if (!m_table_view.unique()) {
+        m_table_view = preserve_contents ? std::make_shared<TableView>(*m_table_view)
+                                         : std::make_shared<TableView>();
+    }
+    return *m_table_view;
+}
+
 void Results::update_tableview(bool wants_notifications)
 {
     if (m_update_policy == UpdatePolicy::Never) {
@@ -260,21 +473,35 @@ void Results::update_tableview(bool wants_notifications)
         case Mode::Table:
         case Mode::LinkView:
             return;
-        case Mode::Query:
+        case Mode::Query: {
             m_query.sync_view_if_needed();
-            m_table_view = m_query.find_all();
+            auto& tv = writable_table_view(false);
+            if (!m_sort && m_limit != size_t(-1) && m_offset + m_limit >= m_limit) {
+                // an unsorted window can never expose rows past offset+limit,
+                // so don't even collect them
+                tv = m_query.find_all(0, size_t(-1), m_offset + m_limit);
+                m_table_view_is_windowed = true;
+            }
+            else {
+                tv = m_query.find_all();
+                m_table_view_is_windowed = false;
+            }
             if (m_sort) {
-                m_table_view.sort(m_sort);
+                tv.sort(m_sort);
             }
             m_mode = Mode::TableView;
+        }
             REALM_FALLTHROUGH;
         case Mode::TableView:
             if (wants_notifications && !m_notifier && !m_realm->is_in_transaction() && m_realm->can_deliver_notifications()) {
-                m_notifier = std::make_shared<_impl::ResultsNotifier>(*this);
-                _impl::RealmCoordinator::register_notifier(m_notifier);
+                m_notifier = _impl::RealmCoordinator::notifier_for_results(*this, npos);
             }
             m_has_used_table_view = true;
-            m_table_view.sync_if_needed();
+            // Skip the sync entirely when nothing has changed so that a view
+            // shared with snapshots isn't detached (and thus copied) by the
+            // no-op update
+            if (!m_table_view->is_in_sync())
+                writable_table_view().sync_if_needed();
             break;
     }
 }
@@ -298,26 +525,86 @@ size_t Results::index_of(Row const& row)
 size_t Results::index_of(size_t row_ndx)
 {
     validate_read();
+    auto translate = [&](size_t ndx) {
+        // map an unwindowed index to the window exposed by this Results
+        if (ndx == not_found || ndx < m_offset)
+            return not_found;
+        ndx -= m_offset;
+        return ndx < m_limit ? ndx : not_found;
+    };
     switch (m_mode) {
         case Mode::Empty:
             return not_found;
         case Mode::Table:
-            return row_ndx;
+            return translate(row_ndx);
         case Mode::LinkView:
             if (update_linkview())
-                return m_link_view->find(row_ndx);
+                return translate(m_link_view->find(row_ndx));
             REALM_FALLTHROUGH;
         case Mode::Query:
-        case Mode::TableView:
+        case Mode::TableView: {
             update_tableview();
-            return m_table_view.find_by_source_ndx(row_ndx);
+            // Lazily build a row -> position map on the first lookup against
+            // these view contents so that looking up every row of a large
+            // selection isn't quadratic. For rows appearing multiple times
+            // (possible for views over a LinkView) the first position wins,
+            // matching find_by_source_ndx().
+            if (!m_row_to_position_valid) {
+                m_row_to_position.clear();
+                size_t size = m_table_view->size();
+                m_row_to_position.reserve(size);
+                for (size_t i = 0; i < size; ++i)
+                    m_row_to_position.emplace(m_table_view->get_source_ndx(i), i);
+                m_row_to_position_valid = true;
+            }
+            auto it = m_row_to_position.find(row_ndx);
+            return translate(it == m_row_to_position.end() ? not_found : it->second);
+        }
     }
     REALM_UNREACHABLE();
 }
 
+namespace {
+// Evaluate a sum over row ranges on the worker pool, merging the per-range
+// partial sums. Unlike min/max/average, sums over disjoint ranges can be
+// merged without affecting null handling (null values simply contribute
+// nothing), so sum is the only aggregate evaluated in parallel. Returns none
+// if parallel evaluation is unavailable for this query.
+template<typename Getter>
+util::Optional<Mixed> sum_in_parallel(Realm& realm, Query& query, size_t row_count,
+                                      Getter const& getter, std::true_type)
+{
+    using AggregateType = decltype(getter(std::declval<TableView const&>()));
+    util::Optional<AggregateType> total;
+    std::mutex merge_mutex;
+    auto& coordinator = Realm::Internal::get_coordinator(realm);
+    bool ran = coordinator.evaluate_query_in_parallel(realm, query, row_count,
+        [&](Query& q, size_t begin, size_t end) {
+            TableView tv = q.find_all(begin, end);
+            if (tv.size() == 0)
+                return;
+            auto partial = getter(tv);
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            total = total ? *total + partial : partial;
+        });
+    if (!ran)
+        return util::none;
+    // sum() is zero rather than none when no rows matched
+    return util::Optional<Mixed>(Mixed(total ? *total : AggregateType{}));
+}
+
+// Overload for column types whose sum getter always throws, which can never
+// produce a partial sum to merge
+template<typename Getter>
+util::Optional<Mixed> sum_in_parallel(Realm&, Query&, size_t, Getter const&, std::false_type)
+{
+    return util::none;
+}
+} // anonymous namespace
+
 template<typename Int, typename Float, typename Double, typename Timestamp>
-util::Optional<Mixed> Results::aggregate(size_t column, bool return_none_for_empty,
-                                         const char* name,
+util::Optional<Mixed> Results::aggregate(AggregateOperation op, size_t column,
+                                         bool return_none_for_empty, const char* name,
                                          Int agg_int, Float agg_float,
                                          Double agg_double, Timestamp agg_timestamp)
 {
@@ -327,6 +614,21 @@ util::Optional<Mixed> Results::aggregate(size_t column, bool return_none_for_emp
     if (column > m_table->get_column_count())
         throw OutOfBoundsIndexException{column, m_table->get_column_count()};
 
+    // Stats UIs tend to request the same aggregates over and over, so
+    // memoize them per (operation, column) until the read version moves
+    util::Optional<uint_fast64_t> version;
+    if (!m_realm->is_in_transaction())
+        version = m_realm->current_transaction_version();
+    if (version) {
+        if (m_cached_aggregate_version != *version) {
+            m_cached_aggregates.clear();
+            m_cached_aggregate_version = *version;
+        }
+        auto it = m_cached_aggregates.find({name, column});
+        if (it != m_cached_aggregates.end())
+            return it->second;
+    }
+
     auto do_agg = [&](auto const& getter) -> util::Optional<Mixed> {
         switch (m_mode) {
             case Mode::Empty:
@@ -340,29 +642,49 @@ util::Optional<Mixed> Results::aggregate(size_t column, bool return_none_for_emp
                 m_mode = Mode::Query;
                 REALM_FALLTHROUGH;
             case Mode::Query:
-            case Mode::TableView:
+                if (op == AggregateOperation::Sum) {
+                    using AggregateType = decltype(getter(*m_table_view));
+                    if (auto parallel = sum_in_parallel(*m_realm, m_query, m_table->size(), getter,
+                                                        std::is_arithmetic<AggregateType>{}))
+                        return parallel;
+                }
+                REALM_FALLTHROUGH;
+            case Mode::TableView: {
                 this->update_tableview();
-                if (return_none_for_empty && m_table_view.size() == 0)
+                if (m_table_view_is_windowed) {
+                    // The materialized view only holds the window's rows,
+                    // but aggregates are defined over every matching row
+                    auto full_view = m_query.find_all();
+                    if (return_none_for_empty && full_view.size() == 0)
+                        return none;
+                    return util::Optional<Mixed>(getter(full_view));
+                }
+                if (return_none_for_empty && m_table_view->size() == 0)
                     return none;
-                return util::Optional<Mixed>(getter(m_table_view));
+                return util::Optional<Mixed>(getter(*m_table_view));
+            }
         }
         REALM_UNREACHABLE();
     };
 
+    util::Optional<Mixed> result;
     switch (m_table->get_column_type(column))
     {
-        case type_Timestamp: return do_agg(agg_timestamp);
-        case type_Double: return do_agg(agg_double);
-        case type_Float: return do_agg(agg_float);
-        case type_Int: return do_agg(agg_int);
+        case type_Timestamp: result = do_agg(agg_timestamp); break;
+        case type_Double: result = do_agg(agg_double); break;
+        case type_Float: result = do_agg(agg_float); break;
+        case type_Int: result = do_agg(agg_int); break;
         default:
             throw UnsupportedColumnTypeException{column, m_table, name};
     }
+    if (version)
+        m_cached_aggregates[{name, column}] = result;
+    return result;
 }
 
 util::Optional<Mixed> Results::max(size_t column)
 {
-    return aggregate(column, true, "max",
+    return aggregate(AggregateOperation::Maximum, column, true, "max",
                      [=](auto const& table) { return table.maximum_int(column); },
                      [=](auto const& table) { return table.maximum_float(column); },
                      [=](auto const& table) { return table.maximum_double(column); },
@@ -371,7 +693,7 @@ util::Optional<Mixed> Results::max(size_t column)
 
 util::Optional<Mixed> Results::min(size_t column)
 {
-    return aggregate(column, true, "min",
+    return aggregate(AggregateOperation::Minimum, column, true, "min",
                      [=](auto const& table) { return table.minimum_int(column); },
                      [=](auto const& table) { return table.minimum_float(column); },
                      [=](auto const& table) { return table.minimum_double(column); },
@@ -380,7 +702,7 @@ util::Optional<Mixed> Results::min(size_t column)
 
 util::Optional<Mixed> Results::sum(size_t column)
 {
-    return aggregate(column, false, "sum",
+    return aggregate(AggregateOperation::Sum, column, false, "sum",
                      [=](auto const& table) { return table.sum_int(column); },
                      [=](auto const& table) { return table.sum_float(column); },
                      [=](auto const& table) { return table.sum_double(column); },
@@ -389,7 +711,7 @@ util::Optional<Mixed> Results::sum(size_t column)
 
 util::Optional<Mixed> Results::average(size_t column)
 {
-    return aggregate(column, true, "average",
+    return aggregate(AggregateOperation::Average, column, true, "average",
                      [=](auto const& table) { return table.average_int(column); },
                      [=](auto const& table) { return table.average_float(column); },
                      [=](auto const& table) { return table.average_double(column); },
@@ -412,13 +734,23 @@ void Results::clear()
             validate_write();
             update_tableview();
 
+            if (m_table_view_is_windowed) {
+                // The materialized view only holds the window's rows, but
+                // clear() removes every row matching the query
+                TableView full_view = m_query.find_all();
+                full_view.clear(RemoveMode::unordered);
+                break;
+            }
+
             switch (m_update_policy) {
                 case UpdatePolicy::Auto:
-                    m_table_view.clear(RemoveMode::unordered);
+                    // Detach from any snapshots sharing the view, as they
+                    // shouldn't see their size() change
+                    writable_table_view().clear(RemoveMode::unordered);
                     break;
                 case UpdatePolicy::Never: {
                     // Copy the TableView because a frozen Results shouldn't let its size() change.
-                    TableView copy(m_table_view);
+                    TableView copy(*m_table_view);
                     copy.clear(RemoveMode::unordered);
                     break;
                 }
@@ -441,17 +773,17 @@ Query Results::get_query() const
         case Mode::TableView: {
             // A TableView has an associated Query if it was produced by Query::find_all. This is indicated
             // by TableView::get_query returning a Query with a non-null table.
-            Query query = m_table_view.get_query();
+            Query query = m_table_view->get_query();
             if (query.get_table()) {
                 return query;
             }
 
             // The TableView has no associated query so create one with no conditions that is restricted
             // to the rows in the TableView.
-            if (m_update_policy == UpdatePolicy::Auto) {
-                m_table_view.sync_if_needed();
+            if (m_update_policy == UpdatePolicy::Auto && !m_table_view->is_in_sync()) {
+                writable_table_view().sync_if_needed();
             }
-            return Query(*m_table, std::unique_ptr<TableViewBase>(new TableView(m_table_view)));
+            return Query(*m_table, std::unique_ptr<TableViewBase>(new TableView(*m_table_view)));
         }
         case Mode::LinkView:
             return m_table->where(m_link_view);
@@ -474,7 +806,7 @@ TableView Results::get_tableview()
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            return m_table_view;
+            return *m_table_view;
         case Mode::Table:
             return m_table->where().find_all();
     }
@@ -491,6 +823,27 @@ Results Results::filter(Query&& q) const
     return Results(m_realm, get_query().and_query(std::move(q)), m_sort);
 }
 
+Results Results::limit(size_t max_count) const
+{
+    validate_read();
+    Results result(*this);
+    result.m_notifier.reset();
+    result.m_limit = max_count < m_limit ? max_count : m_limit;
+    return result;
+}
+
+Results Results::offset(size_t skip_count) const
+{
+    validate_read();
+    Results result(*this);
+    result.m_notifier.reset();
+    result.m_offset = m_offset + skip_count;
+    if (m_limit != size_t(-1)) {
+        result.m_limit = skip_count < m_limit ? m_limit - skip_count : 0;
+    }
+    return result;
+}
+
 Results Results::snapshot() const &
 {
     validate_read();
@@ -515,6 +868,8 @@ Results Results::snapshot() &&
         case Mode::Query:
         case Mode::TableView:
             update_tableview(false);
+            if (m_notifier)
+                m_notifier->remove_target(*this);
             m_notifier.reset();
             m_update_policy = UpdatePolicy::Never;
             return std::move(*this);
@@ -522,22 +877,42 @@ Results Results::snapshot() &&
     REALM_UNREACHABLE();
 }
 
-void Results::prepare_async()
+void Results::validate_async() const
 {
     if (m_realm->config().read_only()) {
         throw InvalidTransactionException("Cannot create asynchronous query for read-only Realms");
     }
+    if (m_realm->is_frozen()) {
+        throw InvalidTransactionException("Cannot create asynchronous query for frozen Realms");
+    }
     if (m_realm->is_in_transaction()) {
         throw InvalidTransactionException("Cannot create asynchronous query while in a write transaction");
     }
     if (m_update_policy == UpdatePolicy::Never) {
         throw std::logic_error("Cannot create asynchronous query for snapshotted Results.");
     }
+}
+
+void Results::set_move_tracking_enabled(bool enabled)
+{
+    if (m_notifier)
+        throw std::logic_error("Cannot change move tracking once a notification callback has been added.");
+    m_track_moves = enabled;
+}
+
+void Results::prepare_async()
+{
+    validate_async();
 
     if (!m_notifier) {
         m_wants_background_updates = true;
-        m_notifier = std::make_shared<_impl::ResultsNotifier>(*this);
-        _impl::RealmCoordinator::register_notifier(m_notifier);
+        // Unfiltered, unsorted, unwindowed table-backed Results are fully
+        // interchangeable, so any number of them watching the same table can
+        // share a single notifier
+        size_t shared_table_ndx = npos;
+        if (m_mode == Mode::Table && !m_sort && m_offset == 0 && m_limit == size_t(-1))
+            shared_table_ndx = m_table->get_index_in_group();
+        m_notifier = _impl::RealmCoordinator::notifier_for_results(*this, shared_table_ndx);
     }
 }
 
@@ -554,6 +929,90 @@ NotificationToken Results::add_notification_callback(CollectionChangeCallback cb
     return {m_notifier, m_notifier->add_callback(std::move(cb))};
 }
 
+NotificationToken Results::async_aggregate(AggregateOperation op, size_t column,
+                                           const char* name, AsyncAggregateCallback callback)
+{
+    validate_read();
+    if (!m_table) {
+        // Nothing to compute, so don't bother scheduling anything
+        callback(none, nullptr);
+        return {};
+    }
+    validate_async();
+    if (column >= m_table->get_column_count())
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+
+    // Validate the column type here so that misuse is reported synchronously
+    // on the calling thread rather than through the callback
+    switch (m_table->get_column_type(column)) {
+        case type_Int:
+        case type_Float:
+        case type_Double:
+            break;
+        case type_Timestamp:
+            if (op == AggregateOperation::Maximum || op == AggregateOperation::Minimum)
+                break;
+            REALM_FALLTHROUGH;
+        default:
+            throw UnsupportedColumnTypeException{column, m_table, name};
+    }
+
+    // Unlike the change notification machinery this doesn't reuse m_notifier,
+    // as each aggregate request is an independent one-shot computation
+    auto notifier = std::make_shared<_impl::ResultsAggregateNotifier>(*this, op, column);
+    _impl::RealmCoordinator::register_notifier(notifier);
+    // The callback is only ever invoked by the notifier itself, so the plain
+    // pointer cannot dangle
+    auto sentinel = notifier.get();
+    auto wrap = [sentinel, callback=std::move(callback)](CollectionChangeSet, std::exception_ptr e) {
+        callback(e ? util::none : sentinel->value(), e);
+    };
+    return {notifier, notifier->add_callback(std::move(wrap))};
+}
+
+NotificationToken Results::async_snapshot(AsyncSnapshotCallback callback)
+{
+    validate_read();
+    if (!m_table) {
+        // Nothing to run, so don't bother scheduling anything
+        callback(Results(), nullptr);
+        return {};
+    }
+    validate_async();
+
+    // Like the async aggregates, each snapshot request is an independent
+    // one-shot computation rather than reusing m_notifier
+    auto notifier = std::make_shared<_impl::ResultsSnapshotNotifier>(*this);
+    _impl::RealmCoordinator::register_notifier(notifier);
+    // The callback is only ever invoked by the notifier itself, so the plain
+    // pointer cannot dangle
+    auto sentinel = notifier.get();
+    auto wrap = [sentinel, callback=std::move(callback)](CollectionChangeSet, std::exception_ptr e) {
+        callback(e ? Results() : sentinel->snapshot(), e);
+    };
+    return {notifier, notifier->add_callback(std::move(wrap))};
+}
+
+NotificationToken Results::async_max(size_t column, AsyncAggregateCallback callback)
+{
+    return async_aggregate(AggregateOperation::Maximum, column, "max", std::move(callback));
+}
+
+NotificationToken Results::async_min(size_t column, AsyncAggregateCallback callback)
+{
+    return async_aggregate(AggregateOperation::Minimum, column, "min", std::move(callback));
+}
+
+NotificationToken Results::async_average(size_t column, AsyncAggregateCallback callback)
+{
+    return async_aggregate(AggregateOperation::Average, column, "average", std::move(callback));
+}
+
+NotificationToken Results::async_sum(size_t column, AsyncAggregateCallback callback)
+{
+    return async_aggregate(AggregateOperation::Sum, column, "sum", std::move(callback));
+}
+
 bool Results::is_in_table_order() const
 {
     switch (m_mode) {
@@ -565,7 +1024,7 @@ bool Results::is_in_table_order() const
         case Mode::Query:
             return m_query.produces_results_in_table_order() && !m_sort;
         case Mode::TableView:
-            return m_table_view.is_in_table_order();
+            return m_table_view->is_in_table_order();
     }
     REALM_UNREACHABLE(); // keep gcc happy
 }
@@ -579,11 +1038,11 @@ void Results::Internal::set_table_view(Results& results, realm::TableView &&tv)
         results.m_wants_background_updates = results.m_has_used_table_view;
     }
 
-    results.m_table_view = std::move(tv);
+    results.writable_table_view(false) = std::move(tv);
     results.m_mode = Mode::TableView;
     results.m_has_used_table_view = false;
-    REALM_ASSERT(results.m_table_view.is_in_sync());
-    REALM_ASSERT(results.m_table_view.is_attached());
+    REALM_ASSERT(results.m_table_view->is_in_sync());
+    REALM_ASSERT(results.m_table_view->is_attached());
 }
 
 Results::OutOfBoundsIndexException::OutOfBoundsIndexException(size_t r, size_t c)
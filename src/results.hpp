@@ -26,6 +26,11 @@
 #include <realm/table_view.hpp>
 #include <realm/util/optional.hpp>
 
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
 namespace realm {
 template<typename T> class BasicRowExpr;
 using RowExpr = BasicRowExpr<Table>;
@@ -33,6 +38,7 @@ class Mixed;
 class ObjectSchema;
 
 namespace _impl {
+    class ResultsAggregateNotifier;
     class ResultsNotifier;
 }
 
@@ -89,6 +95,52 @@ public:
     util::Optional<RowExpr> first();
     util::Optional<RowExpr> last();
 
+    // Hint that the rows at indexes [start, start + count) are about to be
+    // read, so that their backing pages can be faulted in from a background
+    // thread while the calling thread processes earlier rows. Entirely
+    // best-effort and never changes observable behavior; does nothing for
+    // read-only Realms or within write transactions. Indexes past the end
+    // of the results are silently ignored.
+    void prefetch_hint(size_t start, size_t count);
+
+    // An input iterator over the rows of a Results. Creating the iterator
+    // validates the Results and (for queries) materializes the TableView
+    // once, after which advancing it is just an index increment with no
+    // per-row revalidation, making sequential scans much cheaper than
+    // repeated get() calls.
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = RowExpr;
+        using difference_type = ptrdiff_t;
+        using pointer = void;
+        using reference = RowExpr;
+
+        RowExpr operator*() const { return m_results->unchecked_get(m_index); }
+        Iterator& operator++() { ++m_index; return *this; }
+        Iterator operator++(int) { Iterator prev = *this; ++m_index; return prev; }
+        bool operator==(Iterator const& other) const { return m_index == other.m_index; }
+        bool operator!=(Iterator const& other) const { return m_index != other.m_index; }
+
+    private:
+        friend class Results;
+        Iterator(Results* results, size_t index) : m_results(results), m_index(index) {}
+
+        Results* m_results;
+        size_t m_index;
+    };
+
+    Iterator begin();
+    Iterator end();
+
+    // Call `func` with the row accessor for each row in this Results
+    template<typename Func>
+    void for_each(Func&& func)
+    {
+        for (auto it = begin(), e = end(); it != e; ++it)
+            func(*it);
+    }
+
     // Get the first index of the given row in this results, or not_found
     // Throws DetachedAccessorException if row is not attached
     // Throws IncorrectTableException if row belongs to a different table
@@ -104,7 +156,21 @@ public:
     Results filter(Query&& q) const;
     Results sort(SortDescriptor&& sort) const;
 
+    // Create a new Results restricted to a window of this Results' rows.
+    // The window applies to row access (size(), get(), first(), last(),
+    // iteration and index_of()); clear(), the aggregate operations and
+    // get_query() still see every matching row. For unsorted queries the
+    // limit is pushed down into the query so that only the first
+    // offset+limit matches are ever collected; sorted results must still
+    // collect and sort all matches before the window is applied.
+    Results limit(size_t max_count) const;
+    Results offset(size_t skip_count) const;
+
     // Return a snapshot of this Results that never updates to reflect changes in the underlying data.
+    // The snapshot is a copy-on-write reference to the already-computed
+    // view, so taking one of an up-to-date Results is cheap regardless of
+    // its size; the view is cloned only if the source Results subsequently
+    // updates.
     Results snapshot() const &;
     Results snapshot() &&;
 
@@ -118,6 +184,38 @@ public:
     util::Optional<Mixed> average(size_t column);
     util::Optional<Mixed> sum(size_t column);
 
+    enum class AggregateOperation {
+        Maximum,
+        Minimum,
+        Average,
+        Sum,
+    };
+
+    // Compute an aggregate on the background worker thread rather than the
+    // calling thread, and deliver the value to the callback on the next
+    // notify() after it has been computed. The value has the same semantics
+    // as the synchronous aggregate getters. Unsupported column types are
+    // reported synchronously by throwing from these functions; errors on the
+    // worker thread are reported by calling the callback with a non-null
+    // exception_ptr. Destroying the returned token before the value has been
+    // delivered cancels the computation.
+    using AsyncAggregateCallback = std::function<void (util::Optional<Mixed>, std::exception_ptr)>;
+    NotificationToken async_max(size_t column, AsyncAggregateCallback callback);
+    NotificationToken async_min(size_t column, AsyncAggregateCallback callback);
+    NotificationToken async_average(size_t column, AsyncAggregateCallback callback);
+    NotificationToken async_sum(size_t column, AsyncAggregateCallback callback);
+
+    // Run the query once on the background worker thread and deliver the
+    // matching rows to the callback as a snapshot Results on the next
+    // notify() after it has been computed. The snapshot never updates to
+    // reflect later changes and no change tracking is performed, making this
+    // much cheaper than add_notification_callback() when only a single
+    // answer is needed. Errors on the worker thread are reported by calling
+    // the callback with a non-null exception_ptr. Destroying the returned
+    // token before the snapshot has been delivered cancels the computation.
+    using AsyncSnapshotCallback = std::function<void (Results, std::exception_ptr)>;
+    NotificationToken async_snapshot(AsyncSnapshotCallback callback);
+
     enum class Mode {
         Empty, // Backed by nothing (for missing tables)
         Table, // Backed directly by a Table
@@ -175,6 +273,14 @@ public:
 
     bool wants_background_updates() const { return m_wants_background_updates; }
 
+    // Control whether change notifications for this Results report moves.
+    // When move tracking is disabled, rows which changed position are instead
+    // reported as a deletion and an insertion, which is significantly cheaper
+    // to calculate for large collections. Must be set before the first
+    // notification callback is added.
+    void set_move_tracking_enabled(bool);
+    bool move_tracking_enabled() const noexcept { return m_track_moves; }
+
     // Returns whether the rows are guaranteed to be in table order.
     bool is_in_table_order() const;
 
@@ -194,7 +300,12 @@ private:
     SharedRealm m_realm;
     mutable const ObjectSchema *m_object_schema = nullptr;
     Query m_query;
-    TableView m_table_view;
+    // The materialized view backing this Results when in Mode::TableView.
+    // It's stored behind a shared_ptr so that snapshot() can be a
+    // copy-on-write reference to the already-computed view rather than a
+    // deep copy: snapshots share the box, and a Results sharing its box
+    // detaches via writable_table_view() before mutating it. Never null.
+    mutable std::shared_ptr<TableView> m_table_view = std::make_shared<TableView>();
     LinkViewRef m_link_view;
     Table* m_table = nullptr;
     SortDescriptor m_sort;
@@ -205,18 +316,72 @@ private:
     UpdatePolicy m_update_policy = UpdatePolicy::Auto;
     bool m_has_used_table_view = false;
     bool m_wants_background_updates = true;
+    bool m_track_moves = true;
+
+    // Count of matching rows in Query mode, memoized per read version so
+    // that polling size() does not rerun the query
+    util::Optional<size_t> m_cached_count;
+    uint_fast64_t m_cached_count_version = 0;
+
+    // Aggregate results memoized per (operation, column), discarded when the
+    // read version moves
+    std::map<std::pair<const char*, size_t>, util::Optional<Mixed>> m_cached_aggregates;
+    uint_fast64_t m_cached_aggregate_version = 0;
+
+    // Source row index -> position in m_table_view, built lazily on the
+    // first index_of() call against the current view contents so that
+    // looking up many rows (e.g. restoring a large selection) is O(1) per
+    // row instead of a linear scan each. Invalidated by
+    // writable_table_view(), which every mutation of the view goes through.
+    mutable std::unordered_map<size_t, size_t> m_row_to_position;
+    mutable bool m_row_to_position_valid = false;
+
+    // Window of rows exposed by this Results, set via limit()/offset()
+    size_t m_offset = 0;
+    size_t m_limit = size_t(-1);
+
+    // True when m_table_view was materialized with the window's limit pushed
+    // down into the query, and so only holds the first m_offset + m_limit
+    // matching rows. Operations defined over every matching row (clear() and
+    // the aggregates) must go back to m_query rather than use the view.
+    bool m_table_view_is_windowed = false;
+
+    // Map the size of the unwindowed rows to the number of exposed rows
+    size_t apply_window(size_t size) const noexcept
+    {
+        size_t skipped = m_offset < size ? m_offset : size;
+        size_t count = size - skipped;
+        return m_limit < count ? m_limit : count;
+    }
 
     void update_tableview(bool wants_notifications = true);
     bool update_linkview();
 
+    // Get the TableView for mutation, first giving up the box to any
+    // snapshots (or copies) sharing it, which must continue to see the
+    // pre-mutation contents. Copying the contents into the new box is
+    // skipped when `preserve_contents` is false, for callers which are
+    // about to overwrite them anyway.
+    TableView& writable_table_view(bool preserve_contents = true) const;
+
+    // Get a row accessor without validating the Results or bounds-checking;
+    // callers must have validated and pinned the view first (see begin())
+    RowExpr unchecked_get(size_t row_ndx);
+
     void validate_read() const;
     void validate_write() const;
+    void validate_async() const;
 
     void prepare_async();
 
+    NotificationToken async_aggregate(AggregateOperation op, size_t column,
+                                      const char* name, AsyncAggregateCallback callback);
+
+    size_t count_matching_rows();
+
     template<typename Int, typename Float, typename Double, typename Timestamp>
-    util::Optional<Mixed> aggregate(size_t column, bool return_none_for_empty,
-                                    const char* name,
+    util::Optional<Mixed> aggregate(AggregateOperation op, size_t column,
+                                    bool return_none_for_empty, const char* name,
                                     Int agg_int, Float agg_float,
                                     Double agg_double, Timestamp agg_timestamp);
 
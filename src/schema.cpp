@@ -18,12 +18,15 @@
 
 #include "schema.hpp"
 
+#include "impl/query_worker_pool.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
 #include "object_schema.hpp"
 #include "property.hpp"
 
 #include <algorithm>
+#include <iterator>
+#include <thread>
 
 using namespace realm;
 
@@ -79,8 +82,46 @@ Schema::const_iterator Schema::find(ObjectSchema const& object) const noexcept
 void Schema::validate() const
 {
     std::vector<ObjectSchemaValidationException> exceptions;
-    for (auto const& object : *this) {
-        object.validate(*this, exceptions);
+
+    // Validating a class only reads that class and does read-only lookups
+    // into the rest of the schema, so for large schemas the per-class work is
+    // spread over a thread pool. Small schemas are validated on the calling
+    // thread, as the work wouldn't cover the cost of spinning up the pool.
+    const size_t count = size();
+    const size_t min_parallel_classes = 32;
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    if (count < min_parallel_classes || hardware_threads < 2) {
+        for (auto const& object : *this) {
+            object.validate(*this, exceptions);
+        }
+    }
+    else {
+        // Cross-class property lookups build each class's lazy property
+        // index on first use, so build them all up front to ensure that the
+        // worker threads only ever read them
+        for (auto const& object : *this) {
+            object.property_for_name(object.primary_key);
+        }
+
+        const size_t workers = std::min<size_t>(hardware_threads, 8);
+        std::vector<std::vector<ObjectSchemaValidationException>> partition_exceptions(workers);
+        _impl::QueryWorkerPool pool(workers - 1);
+        pool.run(workers, [&](size_t partition) {
+            size_t begin_ndx = count * partition / workers;
+            size_t end_ndx = count * (partition + 1) / workers;
+            auto& out = partition_exceptions[partition];
+            for (size_t i = begin_ndx; i < end_ndx; ++i) {
+                begin()[i].validate(*this, out);
+            }
+        });
+
+        // Concatenating the contiguous partitions in order preserves the
+        // error ordering of the serial path
+        for (auto& partial : partition_exceptions) {
+            exceptions.insert(exceptions.end(),
+                              std::make_move_iterator(partial.begin()),
+                              std::make_move_iterator(partial.end()));
+        }
     }
 
     if (exceptions.size()) {
@@ -148,6 +189,13 @@ static void compare(ObjectSchema const& existing_schema,
               [](auto a, auto b) { return GetRemovedColumn()(a) > GetRemovedColumn()(b); });
 }
 
+std::vector<SchemaChange> Schema::compare(ObjectSchema const& existing, ObjectSchema const& target)
+{
+    std::vector<SchemaChange> changes;
+    ::compare(existing, target, changes);
+    return changes;
+}
+
 std::vector<SchemaChange> Schema::compare(Schema const& target_schema) const
 {
     std::vector<SchemaChange> changes;
@@ -58,6 +58,12 @@ public:
     // Get the changes which must be applied to this schema to produce the passed-in schema
     std::vector<SchemaChange> compare(Schema const&) const;
 
+    // Get the changes which must be applied to the single class `existing`
+    // to produce `target`, without needing complete schemas for either side.
+    // Does not produce AddTable; the caller is responsible for checking that
+    // the class exists at all.
+    static std::vector<SchemaChange> compare(ObjectSchema const& existing, ObjectSchema const& target);
+
     void copy_table_columns_from(Schema const&);
 
     friend bool operator==(Schema const&, Schema const&);
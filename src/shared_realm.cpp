@@ -19,6 +19,7 @@
 #include "shared_realm.hpp"
 
 #include "impl/handover.hpp"
+#include "impl/notification_tracer.hpp"
 #include "impl/realm_coordinator.hpp"
 #include "impl/transact_log_handler.hpp"
 
@@ -29,10 +30,17 @@
 #include "thread_confined.hpp"
 
 #include "util/format.hpp"
+#include "util/metrics.hpp"
 
 #include <realm/history.hpp>
+#include <realm/util/file.hpp>
 #include <realm/util/scope_exit.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <unordered_map>
+
 using namespace realm;
 using namespace realm::_impl;
 
@@ -50,13 +58,17 @@ void Realm::init(std::shared_ptr<_impl::RealmCoordinator> coordinator)
 {
     // if there is an existing realm at the current path steal its schema/column mapping
     if (auto existing = coordinator ? coordinator->get_schema() : nullptr) {
-        m_schema = *existing;
+        m_schema = std::move(existing);
         m_schema_version = coordinator->get_schema_version();
+        // Remembering the transaction version the cached schema was read at
+        // lets read_schema_from_group_if_needed() skip introspecting the
+        // group entirely if nothing has been committed since then
+        m_schema_transaction_version = coordinator->get_schema_transaction_version();
     }
     else {
         // otherwise get the schema from the group
         m_schema_version = ObjectStore::get_schema_version(read_group());
-        m_schema = ObjectStore::schema_from_group(read_group());
+        m_schema = std::make_shared<Schema>(ObjectStore::schema_from_group(read_group()));
 
         if (m_shared_group) {
             m_schema_transaction_version = m_shared_group->get_version_of_current_transaction().version;
@@ -181,17 +193,58 @@ Group& Realm::read_group()
     return *m_group;
 }
 
+namespace {
+// Thread-local cache of the Realms most recently returned by
+// get_shared_realm() for each path, so that a thread repeatedly opening the
+// same path in the steady state pays one hash lookup instead of the
+// coordinator registry locks. Entries are weak, so the cache never extends a
+// Realm's lifetime; expired entries are purged when they are next looked up.
+thread_local std::unordered_map<std::string, std::weak_ptr<Realm>> t_cached_realms;
+
+bool config_matches_cached_realm(Realm::Config const& config, Realm const& realm)
+{
+    auto& existing = realm.config();
+    return existing.cache
+        && existing.read_only() == config.read_only()
+        && existing.in_memory == config.in_memory
+        && existing.encryption_key == config.encryption_key
+        && existing.schema_mode == config.schema_mode
+        && (existing.schema_version == config.schema_version
+            || config.schema_version == ObjectStore::NotVersioned);
+}
+} // anonymous namespace
+
 SharedRealm Realm::get_shared_realm(Config config)
 {
+    if (config.cache) {
+        auto it = t_cached_realms.find(config.path);
+        if (it != t_cached_realms.end()) {
+            auto realm = it->second.lock();
+            if (realm && !realm->is_closed() && config_matches_cached_realm(config, *realm)) {
+                return realm;
+            }
+            if (!realm || realm->is_closed()) {
+                t_cached_realms.erase(it);
+            }
+            // On a config mismatch fall through to the coordinator, which
+            // reports the mismatch with the appropriate exception
+        }
+    }
+
+    bool cache = config.cache;
     auto coordinator = RealmCoordinator::get_coordinator(config.path);
-    return coordinator->get_realm(std::move(config));
+    auto realm = coordinator->get_realm(std::move(config));
+    if (cache) {
+        t_cached_realms[realm->config().path] = realm;
+    }
+    return realm;
 }
 
 void Realm::set_schema(Schema schema, uint64_t version)
 {
-    schema.copy_table_columns_from(m_schema);
-    m_schema = schema;
-    m_coordinator->update_schema(schema, version);
+    schema.copy_table_columns_from(*m_schema);
+    m_schema = std::make_shared<Schema>(std::move(schema));
+    m_coordinator->update_schema(m_schema, version, m_schema_transaction_version);
 }
 
 bool Realm::read_schema_from_group_if_needed()
@@ -205,7 +258,7 @@ bool Realm::read_schema_from_group_if_needed()
     if (m_schema_transaction_version == current_version)
         return false;
 
-    m_schema = ObjectStore::schema_from_group(group);
+    m_schema = std::make_shared<Schema>(ObjectStore::schema_from_group(group));
     m_schema_version = ObjectStore::get_schema_version(group);
     m_schema_transaction_version = current_version;
     return true;
@@ -228,16 +281,16 @@ void Realm::reset_file_if_needed(Schema const& schema, uint64_t version, std::ve
     util::File::remove(m_config.path);
 
     open_with_config(m_config, m_history, m_shared_group, m_read_only_group, this);
-    m_schema = ObjectStore::schema_from_group(read_group());
+    m_schema = std::make_shared<Schema>(ObjectStore::schema_from_group(read_group()));
     m_schema_version = ObjectStore::get_schema_version(read_group());
-    required_changes = m_schema.compare(schema);
+    required_changes = m_schema->compare(schema);
 }
 
 void Realm::update_schema(Schema schema, uint64_t version, MigrationFunction migration_function)
 {
     schema.validate();
     read_schema_from_group_if_needed();
-    std::vector<SchemaChange> required_changes = m_schema.compare(schema);
+    std::vector<SchemaChange> required_changes = m_schema->compare(schema);
 
     auto no_changes_required = [&] {
         switch (m_config.schema_mode) {
@@ -257,7 +310,7 @@ void Realm::update_schema(Schema schema, uint64_t version, MigrationFunction mig
             case SchemaMode::ReadOnly:
                 if (version != m_schema_version)
                     throw InvalidSchemaVersionException(m_schema_version, version);
-                ObjectStore::verify_no_migration_required(m_schema.compare(schema));
+                ObjectStore::verify_no_migration_required(m_schema->compare(schema));
                 set_schema(std::move(schema), version);
                 return true;
 
@@ -305,11 +358,18 @@ void Realm::update_schema(Schema schema, uint64_t version, MigrationFunction mig
     // We can't just begin the write transaction before checking anything because
     // that means that write transactions would block opening Realms in other processes
     if (read_schema_from_group_if_needed()) {
-        required_changes = m_schema.compare(schema);
+        required_changes = m_schema->compare(schema);
         if (no_changes_required())
             return;
     }
 
+    // The schema is shared with the coordinator and any other Realm instances
+    // on this path, so apply the changes to a private copy. It's published to
+    // m_schema immediately so that accessors used from within the migration
+    // see the updated column mappings.
+    auto mutable_schema = std::make_shared<Schema>(*m_schema);
+    m_schema = mutable_schema;
+
     bool additive = m_config.schema_mode == SchemaMode::Additive;
     if (migration_function && !additive) {
         auto wrapper = [&] {
@@ -319,19 +379,20 @@ void Realm::update_schema(Schema schema, uint64_t version, MigrationFunction mig
             // users shouldn't actually be able to write via the old realm
             old_realm->m_config.schema_mode = SchemaMode::ReadOnly;
 
-            migration_function(old_realm, shared_from_this(), m_schema);
+            migration_function(old_realm, shared_from_this(), *mutable_schema);
         };
-        ObjectStore::apply_schema_changes(read_group(), m_schema, m_schema_version,
+        ObjectStore::apply_schema_changes(read_group(), *mutable_schema, m_schema_version,
                                           schema, version, m_config.schema_mode, required_changes, wrapper);
     }
     else {
-        ObjectStore::apply_schema_changes(read_group(), m_schema, m_schema_version,
+        ObjectStore::apply_schema_changes(read_group(), *mutable_schema, m_schema_version,
                                           schema, version, m_config.schema_mode, required_changes);
         REALM_ASSERT_DEBUG(additive || (required_changes = ObjectStore::schema_from_group(read_group()).compare(schema)).empty());
     }
 
     commit_transaction();
-    m_coordinator->update_schema(m_schema, version);
+    m_schema_transaction_version = m_shared_group->get_version_of_current_transaction().version;
+    m_coordinator->update_schema(m_schema, version, m_schema_transaction_version);
 }
 
 void Realm::add_schema_change_handler()
@@ -339,10 +400,13 @@ void Realm::add_schema_change_handler()
     if (m_config.schema_mode == SchemaMode::Additive) {
         m_group->set_schema_change_notification_handler([&] {
             auto new_schema = ObjectStore::schema_from_group(read_group());
-            auto required_changes = m_schema.compare(new_schema);
+            auto required_changes = m_schema->compare(new_schema);
             ObjectStore::verify_valid_additive_changes(required_changes);
-            m_schema.copy_table_columns_from(new_schema);
-            m_coordinator->update_schema(m_schema, m_schema_version);
+            auto updated_schema = std::make_shared<Schema>(*m_schema);
+            updated_schema->copy_table_columns_from(new_schema);
+            m_schema = std::move(updated_schema);
+            m_coordinator->update_schema(m_schema, m_schema_version,
+                                         m_shared_group->get_version_of_current_transaction().version);
         });
     }
 }
@@ -352,10 +416,17 @@ static void check_read_write(Realm *realm)
     if (realm->config().read_only()) {
         throw InvalidTransactionException("Can't perform transactions on read-only Realms.");
     }
+    if (realm->is_frozen()) {
+        throw InvalidTransactionException("Can't perform transactions on frozen Realms.");
+    }
 }
 
 void Realm::verify_thread() const
 {
+    // Frozen Realms are immutable snapshots and may be read from any thread
+    if (m_frozen) {
+        return;
+    }
     if (m_thread_id != std::this_thread::get_id()) {
         throw IncorrectThreadException();
     }
@@ -376,6 +447,14 @@ bool Realm::is_in_transaction() const noexcept
     return m_shared_group->get_transact_stage() == SharedGroup::transact_Writing;
 }
 
+util::Optional<uint_fast64_t> Realm::current_transaction_version() const
+{
+    if (!m_group) {
+        return util::none;
+    }
+    return m_shared_group->get_version_of_current_transaction().version;
+}
+
 void Realm::begin_transaction()
 {
     check_read_write(this);
@@ -388,7 +467,24 @@ void Realm::begin_transaction()
     // make sure we have a read transaction
     read_group();
 
+    auto start = std::chrono::steady_clock::now();
     transaction::begin(*m_shared_group, m_binding_context.get(), m_config.schema_mode);
+    m_coordinator->record_begin_transaction_time(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+void Realm::async_begin_transaction(std::function<void ()> callback)
+{
+    check_read_write(this);
+    verify_thread();
+
+    m_async_begin_callbacks.push_back(std::move(callback));
+    // If a write transaction is already active the request is deferred until
+    // it ends (see commit_transaction() and cancel_transaction()), and if
+    // there are older queued callbacks a request is already outstanding
+    if (!is_in_transaction() && m_async_begin_callbacks.size() == 1u) {
+        m_coordinator->async_request_write_lock(*this);
+    }
 }
 
 void Realm::commit_transaction()
@@ -400,8 +496,16 @@ void Realm::commit_transaction()
         throw InvalidTransactionException("Can't commit a non-existing write transaction");
     }
 
+    auto start = std::chrono::steady_clock::now();
     transaction::commit(*m_shared_group, m_binding_context.get());
+    m_coordinator->record_commit_transaction_time(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    trace_notification_stage(NotificationTraceStage::Commit,
+                             m_shared_group->get_version_of_current_transaction().version);
     m_coordinator->send_commit_notifications();
+    if (!m_async_begin_callbacks.empty()) {
+        m_coordinator->async_request_write_lock(*this);
+    }
 }
 
 void Realm::cancel_transaction()
@@ -414,6 +518,9 @@ void Realm::cancel_transaction()
     }
 
     transaction::cancel(*m_shared_group, m_binding_context.get());
+    if (!m_async_begin_callbacks.empty()) {
+        m_coordinator->async_request_write_lock(*this);
+    }
 }
 
 void Realm::invalidate()
@@ -428,10 +535,51 @@ void Realm::invalidate()
         return;
     }
 
+    // Any deferred callbacks describe changes to the read transaction being
+    // discarded, so drop them rather than delivering them against whatever
+    // version the next read transaction lands on
+    m_deferred_notifiers.clear();
+
     m_shared_group->end_read();
     m_group = nullptr;
 }
 
+SharedRealm Realm::freeze()
+{
+    verify_thread();
+    if (is_closed()) {
+        throw std::logic_error("Can't freeze a closed Realm");
+    }
+    if (m_config.read_only()) {
+        throw std::logic_error("Can't freeze a read-only Realm (it is already immutable)");
+    }
+    if (is_in_transaction()) {
+        throw InvalidTransactionException("Can't freeze a Realm within a write transaction");
+    }
+
+    // Make sure there's a read transaction whose version we can pin
+    read_group();
+    auto version = m_shared_group->get_version_of_current_transaction();
+
+    Config config = m_config;
+    config.cache = false;
+    auto realm = m_coordinator->get_realm(std::move(config));
+    REALM_ASSERT(!realm->is_in_read_transaction());
+    realm->m_group = &const_cast<Group&>(realm->m_shared_group->begin_read(version));
+    realm->m_auto_refresh = false;
+    realm->m_frozen = true;
+
+    // Instantiate every table accessor up front: reads which materialize
+    // accessors lazily mutate shared state, which would need locking once
+    // the frozen Realm is shared between threads
+    auto& group = *realm->m_group;
+    for (size_t i = 0, count = group.size(); i < count; ++i) {
+        group.get_table(i);
+    }
+
+    return realm;
+}
+
 bool Realm::compact()
 {
     verify_thread();
@@ -439,13 +587,16 @@ bool Realm::compact()
     if (m_config.read_only()) {
         throw InvalidTransactionException("Can't compact a read-only Realm");
     }
+    if (m_frozen) {
+        throw InvalidTransactionException("Can't compact a frozen Realm");
+    }
     if (is_in_transaction()) {
         throw InvalidTransactionException("Can't compact a Realm within a write transaction");
     }
 
     Group& group = read_group();
-    for (auto &object_schema : m_schema) {
-        ObjectStore::table_for_object_type(group, object_schema.name)->optimize();
+    for (auto &object_schema : *m_schema) {
+        ObjectStore::table_for_object_type(group, object_schema)->optimize();
     }
     m_shared_group->end_read();
     m_group = nullptr;
@@ -467,21 +618,144 @@ void Realm::write_copy(StringData path, BinaryData key)
     }
 }
 
+namespace {
+// A streambuf which writes to a File in bounded chunks, reporting the running
+// byte count after each chunk is flushed. Group::write() produces the copy as
+// one long sequence of writes with no other hooks, so interposing on the
+// stream is the only place we can observe its progress.
+class ProgressStreambuf : public std::streambuf {
+public:
+    ProgressStreambuf(util::File& file, std::function<void (uint64_t)> const& progress)
+    : m_file(file)
+    , m_progress(progress)
+    {
+        setp(m_buffer.get(), m_buffer.get() + c_chunk_size);
+    }
+
+    void finish()
+    {
+        flush();
+    }
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        flush();
+        if (ch != traits_type::eof()) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return 0;
+    }
+
+private:
+    static const size_t c_chunk_size = 1024 * 1024;
+
+    void flush()
+    {
+        size_t count = pptr() - pbase();
+        if (count == 0) {
+            return;
+        }
+        m_file.write(pbase(), count);
+        m_bytes_written += count;
+        setp(m_buffer.get(), m_buffer.get() + c_chunk_size);
+        if (m_progress) {
+            m_progress(m_bytes_written);
+        }
+    }
+
+    util::File& m_file;
+    std::function<void (uint64_t)> const& m_progress;
+    std::unique_ptr<char[]> m_buffer = std::make_unique<char[]>(c_chunk_size);
+    uint64_t m_bytes_written = 0;
+};
+} // anonymous namespace
+
+void Realm::write_copy(StringData path, BinaryData key, std::function<void (uint64_t)> progress)
+{
+    if (key.data() && key.size() != 64) {
+        throw InvalidEncryptionKeyException();
+    }
+    verify_thread();
+    try {
+        if (key.data()) {
+            // The encryption layer encrypts whole pages as it writes the file
+            // itself, so an encrypted copy cannot be streamed through an
+            // arbitrary ostream and is produced in one shot.
+            read_group().write(path, key.data());
+            if (progress) {
+                progress(util::File(std::string(path)).get_size());
+            }
+            return;
+        }
+
+        util::File file(std::string(path), util::File::mode_Write);
+        ProgressStreambuf streambuf(file, progress);
+        std::ostream out(&streambuf);
+        read_group().write(out);
+        out.flush();
+        streambuf.finish();
+    }
+    catch (...) {
+        translate_file_exception(path);
+    }
+}
+
+bool Realm::version_lag_exceeded() const
+{
+    // Every version which some SharedGroup is still reading from pins a
+    // snapshot of the file, so a Realm which is slow to process
+    // notifications can make the file balloon during write storms. When a
+    // limit is configured, advance anyway once too many versions have
+    // accumulated; this coalesces all of this Realm's pins (and those of
+    // its notifiers) at a recent version so that the history can be trimmed.
+    return m_config.max_version_lag != 0
+        && m_shared_group->get_number_of_versions() > m_config.max_version_lag;
+}
+
 void Realm::notify()
 {
-    if (is_closed()) {
+    if (m_config.notification_delivery_budget_ms > 0) {
+        notify(std::chrono::steady_clock::now()
+               + std::chrono::milliseconds(m_config.notification_delivery_budget_ms));
+    }
+    else {
+        notify(std::chrono::steady_clock::time_point::max());
+    }
+}
+
+void Realm::notify(std::chrono::steady_clock::time_point deadline)
+{
+    // Frozen Realms are pinned to their version and never have anything to
+    // be notified about
+    if (is_closed() || m_frozen) {
         return;
     }
 
     verify_thread();
 
+    // Callbacks deferred by a previous deadline must be drained before the
+    // read transaction can move again, as their changesets describe the
+    // transition to the current version
+    if (!m_deferred_notifiers.empty()) {
+        auto deferred = std::move(m_deferred_notifiers);
+        m_deferred_notifiers.clear();
+        m_coordinator->finish_delivery(*this, std::move(deferred), deadline);
+        if (!m_deferred_notifiers.empty()) {
+            // The budget ran out again; a wakeup for the remainder has
+            // already been posted
+            return;
+        }
+    }
+
     if (m_shared_group->has_changed()) { // Throws
         if (m_binding_context) {
             m_binding_context->changes_available();
         }
-        if (m_auto_refresh) {
+        if (m_auto_refresh || version_lag_exceeded()) {
             if (m_group) {
-                m_coordinator->advance_to_ready(*this);
+                m_coordinator->advance_to_ready(*this, deadline);
             }
             else if (m_binding_context) {
                 m_binding_context->did_change({}, {});
@@ -489,7 +763,19 @@ void Realm::notify()
         }
     }
     else {
-        m_coordinator->process_available_async(*this);
+        m_coordinator->process_available_async(*this, deadline);
+    }
+
+    // If the write lock became available for an async_begin_transaction()
+    // request, begin the write transaction and invoke the next callback. The
+    // grant is consumed even if a write transaction is already active, in
+    // which case a new request is made when that transaction ends
+    if (m_coordinator->take_granted_write_request(this)
+        && !m_async_begin_callbacks.empty() && !is_in_transaction()) {
+        begin_transaction();
+        auto callback = std::move(m_async_begin_callbacks.front());
+        m_async_begin_callbacks.erase(m_async_begin_callbacks.begin());
+        callback();
     }
 }
 
@@ -503,13 +789,22 @@ bool Realm::refresh()
         return false;
     }
 
+    // Finish invoking any callbacks deferred by a notify() deadline before
+    // advancing, so that they run before their changesets go stale
+    if (!m_deferred_notifiers.empty()) {
+        auto deferred = std::move(m_deferred_notifiers);
+        m_deferred_notifiers.clear();
+        m_coordinator->finish_delivery(*this, std::move(deferred),
+                                       std::chrono::steady_clock::time_point::max());
+    }
+
     // advance transaction if database has changed
     if (!m_shared_group->has_changed()) { // Throws
         return false;
     }
 
     if (m_group) {
-        transaction::advance(*m_shared_group, m_binding_context.get(), m_config.schema_mode);
+        m_coordinator->advance_read(*this);
         m_coordinator->process_available_async(*this);
     }
     else {
@@ -520,9 +815,31 @@ bool Realm::refresh()
     return true;
 }
 
+bool Realm::enumerate_rows_in_parallel(StringData object_type,
+                                       std::function<void (Table const&, size_t begin, size_t end)> fn)
+{
+    verify_thread();
+    auto table = ObjectStore::table_for_object_type(read_group(), object_type);
+    if (!table) {
+        return false;
+    }
+
+    // The old Realm passed to migration functions is created outside of the
+    // coordinator, so look its coordinator up by path in that case
+    auto coordinator = m_coordinator;
+    if (!coordinator) {
+        coordinator = RealmCoordinator::get_existing_coordinator(m_config.path);
+    }
+    if (!coordinator) {
+        return false;
+    }
+    return coordinator->for_each_row_range_in_parallel(*this, table->get_index_in_group(),
+                                                       table->size(), fn);
+}
+
 bool Realm::can_deliver_notifications() const noexcept
 {
-    if (m_config.read_only()) {
+    if (m_config.read_only() || m_frozen) {
         return false;
     }
 
@@ -549,6 +866,7 @@ void Realm::close()
         m_coordinator->unregister_realm(this);
     }
 
+    m_deferred_notifiers.clear();
     m_group = nullptr;
     m_shared_group = nullptr;
     m_history = nullptr;
@@ -588,8 +906,7 @@ void Realm::HandoverPackage::advance_to_version(VersionID new_version)
 
     // Import handover, advance version, and then repackage for handover
     auto objects = realm->accept_handover(std::move(*this));
-    transaction::advance(*realm->m_shared_group, realm->m_binding_context.get(),
-                         realm->m_config.schema_mode, new_version);
+    coordinator.advance_read(*realm, new_version);
     *this = realm->package_for_handover(std::move(objects));
 }
 
@@ -621,6 +938,36 @@ Realm::HandoverPackage Realm::package_for_handover(std::vector<AnyThreadConfined
         handover.m_objects.push_back(object.export_for_handover());
     }
 
+    util::g_metric_counters.handover_packages.fetch_add(1, std::memory_order_relaxed);
+    return handover;
+}
+
+Realm::HandoverPackage Realm::package_objects_for_handover(std::vector<Object> const& objects_to_hand_over)
+{
+    verify_thread();
+    if (is_in_transaction()) {
+        throw InvalidTransactionException("Cannot package handover during a write transaction.");
+    }
+
+    HandoverPackage handover;
+    auto version_id = m_shared_group->pin_version();
+    handover.m_version_id = version_id;
+    handover.m_source_realm = shared_from_this();
+
+    // Row positions are stable for the pinned version, so a batch needs no
+    // per-object handover export -- just the table and its row indices
+    for (auto& object : objects_to_hand_over) {
+        REALM_ASSERT(object.realm().get() == this);
+        size_t table_ndx = object.row().get_table()->get_index_in_group();
+        auto it = std::find_if(begin(handover.m_object_batches), end(handover.m_object_batches),
+                               [&](auto& batch) { return batch.table_ndx == table_ndx; });
+        if (it == handover.m_object_batches.end()) {
+            handover.m_object_batches.push_back({object.get_object_schema().name, table_ndx, {}});
+            it = std::prev(handover.m_object_batches.end());
+        }
+        it->row_ndxs.push_back(object.row().get_index());
+    }
+
     return handover;
 }
 
@@ -655,8 +1002,7 @@ std::vector<AnyThreadConfined> Realm::accept_handover(Realm::HandoverPackage han
             handover.advance_to_version(current_version);
         } else {
             // We're behind, so advance to the handover's version
-            transaction::advance(*m_shared_group, m_binding_context.get(),
-                                 m_config.schema_mode, handover.m_version_id);
+            m_coordinator->advance_read(*this, handover.m_version_id);
             m_coordinator->process_available_async(*this);
         }
     }
@@ -667,6 +1013,16 @@ std::vector<AnyThreadConfined> Realm::accept_handover(Realm::HandoverPackage han
         objects.push_back(std::move(object).import_from_handover(shared_from_this()));
     }
 
+    // Expand row-position batches now that we're on the packaged version
+    for (auto &batch : handover.m_object_batches) {
+        auto object_schema = schema().find(batch.object_schema_name);
+        REALM_ASSERT_DEBUG(object_schema != schema().end());
+        TableRef table = read_group().get_table(batch.table_ndx);
+        for (auto row_ndx : batch.row_ndxs) {
+            objects.push_back(Object(shared_from_this(), *object_schema, table->get(row_ndx)));
+        }
+    }
+
     // Avoid weird partial-refresh semantics when importing old packages
     refresh();
 
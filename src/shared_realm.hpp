@@ -23,6 +23,7 @@
 
 #include <realm/util/optional.hpp>
 
+#include <chrono>
 #include <memory>
 #include <thread>
 
@@ -31,10 +32,13 @@ class AnyThreadConfined;
 class BinaryData;
 class BindingContext;
 class Group;
+class Object;
 class Realm;
 class Replication;
+class Results;
 class SharedGroup;
 class StringData;
+class Table;
 typedef std::shared_ptr<Realm> SharedRealm;
 typedef std::weak_ptr<Realm> WeakRealm;
 
@@ -43,6 +47,7 @@ namespace _impl {
     class CollectionNotifier;
     class ListNotifier;
     class RealmCoordinator;
+    class ResultsAggregateNotifier;
     class ResultsNotifier;
 }
 
@@ -135,6 +140,17 @@ public:
 
         bool read_only() const { return schema_mode == SchemaMode::ReadOnly; }
 
+        // If non-null, called with the Realm file's current size in bytes
+        // when the file is opened and this process has no other instances
+        // attached, and the file is compacted before the Realm is handed out
+        // if it returns true. This is the one point at which compaction is
+        // cheap to attempt, as the storage engine requires exclusive access
+        // and can't move a bounded amount of data per write transaction.
+        // The engine doesn't expose the size of the live data, so a policy
+        // like "compact when the file is mostly free space" needs the caller
+        // to supply its own estimate of the expected data size.
+        std::function<bool (uint64_t total_bytes)> should_compact_on_launch_function;
+
         // The following are intended for internal/testing purposes and
         // should not be publicly exposed in binding APIs
 
@@ -152,6 +168,68 @@ public:
         // everything can be done deterministically on one thread, and
         // speeds up tests that don't need notifications.
         bool automatic_change_notifications = true;
+
+        // Number of threads (including the calling thread) over which to
+        // spread evaluation of queries on large tables. Values less than
+        // two leave query evaluation single-threaded.
+        size_t parallel_query_thread_count = 0;
+
+        // Number of threads (including the background worker thread) over
+        // which to spread execution of collection notifiers. Values less
+        // than two run all notifiers serially on the worker thread.
+        size_t parallel_notifier_thread_count = 1;
+
+        // Number of threads (including the calling thread) over which to
+        // spread the per-row computation done via
+        // enumerate_rows_in_parallel(), typically from within a migration
+        // function. Values less than two make that helper decline to run.
+        size_t parallel_migration_thread_count = 0;
+
+        // The minimum amount of time between runs of the background notifier
+        // pipeline, in milliseconds. Each run advances to the latest version,
+        // so delaying a run lets bursts of commits collapse into a single
+        // diff computation against the newest version rather than re-running
+        // every query once per intermediate version. Zero (the default) runs
+        // the notifiers once per commit notification.
+        size_t notifier_coalescing_window_ms = 0;
+
+        // The maximum amount of time which notify() may spend invoking
+        // notification callbacks before deferring the remaining ones to the
+        // next iteration of the event loop, in milliseconds. After a burst
+        // of commits delivering every pending callback in one go can blow
+        // frame deadlines on UI threads; a non-zero value here bounds each
+        // pause. The budget is checked between callbacks rather than
+        // preempting them, so a single slow callback can still overrun it.
+        // Zero (the default) always delivers everything in one call.
+        size_t notification_delivery_budget_ms = 0;
+
+        // The maximum number of versions which this Realm is allowed to lag
+        // behind the newest version before notify() forcibly advances its
+        // read transaction even if auto-refresh is disabled. Each version
+        // held alive pins a snapshot of the file, so a consumer which is
+        // slow to process notifications can balloon the file size during
+        // write storms; a non-zero value here bounds that growth. Zero (the
+        // default) never forces an advance.
+        size_t max_version_lag = 0;
+
+        // Scheduling controls applied to the background threads working on
+        // behalf of this Realm's coordinator: the notifier thread, the
+        // write-lock waiter thread, and any parallel query/notifier pool
+        // threads. Both are entirely best-effort and ignored on platforms
+        // which don't support them.
+        //
+        // A positive niceness deprioritizes the worker threads relative to
+        // the rest of the process (e.g. to keep heavy diffing from stealing
+        // time from frame-critical threads) and a negative one prioritizes
+        // them. On Apple platforms, where thread priorities are expressed
+        // as QoS classes, positive maps to utility and negative to
+        // user-initiated.
+        int worker_thread_niceness = 0;
+        // If non-empty, pin the worker threads to the given CPU core
+        // indexes (e.g. to keep them on the little cores of a big.LITTLE
+        // processor). Not supported on Apple platforms, which don't allow
+        // pinning threads to cores.
+        std::vector<size_t> worker_thread_affinity;
     };
 
     // Get a cached Realm or create a new one if no cached copies exists
@@ -168,24 +246,93 @@ public:
     static uint64_t get_schema_version(Config const& config);
 
     Config const& config() const { return m_config; }
-    Schema const& schema() const { return m_schema; }
+    Schema const& schema() const { return *m_schema; }
     uint64_t schema_version() const { return m_schema_version; }
 
     void begin_transaction();
     void commit_transaction();
     void cancel_transaction();
+
+    // Queue a callback to be invoked on this Realm's thread via the event
+    // loop once the write lock is available, with a write transaction begun
+    // before the callback is invoked. Unlike begin_transaction() this does
+    // not block the calling thread while another thread or process holds the
+    // write lock for a long time. The callback can still block briefly if a
+    // different writer acquires the lock between it becoming available and
+    // the callback running. Callbacks are invoked one at a time, with each
+    // waiting for the previous one's write transaction to end.
+    void async_begin_transaction(std::function<void ()> callback);
     bool is_in_transaction() const noexcept;
     bool is_in_read_transaction() const { return !!m_group; }
 
+    // The version of the current read transaction, or none if the Realm is
+    // not in a read transaction. Usable as a cheap key for caching values
+    // derived from the data visible in the current transaction.
+    util::Optional<uint_fast64_t> current_transaction_version() const;
+
+    // Invoke `fn` over contiguous row ranges covering every row of
+    // `object_type` as visible in this Realm's current read transaction,
+    // spread over Config::parallel_migration_thread_count threads. Each
+    // invocation is given a private Table accessor reading from the same
+    // version, so the ranges can be processed concurrently.
+    //
+    // This is a helper for migrations which transform a large table: call it
+    // on the *old* Realm passed to the migration function to parallelize the
+    // expensive per-row computation (writing the computed values into
+    // per-range slots of a shared buffer), then apply the buffered values to
+    // the new Realm on the calling thread. Core's accessors are not thread
+    // safe and write transactions are confined to their thread, so the
+    // writes themselves cannot be spread over threads.
+    //
+    // Returns false without invoking `fn` if parallel execution is disabled
+    // or unavailable (e.g. the table is too small to be worth partitioning),
+    // in which case the caller should do the computation inline.
+    bool enumerate_rows_in_parallel(StringData object_type,
+                                    std::function<void (Table const&, size_t begin, size_t end)> fn);
+
     bool refresh();
     void set_auto_refresh(bool auto_refresh) { m_auto_refresh = auto_refresh; }
     bool auto_refresh() const { return m_auto_refresh; }
     void notify();
 
+    // As notify(), but stop invoking notification callbacks once `deadline`
+    // has passed. Callbacks which didn't fit in the budget are rescheduled
+    // onto the next iteration of the event loop (where they're again subject
+    // to the deadline passed to that notify() call), so everything is still
+    // delivered, just spread over multiple event loop iterations. Each
+    // notifier's callbacks see the changes for the version the Realm
+    // advanced to regardless of which iteration they run on.
+    void notify(std::chrono::steady_clock::time_point deadline);
+
     void invalidate();
     bool compact();
+
+    // Create an immutable snapshot of this Realm pinned to its current read
+    // version. The returned Realm skips thread-confinement checks entirely,
+    // so one frozen instance can be shared across a pool of reader threads
+    // without handover or per-thread Realm instances. Write transactions,
+    // refresh() and invalidate() all throw on a frozen Realm, notify() is a
+    // no-op, and notifications can't be registered, so its contents never
+    // change. Every table accessor is instantiated eagerly when freezing, as
+    // lock-free shared reads are only safe when nothing along the read paths
+    // is materialized lazily. Like any read transaction, the snapshot pins
+    // its version of the file until the frozen Realm is closed, so
+    // long-lived frozen Realms can balloon the file size during write
+    // storms.
+    SharedRealm freeze();
+    bool is_frozen() const noexcept { return m_frozen; }
     void write_copy(StringData path, BinaryData encryption_key);
 
+    // As above, but streams the copy to disk in bounded chunks, invoking
+    // `progress` with the number of bytes written so far after each chunk.
+    // The copy is made from this Realm's current read transaction, so it
+    // pins only that version and writers in other threads and processes
+    // proceed unhindered while it runs. When an encryption key is supplied
+    // the encryption layer writes the file in a single shot and `progress`
+    // is invoked just once, on completion.
+    void write_copy(StringData path, BinaryData encryption_key,
+                    std::function<void (uint64_t bytes_written)> progress);
+
     std::thread::id thread_id() const { return m_thread_id; }
     void verify_thread() const;
     void verify_in_write() const;
@@ -209,6 +356,12 @@ public:
     // Pins the current version and exports each object for handover.
     HandoverPackage package_for_handover(std::vector<AnyThreadConfined> objects_to_hand_over);
 
+    // Pins the current version once and packages a whole vector of objects
+    // as row positions against that version, avoiding the per-object
+    // SharedGroup handover export. Import with accept_handover() as usual;
+    // the imported objects come back grouped by object type.
+    HandoverPackage package_objects_for_handover(std::vector<Object> const& objects_to_hand_over);
+
     // Unpins the handover version, ending the current read transaction and beginning a new one at this version,
     // importing each object for handover.
     std::vector<AnyThreadConfined> accept_handover(Realm::HandoverPackage handover);
@@ -227,6 +380,7 @@ public:
     private:
         friend HandoverPackage Realm::package_for_handover(std::vector<AnyThreadConfined> objects_to_hand_over);
         friend std::vector<AnyThreadConfined> Realm::accept_handover(Realm::HandoverPackage handover);
+        friend HandoverPackage Realm::package_objects_for_handover(std::vector<Object> const& objects_to_hand_over);
 
         struct VersionID { // SharedGroup::VersionID without including header
             uint_fast64_t version;
@@ -246,8 +400,17 @@ public:
             }
         };
 
+        // A batch of same-type objects exported as row positions against
+        // the pinned version, avoiding a per-object handover export
+        struct ObjectBatch {
+            std::string object_schema_name;
+            size_t table_ndx;
+            std::vector<size_t> row_ndxs;
+        };
+
         VersionID m_version_id;
         std::vector<_impl::AnyHandover> m_objects;
+        std::vector<ObjectBatch> m_object_batches;
         SharedRealm m_source_realm; // Strong reference keeps alive so version stays pinned! Don't touch!!
 
         HandoverPackage() = default;
@@ -269,9 +432,11 @@ public:
     // without making it public to everyone
     class Internal {
         friend class AnyThreadConfined;
+        friend class Results;
         friend class _impl::CollectionNotifier;
         friend class _impl::ListNotifier;
         friend class _impl::RealmCoordinator;
+        friend class _impl::ResultsAggregateNotifier;
         friend class _impl::ResultsNotifier;
         friend class _impl::AnyHandover;
 
@@ -283,6 +448,13 @@ public:
         // coordinator to wake up the worker thread when a callback is
         // added, and coordinators need to be able to get themselves from a Realm
         static _impl::RealmCoordinator& get_coordinator(Realm& realm) { return *realm.m_coordinator; }
+
+        // The coordinator needs somewhere confined to the Realm's thread to
+        // park notifiers whose callbacks were deferred by a delivery deadline
+        static std::vector<std::shared_ptr<_impl::CollectionNotifier>>& get_deferred_notifiers(Realm& realm)
+        {
+            return realm.m_deferred_notifiers;
+        }
     };
 
     static void open_with_config(const Config& config,
@@ -298,6 +470,7 @@ private:
     Config m_config;
     std::thread::id m_thread_id = std::this_thread::get_id();
     bool m_auto_refresh = true;
+    bool m_frozen = false;
 
     std::unique_ptr<Replication> m_history;
     std::unique_ptr<SharedGroup> m_shared_group;
@@ -306,7 +479,11 @@ private:
     Group *m_group = nullptr;
 
     uint64_t m_schema_version;
-    Schema m_schema;
+    // The schema is shared with the coordinator and all other Realm instances
+    // on the same path rather than copied per-instance; the paths which
+    // mutate it (migrations and dynamic schema changes) work on a private
+    // copy which is shared anew once the update is complete. Never null.
+    std::shared_ptr<const Schema> m_schema = std::make_shared<Schema>();
     uint64_t m_schema_transaction_version = -1;
 
     std::shared_ptr<_impl::RealmCoordinator> m_coordinator;
@@ -323,6 +500,21 @@ private:
 
     void add_schema_change_handler();
 
+    // Check if the file has accumulated more versions than
+    // Config::max_version_lag allows, in which case the read transaction
+    // should be advanced even if auto-refresh is disabled
+    bool version_lag_exceeded() const;
+
+    // Callbacks queued by async_begin_transaction() which have not yet been
+    // invoked, in the order they were queued
+    std::vector<std::function<void ()>> m_async_begin_callbacks;
+
+    // Notifiers whose callbacks did not fit within a notify() delivery
+    // deadline. Their changesets describe the transition to the current read
+    // version, so they must be drained before the read transaction can be
+    // advanced again. Only accessed on this Realm's thread.
+    std::vector<std::shared_ptr<_impl::CollectionNotifier>> m_deferred_notifiers;
+
 public:
     std::unique_ptr<BindingContext> m_binding_context;
 
@@ -82,21 +82,32 @@ public:
 
     void notify()
     {
-        if (m_thread_has_looper) {
-            // Pass ourself over the pipe so that we can od work on the target
-            // thread. This requires forming a new shared_ptr to ensure we
-            // continue to exist until then.
-            auto ptr = new std::shared_ptr<EventLoopSignal>(this->shared_from_this());
-            if (write(m_message_pipe.write, &ptr, sizeof(ptr)) != sizeof(ptr)) {
-                delete ptr;
-                LOGE("Buffer overrun when writing to WeakRealmNotifier's ALooper message pipe.");
-            }
+        if (!m_thread_has_looper) {
+            return;
+        }
+        // Collapse notifications made between runs of the callback into a
+        // single write to the pipe, as the redundant wakeups each cost a
+        // syscall
+        if (m_signaled.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        // Pass ourself over the pipe so that we can od work on the target
+        // thread. This requires forming a new shared_ptr to ensure we
+        // continue to exist until then.
+        auto ptr = new std::shared_ptr<EventLoopSignal>(this->shared_from_this());
+        if (write(m_message_pipe.write, &ptr, sizeof(ptr)) != sizeof(ptr)) {
+            delete ptr;
+            m_signaled.store(false, std::memory_order_release);
+            LOGE("Buffer overrun when writing to WeakRealmNotifier's ALooper message pipe.");
         }
     }
 
 private:
     Callback m_callback;
     std::atomic<bool> m_thread_has_looper{false};
+    // Whether a wakeup has been scheduled which the callback has not yet
+    // run for
+    std::atomic<bool> m_signaled{false};
 
     // pipe file descriptor pair we use to signal ALooper
     struct {
@@ -109,6 +120,10 @@ private:
         if ((events & ALOOPER_EVENT_INPUT) != 0) {
             std::shared_ptr<EventLoopSignal>* ptr = nullptr;
             while (read(fd, &ptr, sizeof(ptr)) == sizeof(ptr)) {
+                // Clear the latch before invoking the callback so that
+                // notify() calls made while the callback is running schedule
+                // another run
+                (*ptr)->m_signaled.exchange(false, std::memory_order_acq_rel);
                 (*ptr)->m_callback();
                 delete ptr;
             }
@@ -26,15 +26,15 @@ class EventLoopSignal {
 public:
     EventLoopSignal(Callback&& callback)
     {
-        struct RefCountedRunloopCallback {
-            Callback callback;
-            std::atomic<size_t> ref_count;
-        };
-
         CFRunLoopSourceContext ctx{};
-        ctx.info = new RefCountedRunloopCallback{std::move(callback), {0}};
+        m_info = new RefCountedRunloopCallback{std::move(callback), {0}, {false}};
+        ctx.info = m_info;
         ctx.perform = [](void* info) {
-            static_cast<RefCountedRunloopCallback*>(info)->callback();
+            auto callback = static_cast<RefCountedRunloopCallback*>(info);
+            // Clear the latch before invoking the callback so that notify()
+            // calls made while the callback is running schedule another run
+            callback->signaled.exchange(false, std::memory_order_acq_rel);
+            callback->callback();
         };
         ctx.retain = [](const void* info) {
             static_cast<RefCountedRunloopCallback*>(const_cast<void*>(info))->ref_count.fetch_add(1, std::memory_order_relaxed);
@@ -67,6 +67,11 @@ public:
 
     void notify()
     {
+        // Collapse notifications made between runs of the callback into a
+        // single wakeup, as the redundant wakeups each cost a syscall
+        if (m_info->signaled.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
         CFRunLoopSourceSignal(m_signal);
         // Signalling the source makes it run the next time the runloop gets
         // to it, but doesn't make the runloop start if it's currently idle
@@ -75,8 +80,19 @@ public:
     }
 
 private:
+    struct RefCountedRunloopCallback {
+        Callback callback;
+        std::atomic<size_t> ref_count;
+        // Whether a wakeup has been scheduled which the callback has not yet
+        // run for
+        std::atomic<bool> signaled;
+    };
+
     CFRunLoopRef m_runloop;
     CFRunLoopSourceRef m_signal;
+    // Owned by the runloop source via the retain/release callbacks; valid
+    // for as long as m_signal is
+    RefCountedRunloopCallback* m_info;
 };
 } // namespace util
 } // namespace realm
@@ -21,7 +21,6 @@
 
 #include <atomic>
 #include <memory>
-#include <mutex>
 
 namespace realm {
 namespace _impl {
@@ -41,9 +40,10 @@ struct HasAtomicPtrOps<T, void_t<decltype(std::atomic_load(std::declval<T*>()))>
 
 namespace util {
 // A wrapper for std::shared_ptr that enables sharing a shared_ptr instance
-// (and not just a thing *pointed to* by a shared_ptr) between threads. Is
-// lock-free iff the underlying shared_ptr implementation supports atomic
-// operations. Currently the only implemented operation other than copy/move
+// (and not just a thing *pointed to* by a shared_ptr) between threads.
+// Lock-free on every platform: either via the stdlib's atomic shared_ptr
+// operations, or via the ownership-transfer fallback below when those are
+// missing. Currently the only implemented operation other than copy/move
 // construction/assignment is exchange().
 template<typename T, bool = _impl::HasAtomicPtrOps<std::shared_ptr<T>>::value>
 class AtomicSharedPtr;
@@ -80,55 +80,48 @@ private:
     std::shared_ptr<T> m_ptr = nullptr;
 };
 
+// Fallback for standard libraries which lack the atomic shared_ptr
+// operations (notably the Android NDK's). The shared_ptr is kept on the heap
+// and the atomic state is just a pointer to it: every supported operation
+// transfers ownership of the pointed-to shared_ptr with a single lock-free
+// pointer exchange, after which the calling thread is the only one which can
+// touch it. Copying is not supported, as it would require reading the
+// shared_ptr without taking ownership of it, which this scheme cannot do
+// safely; only the primary specialization is copyable.
 template<typename T>
 class AtomicSharedPtr<T, false> {
 public:
     AtomicSharedPtr() = default;
-    AtomicSharedPtr(std::shared_ptr<T> ptr) : m_ptr(std::move(ptr)) { }
-
-    AtomicSharedPtr(AtomicSharedPtr const& ptr)
-    {
-        std::lock_guard<std::mutex> lock(ptr.m_mutex);
-        m_ptr = ptr.m_ptr;
-    }
-    AtomicSharedPtr(AtomicSharedPtr&& ptr)
+    AtomicSharedPtr(std::shared_ptr<T> ptr)
+    : m_ptr(ptr ? new std::shared_ptr<T>(std::move(ptr)) : nullptr)
     {
-        std::lock_guard<std::mutex> lock(ptr.m_mutex);
-        m_ptr = std::move(ptr.m_ptr);
     }
 
-    AtomicSharedPtr& operator=(AtomicSharedPtr const& ptr)
+    ~AtomicSharedPtr()
     {
-        if (&ptr != this) {
-            // std::lock() ensures that these are locked in a consistent order
-            // to avoid deadlock
-            std::lock(m_mutex, ptr.m_mutex);
-            m_ptr = ptr.m_ptr;
-            m_mutex.unlock();
-            ptr.m_mutex.unlock();
-        }
-        return *this;
+        delete m_ptr.load();
     }
 
+    AtomicSharedPtr(AtomicSharedPtr const&) = delete;
+    AtomicSharedPtr& operator=(AtomicSharedPtr const&) = delete;
+
+    AtomicSharedPtr(AtomicSharedPtr&& ptr) : m_ptr(ptr.m_ptr.exchange(nullptr)) { }
+
     AtomicSharedPtr& operator=(AtomicSharedPtr&& ptr)
     {
-        std::lock(m_mutex, ptr.m_mutex);
-        m_ptr = std::move(ptr.m_ptr);
-        m_mutex.unlock();
-        ptr.m_mutex.unlock();
+        delete m_ptr.exchange(ptr.m_ptr.exchange(nullptr));
         return *this;
     }
 
     std::shared_ptr<T> exchange(std::shared_ptr<T> ptr)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_ptr.swap(ptr);
-        return ptr;
+        auto next = ptr ? new std::shared_ptr<T>(std::move(ptr)) : nullptr;
+        std::unique_ptr<std::shared_ptr<T>> prev(m_ptr.exchange(next));
+        return prev ? std::move(*prev) : nullptr;
     }
 
 private:
-    std::mutex m_mutex;
-    std::shared_ptr<T> m_ptr = nullptr;
+    std::atomic<std::shared_ptr<T>*> m_ptr = {nullptr};
 };
 
 }
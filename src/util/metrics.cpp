@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "util/metrics.hpp"
+
+namespace realm {
+namespace util {
+
+MetricCounters g_metric_counters;
+
+Metrics metrics() noexcept
+{
+    Metrics snapshot;
+    snapshot.notifier_runs = g_metric_counters.notifier_runs.load(std::memory_order_relaxed);
+    snapshot.transact_log_instructions = g_metric_counters.transact_log_instructions.load(std::memory_order_relaxed);
+    snapshot.index_set_chunk_splits = g_metric_counters.index_set_chunk_splits.load(std::memory_order_relaxed);
+    snapshot.table_view_rebuilds = g_metric_counters.table_view_rebuilds.load(std::memory_order_relaxed);
+    snapshot.handover_packages = g_metric_counters.handover_packages.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+} // namespace util
+} // namespace realm
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_UTIL_METRICS_HPP
+#define REALM_UTIL_METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace realm {
+namespace util {
+
+// A point-in-time snapshot of the process-wide hot-path counters, as
+// returned by metrics(). All counters are cumulative since process start
+// and never reset; callers which want rates should diff two snapshots.
+struct Metrics {
+    // Runs of the background notifier pipeline, across all open Realm files
+    uint64_t notifier_runs;
+    // Data-modification instructions observed while parsing transaction
+    // logs. Schema and table-selection instructions are dispatched to
+    // separate callbacks and are not included.
+    uint64_t transact_log_instructions;
+    // Chunk splits performed by IndexSet's chunked storage when an insertion
+    // lands in a full chunk
+    uint64_t index_set_chunk_splits;
+    // Full TableView rebuilds performed by query notifiers, i.e. times a
+    // query was completely re-run rather than being skipped as unchanged
+    uint64_t table_view_rebuilds;
+    // Handover packages created for passing thread-confined objects between
+    // threads, including those wrapped in handover channels
+    uint64_t handover_packages;
+};
+
+// Take a snapshot of the current counter values. Cheap enough to call from
+// every heartbeat; the counters are read individually with relaxed ordering,
+// so the snapshot is not an atomic cut across them.
+Metrics metrics() noexcept;
+
+// The live counters. These are always compiled in and incremented on their
+// hot paths with single relaxed atomic adds; anything more expensive than
+// that does not belong here.
+struct MetricCounters {
+    std::atomic<uint64_t> notifier_runs{0};
+    std::atomic<uint64_t> transact_log_instructions{0};
+    std::atomic<uint64_t> index_set_chunk_splits{0};
+    std::atomic<uint64_t> table_view_rebuilds{0};
+    std::atomic<uint64_t> handover_packages{0};
+};
+extern MetricCounters g_metric_counters;
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_METRICS_HPP
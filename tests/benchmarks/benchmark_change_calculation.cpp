@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include "impl/collection_change_builder.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// Produce the "after" row list for a diff of `size` rows in which
+// `shuffle_ratio` of the rows have changed position
+std::vector<size_t> shuffled_rows(size_t size, double shuffle_ratio, std::minstd_rand& rng)
+{
+    std::vector<size_t> rows(size);
+    for (size_t i = 0; i < size; ++i)
+        rows[i] = i;
+
+    size_t to_move = size_t(size * shuffle_ratio);
+    for (size_t i = 0; i < to_move; ++i)
+        std::swap(rows[rng() % size], rows[rng() % size]);
+    return rows;
+}
+
+void run_at(size_t size, double shuffle_ratio, size_t iterations)
+{
+    std::minstd_rand rng(42);
+    std::vector<size_t> old_rows(size);
+    for (size_t i = 0; i < size; ++i)
+        old_rows[i] = i;
+    auto new_rows = shuffled_rows(size, shuffle_ratio, rng);
+
+    auto name = "change_calculate_" + std::to_string(size) + "_shuffle_"
+              + std::to_string(int(shuffle_ratio * 100)) + "pct";
+    benchmarks::run(name.c_str(), iterations, [&] {
+        CollectionChangeBuilder::calculate(old_rows, new_rows,
+                                           [](size_t) { return false; },
+                                           util::none, true);
+    });
+}
+} // anonymous namespace
+
+void benchmark_change_calculation()
+{
+    run_at(1000, 0.0, 1000);
+    run_at(1000, 0.1, 200);
+    run_at(1000, 0.5, 100);
+    run_at(10000, 0.0, 100);
+    run_at(10000, 0.1, 20);
+    run_at(10000, 0.5, 10);
+    run_at(100000, 0.01, 5);
+
+    // The no-moves fast path used by sorted results which don't care about
+    // move information
+    std::minstd_rand rng(42);
+    std::vector<size_t> old_rows(10000);
+    for (size_t i = 0; i < old_rows.size(); ++i)
+        old_rows[i] = i;
+    auto new_rows = shuffled_rows(old_rows.size(), 0.5, rng);
+    benchmarks::run("change_calculate_10000_shuffle_50pct_no_moves", 100, [&] {
+        CollectionChangeBuilder::calculate(old_rows, new_rows,
+                                           [](size_t) { return false; },
+                                           util::none, false);
+    });
+}
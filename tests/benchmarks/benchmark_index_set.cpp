@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include "index_set.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace realm;
+
+void benchmark_index_set()
+{
+    // Deterministic input so that every run measures the same work
+    std::minstd_rand rng(42);
+    std::vector<size_t> random_indexes;
+    for (size_t i = 0; i < 10000; ++i)
+        random_indexes.push_back(rng() % 100000);
+
+    benchmarks::run("index_set_sequential_add", 1000, [] {
+        IndexSet set;
+        for (size_t i = 0; i < 10000; ++i)
+            set.add(i);
+    });
+
+    benchmarks::run("index_set_random_add", 200, [&] {
+        IndexSet set;
+        for (auto index : random_indexes)
+            set.add(index);
+    });
+
+    // The pattern produced by a storm of interleaved insertions and
+    // deletions arriving from the transaction log: every new index has to
+    // be shifted past the ones already recorded
+    benchmarks::run("index_set_shift_storm", 100, [&] {
+        IndexSet set;
+        for (auto index : random_indexes) {
+            set.insert_at(index % 10000);
+            set.add_shifted(index % 10000);
+        }
+    });
+
+    benchmarks::run("index_set_erase_storm", 100, [&] {
+        IndexSet set;
+        for (size_t i = 0; i < 10000; ++i)
+            set.add(i * 2);
+        for (auto index : random_indexes)
+            set.erase_at(index % 10000);
+    });
+
+    IndexSet to_shift_by;
+    for (size_t i = 0; i < 1000; ++i)
+        to_shift_by.add(i * 100);
+    benchmarks::run("index_set_add_shifted_by", 1000, [&] {
+        IndexSet set;
+        IndexSet values;
+        for (auto index : random_indexes)
+            values.add(index);
+        set.add_shifted_by(to_shift_by, values);
+    });
+}
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include "util/test_file.hpp"
+
+#include "object_store.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group.hpp>
+
+#include <string>
+
+using namespace realm;
+
+namespace {
+SharedRealm open_realm()
+{
+    static InMemoryTestFile config;
+    static bool initialized = false;
+    if (!initialized) {
+        config.cache = false;
+        config.automatic_change_notifications = false;
+        config.schema = Schema{
+            {"object", {
+                {"int", PropertyType::Int},
+                {"string", PropertyType::String},
+                {"double", PropertyType::Double},
+            }},
+        };
+        initialized = true;
+    }
+    return Realm::get_shared_realm(config);
+}
+} // anonymous namespace
+
+void benchmark_insertion()
+{
+    auto realm = open_realm();
+    auto table = realm->read_group().get_table("class_object");
+
+    // Per-object insertion as performed by Object::create: a row at a time,
+    // with each property set individually
+    benchmarks::run("insert_row_at_a_time_10000", 20, [&] {
+        realm->begin_transaction();
+        for (size_t i = 0; i < 10000; ++i) {
+            size_t row = table->add_empty_row();
+            table->set_int(0, row, int64_t(i));
+            table->set_string(1, row, "some moderately long string value");
+            table->set_double(2, row, double(i) * 1.5);
+        }
+        realm->cancel_transaction();
+    });
+
+    // Bulk insertion with the row allocation hoisted out of the loop, the
+    // best case for flat imports
+    benchmarks::run("insert_preallocated_10000", 20, [&] {
+        realm->begin_transaction();
+        size_t first = table->add_empty_row(10000);
+        for (size_t i = 0; i < 10000; ++i) {
+            table->set_int(0, first + i, int64_t(i));
+            table->set_string(1, first + i, "some moderately long string value");
+            table->set_double(2, first + i, double(i) * 1.5);
+        }
+        realm->cancel_transaction();
+    });
+
+    // The cost of the commit itself on top of the inserts
+    benchmarks::run("insert_and_commit_10000", 10, [&] {
+        realm->begin_transaction();
+        size_t first = table->add_empty_row(10000);
+        for (size_t i = 0; i < 10000; ++i)
+            table->set_int(0, first + i, int64_t(i));
+        realm->commit_transaction();
+
+        realm->begin_transaction();
+        table->clear();
+        realm->commit_transaction();
+    });
+}
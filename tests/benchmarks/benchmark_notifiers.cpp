@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include "util/test_file.hpp"
+
+#include "impl/realm_coordinator.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+// One full notification cycle: a commit, a run of the background notifier
+// pipeline against it, and delivery to the target Realm
+void run_cycle(size_t row_count, size_t query_count, size_t iterations)
+{
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto table = realm->read_group().get_table("class_object");
+
+    realm->begin_transaction();
+    table->add_empty_row(row_count);
+    for (size_t i = 0; i < row_count; ++i)
+        table->set_int(0, i, int64_t(i));
+    realm->commit_transaction();
+
+    std::vector<Results> results;
+    std::vector<NotificationToken> tokens;
+    for (size_t i = 0; i < query_count; ++i) {
+        results.push_back(Results(realm, table->where().greater(0, int64_t(i))));
+        tokens.push_back(results.back().add_notification_callback(
+            [](CollectionChangeSet, std::exception_ptr) { }));
+    }
+    coordinator->on_change();
+    realm->notify();
+
+    size_t i = 0;
+    auto name = "notifier_cycle_" + std::to_string(row_count) + "_rows_"
+              + std::to_string(query_count) + "_queries";
+    benchmarks::run(name.c_str(), iterations, [&] {
+        realm->begin_transaction();
+        table->set_int(0, i++ % row_count, 0);
+        realm->commit_transaction();
+
+        coordinator->on_change();
+        realm->notify();
+    });
+}
+} // anonymous namespace
+
+void benchmark_notifiers()
+{
+    run_cycle(1000, 1, 100);
+    run_cycle(1000, 10, 50);
+    run_cycle(10000, 1, 50);
+    run_cycle(10000, 10, 10);
+    run_cycle(100000, 1, 10);
+}
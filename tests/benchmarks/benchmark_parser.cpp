@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include "parser/parser.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+// Pull the predicate strings out of the query.json test corpus. The corpus
+// is JSON, but its test entries are one per line with a fixed shape
+// (["QueryCount", count, "Type", "predicate", args] and similar), so the
+// predicate is always the third quoted string on the line and a full JSON
+// parser isn't needed.
+std::vector<std::string> read_corpus_predicates(const char* path)
+{
+    std::vector<std::string> predicates;
+    std::ifstream input(path);
+    std::string line;
+    while (std::getline(input, line)) {
+        std::vector<std::string> strings;
+        for (size_t i = 0; i < line.size() && strings.size() < 3; ++i) {
+            if (line[i] != '"')
+                continue;
+            std::string value;
+            for (++i; i < line.size() && line[i] != '"'; ++i) {
+                if (line[i] == '\\' && i + 1 < line.size())
+                    ++i;
+                value += line[i];
+            }
+            strings.push_back(std::move(value));
+        }
+        if (strings.size() < 3)
+            continue;
+        if (strings[0] != "QueryCount" && strings[0] != "ObjectSet" && strings[0] != "QueryThrows")
+            continue;
+        // Some QueryThrows entries are invalid at the parse level rather
+        // than the build level; the parse benchmark only wants the former
+        try {
+            parser::parse(strings[2]);
+        }
+        catch (...) {
+            continue;
+        }
+        predicates.push_back(std::move(strings[2]));
+    }
+    return predicates;
+}
+} // anonymous namespace
+
+void benchmark_parser()
+{
+    auto corpus = read_corpus_predicates(REALM_BENCHMARK_TEST_DIR "/query.json");
+    if (!corpus.empty()) {
+        benchmarks::run("parse_corpus", 200, corpus.size(), [&] {
+            for (auto& predicate : corpus)
+                parser::parse(predicate);
+        });
+    }
+
+    benchmarks::run("parse_simple_comparison", 10000, [] {
+        parser::parse("age > 25");
+    });
+
+    benchmarks::run("parse_compound_predicate", 5000, [] {
+        parser::parse("age > 25 && (name == 'George' || name BEGINSWITH 'Geo') && height < 1.8");
+    });
+
+    benchmarks::run("parse_keypath_traversal", 5000, [] {
+        parser::parse("dog.owner.address.city CONTAINS 'town' && dog.age >= 3");
+    });
+
+    // A deeply nested predicate of the sort produced by query builders
+    std::string nested = "a == 1";
+    for (int i = 0; i < 20; ++i)
+        nested = "(" + nested + " || b == " + std::to_string(i) + ")";
+    benchmarks::run("parse_deeply_nested", 1000, [&] {
+        parser::parse(nested);
+    });
+}
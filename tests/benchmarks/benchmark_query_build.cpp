@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include "util/test_file.hpp"
+
+#include "parser/parser.hpp"
+#include "parser/query_builder.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group.hpp>
+
+#include <string>
+
+using namespace realm;
+
+namespace {
+// Argument values for parameterized predicates; the values themselves don't
+// matter for measuring query construction
+struct FixedArguments : query_builder::Arguments {
+    bool bool_for_argument(size_t) override { return true; }
+    long long long_for_argument(size_t i) override { return static_cast<long long>(i); }
+    float float_for_argument(size_t i) override { return float(i); }
+    double double_for_argument(size_t i) override { return double(i); }
+    std::string string_for_argument(size_t) override { return "some string"; }
+    std::string binary_for_argument(size_t) override { return ""; }
+    Timestamp timestamp_for_argument(size_t) override { return Timestamp(0, 0); }
+    size_t object_index_for_argument(size_t) override { return 0; }
+    bool is_argument_null(size_t) override { return false; }
+};
+} // anonymous namespace
+
+void benchmark_query_build()
+{
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"age", PropertyType::Int},
+            {"height", PropertyType::Double},
+            {"name", PropertyType::String},
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto table = realm->read_group().get_table("class_object");
+    auto& schema = realm->schema();
+    FixedArguments args;
+
+    auto parse_and_build = [&](const char* name, size_t iterations, std::string const& predicate) {
+        benchmarks::run(name, iterations, [&] {
+            auto parsed = parser::parse(predicate);
+            Query query = table->where();
+            query_builder::apply_predicate(query, parsed, args, schema, "object");
+        });
+    };
+
+    parse_and_build("parse_and_build_simple", 10000,
+                    "age > 25");
+    parse_and_build("parse_and_build_compound", 5000,
+                    "age > 25 && (name == 'George' || name BEGINSWITH 'Geo') && height < 1.8");
+
+    // A predicate with many distinct arguments, as produced by bindings
+    // which parameterize every literal
+    std::string many_arguments = "age > $0";
+    for (int i = 1; i < 32; ++i)
+        many_arguments += " || age > $" + std::to_string(i);
+    parse_and_build("parse_and_build_arguments_32", 2000, many_arguments);
+
+    // A deeply nested predicate of the sort produced by query builders
+    std::string nested = "age == 1";
+    for (int i = 0; i < 20; ++i)
+        nested = "(" + nested + " || height == " + std::to_string(i) + ")";
+    parse_and_build("parse_and_build_deeply_nested", 1000, nested);
+
+    // Re-applying a predicate compiled once with fresh argument values, the
+    // upper bound for what a predicate cache can save over parse-and-build
+    query_builder::PreparedQuery prepared(parser::parse(many_arguments), schema, "object");
+    benchmarks::run("prepared_apply_arguments_32", 2000, [&] {
+        Query query = table->where();
+        prepared.apply(query, args);
+    });
+}
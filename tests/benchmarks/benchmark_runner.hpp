@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_BENCHMARK_RUNNER_HPP
+#define REALM_BENCHMARK_RUNNER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace benchmarks {
+
+// Total number of heap allocations made by the process, maintained by the
+// operator new replacements in main.cpp
+extern std::atomic<uint64_t> allocation_count;
+
+// Run `fn` `iterations` times after one untimed warm-up run and print one
+// CSV row (benchmark,iterations,total_us,us_per_iteration,per_second,
+// allocs_per_iteration) to stdout. `units_per_iteration` scales the
+// per_second column for benchmarks where one iteration processes a batch of
+// units (e.g. one pass over a query corpus). Iteration counts are fixed per
+// benchmark rather than adaptive so that the output of two builds can be
+// diffed row-by-row.
+template<typename Fn>
+void run(const char* name, size_t iterations, size_t units_per_iteration, Fn&& fn)
+{
+    fn();
+
+    auto allocs_before = allocation_count.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+        fn();
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    auto allocs = allocation_count.load(std::memory_order_relaxed) - allocs_before;
+
+    double per_second = total_us > 0 ? iterations * units_per_iteration / (total_us / 1e6) : 0;
+    std::printf("%s,%zu,%lld,%.3f,%.0f,%.1f\n", name, iterations,
+                static_cast<long long>(total_us), double(total_us) / iterations,
+                per_second, double(allocs) / iterations);
+    std::fflush(stdout);
+}
+
+template<typename Fn>
+void run(const char* name, size_t iterations, Fn&& fn)
+{
+    run(name, iterations, 1, static_cast<Fn&&>(fn));
+}
+
+} // namespace benchmarks
+
+#endif /* REALM_BENCHMARK_RUNNER_HPP */
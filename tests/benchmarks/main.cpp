@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "benchmark_runner.hpp"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<uint64_t> benchmarks::allocation_count{0};
+
+// Replace the global allocation functions with counting versions so that the
+// runner can report allocations per iteration alongside the timings
+void* operator new(size_t size)
+{
+    benchmarks::allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void benchmark_index_set();
+void benchmark_change_calculation();
+void benchmark_insertion();
+void benchmark_parser();
+void benchmark_query_build();
+void benchmark_notifiers();
+
+int main()
+{
+    std::printf("benchmark,iterations,total_us,us_per_iteration,per_second,allocs_per_iteration\n");
+
+    benchmark_index_set();
+    benchmark_change_calculation();
+    benchmark_insertion();
+    benchmark_parser();
+    benchmark_query_build();
+    benchmark_notifiers();
+
+    return 0;
+}
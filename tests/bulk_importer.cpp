@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+#include "util/test_file.hpp"
+
+#include "impl/bulk_importer.hpp"
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/group.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+TEST_CASE("BulkImporter") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema_version = 0;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false},
+            {"name", PropertyType::String, "", "", false, false, false},
+        }},
+        {"linking", {
+            {"link", PropertyType::Object, "object", "", false, false, true},
+        }},
+    };
+    auto realm = Realm::get_shared_realm(config);
+    auto& object_schema = *realm->schema().find("object");
+
+    SECTION("imports every produced row across multiple buffers and transactions") {
+        _impl::BulkImporter importer(realm, object_schema, 16, 64);
+        size_t produced = 0;
+        auto total = importer.import([&](std::vector<_impl::ImportRow>& buffer) {
+            for (size_t i = 0; i < 16 && produced < 200; ++i, ++produced) {
+                _impl::ImportRow row(2);
+                row[0].int_value = int64_t(produced);
+                row[1].string_value = "row " + std::to_string(produced);
+                buffer.push_back(std::move(row));
+            }
+            return produced < 200;
+        });
+        REQUIRE(total == 200);
+        REQUIRE_FALSE(realm->is_in_transaction());
+
+        auto table = realm->read_group().get_table("class_object");
+        REQUIRE(table->size() == 200);
+        REQUIRE(table->get_int(0, 199) == 199);
+        REQUIRE(table->get_string(1, 42) == "row 42");
+    }
+
+    SECTION("rolls back the open chunk and rethrows when the producer throws") {
+        _impl::BulkImporter importer(realm, object_schema, 8, 1000);
+        bool first = true;
+        REQUIRE_THROWS_AS(importer.import([&](std::vector<_impl::ImportRow>& buffer) -> bool {
+            if (!first)
+                throw std::runtime_error("parse error");
+            first = false;
+            buffer.push_back(_impl::ImportRow(2));
+            return true;
+        }), std::runtime_error);
+        REQUIRE_FALSE(realm->is_in_transaction());
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 0);
+    }
+
+    SECTION("rejects types with non-scalar properties") {
+        auto& linking_schema = *realm->schema().find("linking");
+        REQUIRE_THROWS_AS(_impl::BulkImporter(realm, linking_schema, 8, 64), std::logic_error);
+    }
+
+    SECTION("rejects importing inside an existing write transaction") {
+        _impl::BulkImporter importer(realm, object_schema, 8, 64);
+        realm->begin_transaction();
+        REQUIRE_THROWS_AS(importer.import([](std::vector<_impl::ImportRow>&) { return false; }),
+                          std::logic_error);
+        realm->cancel_transaction();
+    }
+}
@@ -81,6 +81,23 @@ TEST_CASE("collection_change: modify()") {
         c.modify(5);
         REQUIRE_INDICES(c.modifications, 5);
     }
+
+    SECTION("marks the modified column when one is given") {
+        c.modify(5, 2);
+        REQUIRE_INDICES(c.modifications, 5);
+        REQUIRE(c.columns.size() == 3);
+        REQUIRE(c.columns[0].empty());
+        REQUIRE(c.columns[1].empty());
+        REQUIRE_INDICES(c.columns[2], 5);
+    }
+
+    SECTION("unions column modifications from separate calls") {
+        c.modify(5, 1);
+        c.modify(8, 1);
+        c.modify(8, 0);
+        REQUIRE_INDICES(c.columns[0], 8);
+        REQUIRE_INDICES(c.columns[1], 5, 8);
+    }
 }
 
 TEST_CASE("collection_change: erase()") {
@@ -124,6 +141,14 @@ TEST_CASE("collection_change: erase()") {
         REQUIRE_INDICES(c.deletions, 4);
     }
 
+    SECTION("removes and shifts previous column-level modifications") {
+        c.modify(5, 0);
+        c.modify(6, 1);
+        c.erase(5);
+        REQUIRE(c.columns[0].empty());
+        REQUIRE_INDICES(c.columns[1], 5);
+    }
+
     SECTION("removes previous moves to the row being erased") {
         c.moves = {{10, 5}};
         c.erase(5);
@@ -240,6 +265,46 @@ TEST_CASE("collection_change: move_over()") {
     }
 }
 
+TEST_CASE("collection_change: collapse to reload") {
+    _impl::CollectionChangeBuilder c;
+
+    // Delete rows 0-69999 of a 150,000 row collection one at a time, which
+    // passes the threshold past which individual moves are no longer tracked
+    size_t size = 150000;
+    for (size_t i = 0; i < 70000; ++i)
+        c.move_over(i, --size);
+
+    SECTION("degrades to a whole-collection delete and reinsert") {
+        c.parse_complete();
+
+        REQUIRE(c.deletions.count() == 150000);
+        REQUIRE(c.deletions.count(0, 150000) == 150000);
+        REQUIRE(c.insertions.count() == 80000);
+        REQUIRE(c.insertions.count(0, 80000) == 80000);
+        REQUIRE(c.moves.empty());
+        REQUIRE(c.modifications.empty());
+    }
+
+    SECTION("continues to track the collection's size while collapsed") {
+        c.insert(0, 5);
+        c.erase(10);
+        c.modify(3);
+        c.parse_complete();
+
+        REQUIRE(c.deletions.count() == 150000);
+        REQUIRE(c.insertions.count() == 80004);
+        REQUIRE(c.modifications.empty());
+    }
+
+    SECTION("clearing while collapsed reports no insertions") {
+        c.clear(0);
+        c.parse_complete();
+
+        REQUIRE(c.deletions.count() == 150000);
+        REQUIRE(c.insertions.empty());
+    }
+}
+
 TEST_CASE("collection_change: clear()") {
     _impl::CollectionChangeBuilder c;
 
@@ -885,6 +950,58 @@ TEST_CASE("collection_change: calculate() sorted") {
             }
         }
     }
+
+    SECTION("falls back to delete+insert for very large reorderings") {
+        const size_t size = 20001;
+        std::vector<size_t> prev(size), next(size);
+        for (size_t i = 0; i < size; ++i) {
+            prev[i] = i;
+            next[i] = size - 1 - i;
+        }
+        c = _impl::CollectionChangeBuilder::calculate(prev, next, none_modified);
+        REQUIRE(c.deletions.count() == size);
+        REQUIRE(c.insertions.count() == size);
+        REQUIRE(c.moves.empty());
+    }
+
+    SECTION("handles inputs large enough to be diffed in parallel") {
+        std::vector<size_t> prev(120000), next;
+        for (size_t i = 0; i < prev.size(); ++i)
+            prev[i] = i;
+        next = prev;
+        next.push_back(next.size());
+        c = _impl::CollectionChangeBuilder::calculate(prev, next, none_modified);
+        REQUIRE_INDICES(c.insertions, 120000);
+        REQUIRE(c.deletions.empty());
+    }
+
+    SECTION("still detects moves within a small window of a large collection") {
+        std::vector<size_t> prev(20000), next;
+        for (size_t i = 0; i < prev.size(); ++i)
+            prev[i] = i;
+        next = prev;
+        std::swap(next[0], next[1]);
+        c = _impl::CollectionChangeBuilder::calculate(prev, next, none_modified);
+        REQUIRE_INDICES(c.deletions, 1);
+        REQUIRE_INDICES(c.insertions, 0);
+    }
+
+    SECTION("reports moved rows as a delete and insert when move tracking is disabled") {
+        // The entire window of rows which changed position is reported as
+        // deleted and reinserted
+        c = _impl::CollectionChangeBuilder::calculate({1, 2, 3}, {2, 3, 1}, none_modified,
+                                                      util::none, false);
+        REQUIRE(c.moves.empty());
+        REQUIRE_INDICES(c.deletions, 0, 1, 2);
+        REQUIRE_INDICES(c.insertions, 0, 1, 2);
+
+        // Rows before and after that window are not reported
+        c = _impl::CollectionChangeBuilder::calculate({1, 2, 3}, {1, 3, 2}, none_modified,
+                                                      util::none, false);
+        REQUIRE(c.moves.empty());
+        REQUIRE_INDICES(c.deletions, 1, 2);
+        REQUIRE_INDICES(c.insertions, 1, 2);
+    }
 }
 
 TEST_CASE("collection_change: merge()") {
@@ -1017,6 +1134,15 @@ TEST_CASE("collection_change: merge()") {
         REQUIRE_INDICES(c.modifications, 1, 2, 3);
     }
 
+    SECTION("leaves the old changeset's structure untouched for modification-only merges") {
+        c = {{1, 2}, {4, 5}, {6}, {{8, 9}}};
+        c.merge({{}, {}, {3, 6}});
+        REQUIRE_INDICES(c.deletions, 1, 2, 8);
+        REQUIRE_INDICES(c.insertions, 4, 5, 9);
+        REQUIRE_INDICES(c.modifications, 3, 6);
+        REQUIRE_MOVES(c, {8, 9});
+    }
+
     SECTION("tracks modifications for previous moves") {
         c = {{}, {}, {}, {{1, 2}}};
         c.merge({{}, {}, {2, 3}});
@@ -1139,4 +1265,28 @@ TEST_CASE("collection_change: merge()") {
         REQUIRE_INDICES(c.modifications, 0);
         REQUIRE(c.moves.empty());
     }
+
+    SECTION("unions column-level modifications and shifts them like modifications") {
+        c.modify(5, 0);
+
+        _impl::CollectionChangeBuilder c2;
+        c2.erase(2);
+        c2.insert(1);
+        c2.modify(6, 1);
+        c.merge(std::move(c2));
+
+        REQUIRE_INDICES(c.columns[0], 5);
+        REQUIRE_INDICES(c.columns[1], 6);
+    }
+
+    SECTION("updates column-level modifications for rows moved by the new changeset") {
+        c.modify(5, 1);
+
+        _impl::CollectionChangeBuilder c2;
+        c2.move(5, 0);
+        c.merge(std::move(c2));
+
+        REQUIRE_INDICES(c.modifications, 0);
+        REQUIRE_INDICES(c.columns[1], 0);
+    }
 }
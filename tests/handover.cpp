@@ -25,6 +25,7 @@
 #include "object_schema.hpp"
 #include "property.hpp"
 #include "schema.hpp"
+#include "handover_channel.hpp"
 #include "thread_confined.hpp"
 
 #include <realm/history.hpp>
@@ -299,6 +300,39 @@ TEST_CASE("handover") {
             REQUIRE(num.row().get_int(0) == 42);
         }
 
+        SECTION("object batch") {
+            r->begin_transaction();
+            Object str = create_object(r, string_object);
+            Object num0 = create_object(r, int_object);
+            Object num1 = create_object(r, int_object);
+            num0.row().set_int(0, 7);
+            num1.row().set_int(0, 42);
+            r->commit_transaction();
+
+            auto h = r->package_objects_for_handover({str, num0, num1});
+            std::thread([h = std::move(h), config]() mutable {
+                SharedRealm r = Realm::get_shared_realm(config);
+                auto h_import = r->accept_handover(std::move(h));
+                REQUIRE(h_import.size() == 3);
+
+                // imported objects come back grouped by object type
+                Object str = h_import[0].get_object();
+                Object num0 = h_import[1].get_object();
+                Object num1 = h_import[2].get_object();
+                REQUIRE(str.get_object_schema().name == "string_object");
+                REQUIRE(str.row().get_string(0).is_null());
+                REQUIRE(num0.row().get_int(0) == 7);
+                REQUIRE(num1.row().get_int(0) == 42);
+
+                r->begin_transaction();
+                num0.row().set_int(0, 8);
+                r->commit_transaction();
+            }).join();
+
+            r->refresh();
+            REQUIRE(num0.row().get_int(0) == 8);
+        }
+
         SECTION("array") {
             r->begin_transaction();
             Object zero = create_object(r, int_object);
@@ -459,4 +493,47 @@ TEST_CASE("handover") {
         r->accept_handover(std::move(h));
         REQUIRE_THROWS(r->accept_handover(std::move(h)));
     }
+
+    SECTION("channel") {
+        r->begin_transaction();
+        Object num = create_object(r, int_object);
+        r->commit_transaction();
+
+        HandoverChannel channel;
+
+        SECTION("can be sent through repeatedly") {
+            for (int i = 0; i < 3; ++i) {
+                r->begin_transaction();
+                num.row().set_int(0, i);
+                r->commit_transaction();
+
+                channel.send(r, {num});
+                std::thread([&channel, config, i]() {
+                    SharedRealm r = Realm::get_shared_realm(config);
+                    auto batch = channel.receive(r);
+                    REQUIRE(batch);
+                    REQUIRE(batch->size() == 1);
+                    REQUIRE((*batch)[0].get_object().row().get_int(0) == i);
+                }).join();
+            }
+        }
+
+        SECTION("returns none when nothing has been sent") {
+            REQUIRE_FALSE(channel.receive(r));
+        }
+
+        SECTION("a superseded batch is replaced by the newer one") {
+            channel.send(r, {num});
+
+            r->begin_transaction();
+            num.row().set_int(0, 17);
+            r->commit_transaction();
+            channel.send(r, {num});
+
+            auto batch = channel.receive(r);
+            REQUIRE(batch);
+            REQUIRE((*batch)[0].get_object().row().get_int(0) == 17);
+            REQUIRE_FALSE(channel.receive(r));
+        }
+    }
 }
@@ -19,6 +19,7 @@
 #include "catch.hpp"
 
 #include "index_set.hpp"
+#include "util/metrics.hpp"
 
 #include "util/index_helpers.hpp"
 
@@ -46,6 +47,47 @@ TEST_CASE("index_set: contains()") {
     }
 }
 
+TEST_CASE("index_set: contains_each()") {
+    std::vector<bool> results;
+
+    SECTION("produces the same answers as contains() for each index") {
+        realm::IndexSet set = {1, 2, 5};
+        set.contains_each({0, 1, 2, 3, 4, 5, 6}, results);
+        REQUIRE(results == std::vector<bool>({false, true, true, false, false, true, false}));
+    }
+
+    SECTION("handles indexes entirely before or after the set") {
+        realm::IndexSet set = {3, 4};
+        set.contains_each({0, 1, 7, 8}, results);
+        REQUIRE(results == std::vector<bool>({false, false, false, false}));
+    }
+
+    SECTION("handles an empty set and empty queries") {
+        realm::IndexSet set;
+        set.contains_each({1, 2, 3}, results);
+        REQUIRE(results == std::vector<bool>({false, false, false}));
+
+        set = {1, 2};
+        set.contains_each({}, results);
+        REQUIRE(results.empty());
+    }
+
+    SECTION("matches contains() when the set spans multiple chunks") {
+        realm::IndexSet set;
+        for (size_t i = 0; i < realm::_impl::ChunkedRangeVector::max_size * 4; ++i)
+            set.add(i * 2);
+
+        std::vector<size_t> indexes;
+        for (size_t i = 0; i < realm::_impl::ChunkedRangeVector::max_size * 8; ++i)
+            indexes.push_back(i);
+
+        set.contains_each(indexes, results);
+        REQUIRE(results.size() == indexes.size());
+        for (size_t i = 0; i < indexes.size(); ++i)
+            REQUIRE(results[i] == set.contains(indexes[i]));
+    }
+}
+
 TEST_CASE("index_set: count()") {
     SECTION("returns the number of indices in the set in the given range") {
         realm::IndexSet set = {1, 2, 3, 5};
@@ -89,6 +131,21 @@ TEST_CASE("index_set: count()") {
             REQUIRE(set.count(0, i) == (i + 1) / 3 + (i + 2) / 3);
         }
     }
+
+    SECTION("remains correct when queries are interleaved with mutations") {
+        realm::IndexSet set = {1, 3, 5};
+        REQUIRE(set.count() == 3);
+        set.add(7);
+        REQUIRE(set.count() == 4);
+        set.remove(3);
+        REQUIRE(set.count() == 3);
+        REQUIRE(set.count(0, 6) == 2);
+        set.erase_at(5);
+        REQUIRE(set.count() == 2);
+        set.insert_at(0);
+        REQUIRE(set.count() == 3);
+        REQUIRE(set.count(0, 3) == 2);
+    }
 }
 
 TEST_CASE("index_set: add()") {
@@ -149,6 +206,27 @@ TEST_CASE("index_set: add()") {
         set.add(set2);
         REQUIRE(set.count() == 30);
     }
+
+    SECTION("correctly handles dense sets spanning many chunks") {
+        // Alternating indexes so that no ranges can be merged, producing the
+        // maximum number of chunks for the number of indexes added
+        for (size_t i = 0; i < 1000; ++i)
+            set.add(i * 2);
+        REQUIRE(set.count() == 1000);
+
+        // Additions at the front, in the middle and at the end of the chunk
+        // list must all find the correct chunk
+        set.add(1001);
+        REQUIRE(set.count() == 1001);
+        REQUIRE(set.contains(1001));
+        REQUIRE(!set.contains(999));
+
+        // 1001 should have merged with the ranges on either side of it
+        auto it = std::find_if(set.begin(), set.end(),
+                               [](auto range) { return range.first == 1000; });
+        REQUIRE(it != set.end());
+        REQUIRE(it->second == 1003);
+    }
 }
 
 TEST_CASE("index_set: add_shifted()") {
@@ -320,6 +398,12 @@ TEST_CASE("index_set: insert_at()") {
         set.insert_at({5, 10});
         REQUIRE_INDICES(set, 5, 6, 10, 12);
     }
+
+    SECTION("extends the last range when appending a position adjacent to it") {
+        set = {3, 4};
+        set.insert_at({5, 6, 9});
+        REQUIRE_INDICES(set, 3, 4, 5, 6, 9);
+    }
 }
 
 TEST_CASE("index_set: shift_for_insert_at()") {
@@ -406,6 +490,12 @@ TEST_CASE("index_set: erase_at()") {
         REQUIRE_INDICES(set, 5);
     }
 
+    SECTION("does nothing when the positions are all after the current indices") {
+        set = {5, 8};
+        set.erase_at({9, 12});
+        REQUIRE_INDICES(set, 5, 8);
+    }
+
     SECTION("removes the specified indices") {
         set = {5};
         set.erase_at(5);
@@ -584,6 +674,17 @@ TEST_CASE("index_set: shift()") {
         REQUIRE(set.shift(3) == 7);
         REQUIRE(set.shift(4) == 8);
     }
+
+    SECTION("finds the correct position when the set spans multiple chunks") {
+        size_t count = realm::_impl::ChunkedRangeVector::max_size * 4;
+        for (size_t i = 0; i < count; ++i)
+            set.add(i * 2);
+        // shifting by each index in turn should produce each odd number, as
+        // all of the even numbers are in the set
+        for (size_t i = 0; i < count; ++i)
+            REQUIRE(set.shift(i) == i * 2 + 1);
+        REQUIRE(set.shift(count) == count * 2);
+    }
 }
 
 TEST_CASE("index_set: unshift()") {
@@ -608,3 +709,19 @@ TEST_CASE("index_set: clear()") {
         REQUIRE(set.empty());
     }
 }
+
+TEST_CASE("index_set: metrics") {
+    realm::IndexSet set;
+
+    SECTION("chunk splits are counted in the global metrics") {
+        auto before = realm::util::metrics().index_set_chunk_splits;
+
+        // Insert in descending order so that every insertion lands at the
+        // front of the first chunk, forcing splits as chunks fill up
+        for (size_t i = 1000; i > 0; --i)
+            set.add(i * 2);
+
+        auto after = realm::util::metrics().index_set_chunk_splits;
+        REQUIRE(after > before);
+    }
+}
@@ -396,6 +396,81 @@ TEST_CASE("list") {
         }
     }
 
+    SECTION("batch mutations") {
+        List lst(r, lv);
+
+        SECTION("add_all() appends every target in order") {
+            r->begin_transaction();
+            lst.add_all({0, 2, 4});
+            r->commit_transaction();
+
+            REQUIRE(lst.size() == 13);
+            REQUIRE(lst.get(10).get_index() == 0);
+            REQUIRE(lst.get(11).get_index() == 2);
+            REQUIRE(lst.get(12).get_index() == 4);
+        }
+
+        SECTION("insert_all() inserts contiguously at the given index") {
+            r->begin_transaction();
+            lst.insert_all(2, {5, 6});
+            r->commit_transaction();
+
+            REQUIRE(lst.size() == 12);
+            REQUIRE(lst.get(2).get_index() == 5);
+            REQUIRE(lst.get(3).get_index() == 6);
+            REQUIRE(lst.get(4).get_index() == 2);
+        }
+
+        SECTION("remove_range() removes the half-open range") {
+            r->begin_transaction();
+            lst.remove_range(2, 5);
+            r->commit_transaction();
+
+            REQUIRE(lst.size() == 7);
+            REQUIRE(lst.get(1).get_index() == 1);
+            REQUIRE(lst.get(2).get_index() == 5);
+        }
+
+        SECTION("remove_range() validates its bounds") {
+            r->begin_transaction();
+            REQUIRE_THROWS_AS(lst.remove_range(0, 11), List::OutOfBoundsIndexException);
+            REQUIRE_THROWS_AS(lst.remove_range(5, 2), List::OutOfBoundsIndexException);
+            r->cancel_transaction();
+        }
+
+        SECTION("assign() replaces the contents in one pass") {
+            r->begin_transaction();
+            lst.assign({9, 8, 7});
+            r->commit_transaction();
+
+            REQUIRE(lst.size() == 3);
+            REQUIRE(lst.get(0).get_index() == 9);
+            REQUIRE(lst.get(1).get_index() == 8);
+            REQUIRE(lst.get(2).get_index() == 7);
+        }
+
+        SECTION("assign() does not touch unchanged elements") {
+            bool first = true;
+            auto token = lst.add_notification_callback([&, first](CollectionChangeSet, std::exception_ptr) mutable {
+                REQUIRE(first);
+                first = false;
+            });
+            advance_and_notify(*r);
+
+            r->begin_transaction();
+            lst.assign({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+            r->commit_transaction();
+            advance_and_notify(*r);
+        }
+
+        SECTION("batch mutations require a write transaction") {
+            REQUIRE_THROWS_AS(lst.add_all({0}), InvalidTransactionException);
+            REQUIRE_THROWS_AS(lst.insert_all(0, {0}), InvalidTransactionException);
+            REQUIRE_THROWS_AS(lst.remove_range(0, 1), InvalidTransactionException);
+            REQUIRE_THROWS_AS(lst.assign({0}), InvalidTransactionException);
+        }
+    }
+
     SECTION("sorted add_notification_block()") {
         List lst(r, lv);
         Results results = lst.sort({*target, {{0}}, {false}});
@@ -1238,3 +1238,77 @@ TEST_CASE("migration: Manual") {
         REQUIRE(realm->schema_version() == 1);
     }
 }
+
+TEST_CASE("migration: parallel row enumeration") {
+    InMemoryTestFile config;
+    config.schema_mode = SchemaMode::Automatic;
+
+    Schema schema = {
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false},
+        }},
+    };
+    Schema new_schema = add_property(schema, "object",
+                                     {"doubled", PropertyType::Int, "", "", false, false, false});
+
+    // enough rows that the table is split into multiple partitions
+    constexpr size_t row_count = 4096;
+    auto populate = [&](SharedRealm const& realm) {
+        realm->update_schema(schema, 1);
+        realm->begin_transaction();
+        auto table = ObjectStore::table_for_object_type(realm->read_group(), "object");
+        table->add_empty_row(row_count);
+        for (size_t i = 0; i < row_count; ++i)
+            table->set_int(0, i, i);
+        realm->commit_transaction();
+    };
+
+    SECTION("computes over every row exactly once") {
+        config.parallel_migration_thread_count = 2;
+        auto realm = Realm::get_shared_realm(config);
+        populate(realm);
+
+        realm->update_schema(new_schema, 2, [&](SharedRealm old_realm, SharedRealm new_realm, Schema&) {
+            // compute phase: read the old values on the worker pool into
+            // per-range slots of a preallocated buffer
+            std::vector<int64_t> doubled(row_count);
+            bool parallel = old_realm->enumerate_rows_in_parallel("object",
+                                                                  [&](Table const& table, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                    doubled[i] = table.get_int(0, i) * 2;
+            });
+            REQUIRE(parallel);
+
+            // apply phase: write the buffered values on the calling thread
+            auto table = ObjectStore::table_for_object_type(new_realm->read_group(), "object");
+            for (size_t i = 0; i < row_count; ++i)
+                table->set_int(1, i, doubled[i]);
+        });
+
+        auto table = ObjectStore::table_for_object_type(realm->read_group(), "object");
+        REQUIRE(table->size() == row_count);
+        for (size_t i = 0; i < row_count; ++i)
+            REQUIRE(table->get_int(1, i) == int64_t(i) * 2);
+    }
+
+    SECTION("reports failure when parallel migrations are not enabled") {
+        auto realm = Realm::get_shared_realm(config);
+        populate(realm);
+
+        realm->update_schema(new_schema, 2, [&](SharedRealm old_realm, SharedRealm, Schema&) {
+            REQUIRE_FALSE(old_realm->enumerate_rows_in_parallel("object",
+                                                                [&](Table const&, size_t, size_t) { }));
+        });
+    }
+
+    SECTION("reports failure for tables which do not exist") {
+        config.parallel_migration_thread_count = 2;
+        auto realm = Realm::get_shared_realm(config);
+        populate(realm);
+
+        realm->update_schema(new_schema, 2, [&](SharedRealm old_realm, SharedRealm, Schema&) {
+            REQUIRE_FALSE(old_realm->enumerate_rows_in_parallel("not an object",
+                                                                [&](Table const&, size_t, size_t) { }));
+        });
+    }
+}
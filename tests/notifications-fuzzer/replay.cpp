@@ -0,0 +1,268 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2016 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Deterministic replay harness for recorded transaction workloads, for
+// gating upgrades on notification performance.
+//
+// Workloads use the same command-file format as the fuzzer (initial values,
+// initial list indices, then a stream of row/list operations with 'c'
+// committing a transaction mid-stream), so recorded workloads and fuzzer
+// inputs are interchangeable. Each workload is replayed `--iterations` times
+// against a fresh import with query notifiers registered, and the minimum
+// time over the iterations is reported for each stage:
+//
+//   write    applying the recorded operations, including any notifier runs
+//            triggered by mid-stream commits
+//   notify   the background notifier run for the final commit
+//   deliver  delivering the computed changes to the Realm's callbacks
+//   total    the sum of the above
+//
+// Results are printed to stdout as `workload,stage,us` CSV. To gate on the
+// numbers, save a run's output and pass it back with `--baseline`: each
+// stage is then checked against the baseline plus `--tolerance` percent
+// (default 5), regressions are reported on stderr, and the exit status is
+// non-zero if any stage exceeded its budget.
+
+#include "command_file.hpp"
+
+#include "impl/realm_coordinator.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/disable_sync_to_disk.hpp>
+#include <realm/group.hpp>
+#include <realm/link_view.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+int64_t now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct StageTimes {
+    int64_t write = 0;
+    int64_t notify = 0;
+    int64_t deliver = 0;
+
+    int64_t total() const { return write + notify + deliver; }
+
+    // Keep the faster of the two runs for each stage
+    void merge_min(StageTimes const& other)
+    {
+        write = std::min(write, other.write);
+        notify = std::min(notify, other.notify);
+        deliver = std::min(deliver, other.deliver);
+    }
+};
+
+// One replay of the workload: import the initial state, apply the recorded
+// operations, then run the notifiers and deliver for the final commit
+StageTimes replay_once(fuzzer::CommandFile& commands, fuzzer::RealmState& state, SharedRealm const& realm)
+{
+    commands.import(state);
+    state.modified.clear();
+
+    // Bring the notifiers up to date with the imported state so that the
+    // timed portion only covers the recorded operations
+    state.coordinator.on_change();
+    state.realm.notify();
+
+    StageTimes times;
+    auto start = now_us();
+    commands.run(state);
+    times.write = now_us() - start;
+
+    start = now_us();
+    state.coordinator.on_change();
+    times.notify = now_us() - start;
+
+    start = now_us();
+    realm->notify();
+    times.deliver = now_us() - start;
+    return times;
+}
+
+StageTimes replay_workload(std::string const& path, size_t iterations)
+{
+    Realm::Config config;
+    config.path = "replay.realm";
+    config.cache = false;
+    config.in_memory = true;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"id", PropertyType::Int},
+            {"value", PropertyType::Int},
+        }},
+        {"linklist", {
+            {"list", PropertyType::Array, "object"},
+        }},
+    };
+    unlink(config.path.c_str());
+
+    auto realm = Realm::get_shared_realm(config);
+    auto& coordinator = *_impl::RealmCoordinator::get_existing_coordinator(config.path);
+
+    realm->begin_transaction();
+    realm->read_group().get_table("class_linklist")->add_empty_row();
+    realm->commit_transaction();
+
+    auto& table = *realm->read_group().get_table("class_object");
+    fuzzer::RealmState state = {
+        *realm, coordinator, table,
+        realm->read_group().get_table("class_linklist")->get_linklist(0, 0),
+        0, {}
+    };
+
+    // Register the same notifiers as the query fuzzer variants so that the
+    // notifier stage does representative work
+    Results unsorted(realm, table.where().greater(1, 100).less(1, 50000));
+    Results sorted = unsorted.sort({table, {{1}}, {true}});
+    std::vector<NotificationToken> tokens;
+    tokens.push_back(unsorted.add_notification_callback([](CollectionChangeSet, std::exception_ptr) { }));
+    tokens.push_back(sorted.add_notification_callback([](CollectionChangeSet, std::exception_ptr) { }));
+    coordinator.on_change();
+    realm->notify();
+
+    std::ifstream input(path);
+    if (!input.good()) {
+        fprintf(stderr, "failed to open workload '%s'\n", path.c_str());
+        exit(2);
+    }
+    fuzzer::CommandFile commands(input);
+
+    // One warm-up replay, then keep the per-stage minimum over the measured
+    // iterations to damp scheduling noise
+    replay_once(commands, state, realm);
+    auto best = replay_once(commands, state, realm);
+    for (size_t i = 1; i < iterations; ++i) {
+        best.merge_min(replay_once(commands, state, realm));
+    }
+
+    unlink(config.path.c_str());
+    return best;
+}
+
+// The workload name used in the CSV output: the file name without any
+// directory components
+std::string workload_name(std::string const& path)
+{
+    auto pos = path.find_last_of('/');
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+// Baseline CSV as produced by a previous run: workload,stage,us
+std::map<std::string, int64_t> read_baseline(std::string const& path)
+{
+    std::ifstream input(path);
+    if (!input.good()) {
+        fprintf(stderr, "failed to open baseline '%s'\n", path.c_str());
+        exit(2);
+    }
+
+    std::map<std::string, int64_t> baseline;
+    std::string line;
+    while (std::getline(input, line)) {
+        auto last_comma = line.find_last_of(',');
+        if (last_comma == std::string::npos)
+            continue;
+        try {
+            baseline[line.substr(0, last_comma)] = std::stoll(line.substr(last_comma + 1));
+        }
+        catch (std::invalid_argument) {
+            // header or malformed line; not an error
+        }
+    }
+    return baseline;
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    realm::disable_sync_to_disk();
+
+    size_t iterations = 10;
+    double tolerance = 5.0;
+    std::string baseline_path;
+    std::vector<std::string> workloads;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+            iterations = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+            tolerance = std::stod(argv[++i]);
+        else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+            baseline_path = argv[++i];
+        else
+            workloads.push_back(argv[i]);
+    }
+
+    if (workloads.empty()) {
+        fprintf(stderr,
+                "usage: %s [--iterations n] [--baseline results.csv] [--tolerance pct] workload...\n",
+                argv[0]);
+        return 2;
+    }
+
+    std::map<std::string, int64_t> baseline;
+    if (!baseline_path.empty())
+        baseline = read_baseline(baseline_path);
+
+    bool failed = false;
+    auto check = [&](std::string const& workload, const char* stage, int64_t us) {
+        printf("%s,%s,%lld\n", workload.c_str(), stage, static_cast<long long>(us));
+        if (baseline.empty())
+            return;
+
+        auto it = baseline.find(workload + "," + stage);
+        if (it == baseline.end())
+            return;
+        auto budget = static_cast<int64_t>(it->second * (1.0 + tolerance / 100.0));
+        if (us > budget) {
+            fprintf(stderr, "FAIL %s %s: %lld us > budget %lld us (baseline %lld us + %g%%)\n",
+                    workload.c_str(), stage, static_cast<long long>(us),
+                    static_cast<long long>(budget), static_cast<long long>(it->second), tolerance);
+            failed = true;
+        }
+    };
+
+    for (auto& path : workloads) {
+        auto times = replay_workload(path, iterations);
+        auto name = workload_name(path);
+        check(name, "write", times.write);
+        check(name, "notify", times.notify);
+        check(name, "deliver", times.deliver);
+        check(name, "total", times.total());
+    }
+
+    return failed ? 1 : 0;
+}
@@ -17,8 +17,11 @@
 ////////////////////////////////////////////////////////////////////////////
 
 #include "catch.hpp"
+#include "object_schema.hpp"
 #include "object_store.hpp"
+#include <realm/group.hpp>
 #include <realm/string_data.hpp>
+#include <realm/table.hpp>
 
 using namespace realm;
 
@@ -30,3 +33,22 @@ TEST_CASE("ObjectStore: table_name_for_object_type()") {
         REQUIRE(result == "class_good");
     }
 }
+
+TEST_CASE("ObjectStore: object_schema_from_group()") {
+    Group g;
+    TableRef table = g.add_table("class_object");
+    table->add_column(type_Int, "value");
+    g.add_table("class_other");
+
+    SECTION("reads the requested class") {
+        auto object_schema = ObjectStore::object_schema_from_group(g, "object");
+        REQUIRE(object_schema);
+        REQUIRE(object_schema->name == "object");
+        REQUIRE(object_schema->persisted_properties.size() == 1);
+        REQUIRE(object_schema->table_index == table->get_index_in_group());
+    }
+
+    SECTION("returns none for classes not present in the group") {
+        REQUIRE(!ObjectStore::object_schema_from_group(g, "missing"));
+    }
+}
@@ -184,3 +184,39 @@ TEST_CASE("invalid queries") {
         CHECK_THROWS(realm::parser::parse(query));
     }
 }
+
+TEST_CASE("deeply nested queries") {
+    // a nested query spills the predicate arena over multiple blocks
+    std::string query = "0=0";
+    for (int i = 0; i < 100; ++i) {
+        query = "(" + query + " && 0=0) || 1=1";
+    }
+    CHECK_NOTHROW(realm::parser::parse(query));
+}
+
+TEST_CASE("parsed predicates do not retain the parse arena") {
+    // Copies of a predicate — including the ones the memoization cache hands
+    // out on repeated parses — must not allocate from the parse-time arena,
+    // as arena memory is only reclaimed when the arena itself dies and a
+    // cache hit would otherwise grow its entry's arena forever
+    std::string query = "a == 1 && b == 2 && (c == 3 || d == 4)";
+    for (int i = 0; i < 2; ++i) {
+        auto result = realm::parser::parse(query);
+        CHECK(!result.cpnd.sub_predicates.get_allocator().arena());
+    }
+}
+
+TEST_CASE("repeated queries") {
+    // parses are memoized, so the second parse of a string must give the
+    // same result as the first
+    for (auto& query : valid_queries) {
+        INFO("query: " << query);
+        CHECK_NOTHROW(realm::parser::parse(query));
+        CHECK_NOTHROW(realm::parser::parse(query));
+    }
+    for (auto& query : invalid_queries) {
+        INFO("query: " << query);
+        CHECK_THROWS(realm::parser::parse(query));
+        CHECK_THROWS(realm::parser::parse(query));
+    }
+}
@@ -21,14 +21,18 @@
 #include "util/test_file.hpp"
 
 #include "binding_context.hpp"
+#include "impl/realm_coordinator.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
 #include "property.hpp"
+#include "results.hpp"
 #include "schema.hpp"
 
 #include <realm/group.hpp>
 #include <realm/util/file.hpp>
 
+#include <thread>
+
 using namespace realm;
 
 TEST_CASE("SharedRealm: get_shared_realm()") {
@@ -172,6 +176,133 @@ TEST_CASE("SharedRealm: get_shared_realm()") {
     }
 }
 
+TEST_CASE("SharedRealm: get_realm_async()") {
+    if (!util::has_event_loop_implementation())
+        return;
+
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+
+    SECTION("delivers a ready Realm to the calling thread") {
+        SharedRealm realm;
+        std::exception_ptr error;
+        bool called = false;
+        coordinator->get_realm_async(config, [&](SharedRealm r, std::exception_ptr e) {
+            called = true;
+            realm = std::move(r);
+            error = e;
+        });
+        REQUIRE_FALSE(called);
+        util::run_event_loop_until([&] { return called; });
+        REQUIRE_FALSE(error);
+        REQUIRE(realm);
+        REQUIRE_NOTHROW(realm->verify_thread());
+        REQUIRE(realm->schema().size() == 1);
+    }
+
+    SECTION("delivers errors encountered while opening") {
+        Realm::get_shared_realm(config);
+
+        config.schema_version = 0;
+        SharedRealm realm;
+        std::exception_ptr error;
+        coordinator->get_realm_async(config, [&](SharedRealm r, std::exception_ptr e) {
+            realm = std::move(r);
+            error = e;
+        });
+        util::run_event_loop_until([&] { return bool(error); });
+        REQUIRE_FALSE(realm);
+    }
+}
+
+TEST_CASE("SharedRealm: should_compact_on_launch_function") {
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 0;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    // Create the file with some data in it
+    {
+        auto realm = Realm::get_shared_realm(config);
+        realm->begin_transaction();
+        realm->read_group().get_table("class_object")->add_empty_row(100);
+        realm->commit_transaction();
+    }
+
+    SECTION("is called with the file size when the file is first opened") {
+        bool called = false;
+        uint64_t size_seen = 0;
+        config.should_compact_on_launch_function = [&](uint64_t total_bytes) {
+            called = true;
+            size_seen = total_bytes;
+            return true;
+        };
+        auto realm = Realm::get_shared_realm(config);
+        REQUIRE(called);
+        REQUIRE(size_seen > 0);
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 100);
+    }
+
+    SECTION("is not called for subsequent opens in the same process") {
+        size_t call_count = 0;
+        config.should_compact_on_launch_function = [&](uint64_t) {
+            ++call_count;
+            return false;
+        };
+        auto realm = Realm::get_shared_realm(config);
+        auto realm2 = Realm::get_shared_realm(config);
+        REQUIRE(call_count == 1);
+    }
+}
+
+TEST_CASE("SharedRealm: write_copy() with progress") {
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 0;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    realm->begin_transaction();
+    realm->read_group().get_table("class_object")->add_empty_row(100);
+    realm->commit_transaction();
+
+    TestFile copy_config;
+    copy_config.schema_version = 0;
+    copy_config.schema = config.schema;
+
+    SECTION("reports monotonically increasing byte counts ending at the file size") {
+        std::vector<uint64_t> progress;
+        realm->write_copy(copy_config.path, BinaryData(), [&](uint64_t bytes_written) {
+            progress.push_back(bytes_written);
+        });
+        REQUIRE_FALSE(progress.empty());
+        REQUIRE(std::is_sorted(progress.begin(), progress.end()));
+        REQUIRE(progress.back() == util::File(copy_config.path).get_size());
+    }
+
+    SECTION("produces a valid copy of the file") {
+        realm->write_copy(copy_config.path, BinaryData(), nullptr);
+        auto copy = Realm::get_shared_realm(copy_config);
+        REQUIRE(copy->read_group().get_table("class_object")->size() == 100);
+    }
+}
+
 TEST_CASE("SharedRealm: notifications") {
     if (!util::has_event_loop_implementation())
         return;
@@ -215,3 +346,297 @@ TEST_CASE("SharedRealm: notifications") {
         REQUIRE(change_count == 1);
     }
 }
+
+TEST_CASE("SharedRealm: async_begin_transaction") {
+    if (!util::has_event_loop_implementation())
+        return;
+
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 0;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    realm->read_group();
+
+    SECTION("invokes the callback inside a write transaction") {
+        bool called = false;
+        realm->async_begin_transaction([&] {
+            called = true;
+            REQUIRE(realm->is_in_transaction());
+            realm->read_group().get_table("class_object")->add_empty_row();
+            realm->commit_transaction();
+        });
+        REQUIRE_FALSE(called);
+        util::run_event_loop_until([&] { return called; });
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 1);
+    }
+
+    SECTION("runs queued callbacks one at a time as their transactions end") {
+        int order = 0, first = 0, second = 0;
+        realm->async_begin_transaction([&] {
+            first = ++order;
+            realm->commit_transaction();
+        });
+        realm->async_begin_transaction([&] {
+            second = ++order;
+            realm->cancel_transaction();
+        });
+        util::run_event_loop_until([&] { return order == 2; });
+        REQUIRE(first == 1);
+        REQUIRE(second == 2);
+    }
+
+    SECTION("waits for another Realm's write transaction to end") {
+        auto r2 = Realm::get_shared_realm(config);
+        r2->begin_transaction();
+
+        bool called = false;
+        realm->async_begin_transaction([&] {
+            called = true;
+            realm->commit_transaction();
+        });
+        r2->commit_transaction();
+        util::run_event_loop_until([&] { return called; });
+    }
+}
+
+TEST_CASE("SharedRealm: max_version_lag") {
+    if (!util::has_event_loop_implementation())
+        return;
+
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 0;
+    config.max_version_lag = 2;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    struct Context : BindingContext {
+        size_t* notify_count;
+        size_t* change_count;
+        Context(size_t* notify_out, size_t* change_out)
+        : notify_count(notify_out), change_count(change_out) { }
+
+        void changes_available() override
+        {
+            ++*notify_count;
+        }
+
+        void did_change(std::vector<ObserverState> const&, std::vector<void*> const&) override
+        {
+            ++*change_count;
+        }
+    };
+
+    size_t notify_count = 0, change_count = 0;
+    auto realm = Realm::get_shared_realm(config);
+    realm->set_auto_refresh(false);
+    realm->read_group();
+    realm->m_binding_context.reset(new Context{&notify_count, &change_count});
+
+    auto r2 = Realm::get_shared_realm(config);
+    auto& table = *r2->read_group().get_table("class_object");
+
+    SECTION("remote changes within the limit do not advance") {
+        r2->begin_transaction();
+        table.add_empty_row();
+        r2->commit_transaction();
+
+        util::run_event_loop_until([&]{ return notify_count > 0; });
+        REQUIRE(change_count == 0);
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 0);
+    }
+
+    SECTION("the read transaction is advanced once the limit is exceeded") {
+        for (int i = 0; i < 4; ++i) {
+            r2->begin_transaction();
+            table.add_empty_row();
+            r2->commit_transaction();
+        }
+
+        util::run_event_loop_until([&]{ return change_count > 0; });
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 4);
+    }
+}
+
+TEST_CASE("SharedRealm: notifier coalescing window") {
+    if (!util::has_event_loop_implementation())
+        return;
+
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 0;
+    config.notifier_coalescing_window_ms = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    struct Context : BindingContext {
+        size_t* change_count;
+        Context(size_t* out) : change_count(out) { }
+
+        void did_change(std::vector<ObserverState> const&, std::vector<void*> const&) override
+        {
+            ++*change_count;
+        }
+    };
+
+    size_t change_count = 0;
+    auto realm = Realm::get_shared_realm(config);
+    realm->read_group();
+    realm->m_binding_context.reset(new Context{&change_count});
+
+    SECTION("burst commits are still all delivered") {
+        auto r2 = Realm::get_shared_realm(config);
+        auto& table = *r2->read_group().get_table("class_object");
+        for (int i = 0; i < 10; ++i) {
+            r2->begin_transaction();
+            table.add_empty_row();
+            r2->commit_transaction();
+        }
+
+        util::run_event_loop_until([&]{
+            return realm->read_group().get_table("class_object")->size() == 10;
+        });
+        REQUIRE(change_count > 0);
+    }
+}
+
+TEST_CASE("SharedRealm: freeze()") {
+    TestFile config;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto table = realm->read_group().get_table("class_object");
+    realm->begin_transaction();
+    table->add_empty_row(3);
+    for (size_t i = 0; i < 3; ++i)
+        table->set_int(0, i, i + 1);
+    realm->commit_transaction();
+
+    SECTION("pins the version it was created at") {
+        auto frozen = realm->freeze();
+        REQUIRE(frozen->is_frozen());
+        REQUIRE(!realm->is_frozen());
+
+        realm->begin_transaction();
+        table->add_empty_row();
+        realm->commit_transaction();
+
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 4);
+        REQUIRE(frozen->read_group().get_table("class_object")->size() == 3);
+    }
+
+    SECTION("can be read from other threads") {
+        auto frozen = realm->freeze();
+        size_t size = 0;
+        int64_t sum = 0;
+        std::thread([&] {
+            Results results(frozen, *frozen->read_group().get_table("class_object"));
+            size = results.size();
+            for (size_t i = 0; i < size; ++i)
+                sum += results.get(i).get_int(0);
+        }).join();
+        REQUIRE(size == 3);
+        REQUIRE(sum == 6);
+    }
+
+    SECTION("rejects anything which would change its contents") {
+        auto frozen = realm->freeze();
+        REQUIRE_THROWS_AS(frozen->begin_transaction(), InvalidTransactionException);
+        REQUIRE_THROWS_AS(frozen->refresh(), InvalidTransactionException);
+        REQUIRE_THROWS_AS(frozen->invalidate(), InvalidTransactionException);
+        REQUIRE_FALSE(frozen->can_deliver_notifications());
+    }
+
+    SECTION("cannot be created within a write transaction") {
+        realm->begin_transaction();
+        REQUIRE_THROWS_AS(realm->freeze(), InvalidTransactionException);
+        realm->cancel_transaction();
+    }
+}
+
+TEST_CASE("SharedRealm: time-budgeted notify()") {
+    TestFile config;
+    config.schema_version = 1;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+    auto table = realm->read_group().get_table("class_object");
+
+    realm->begin_transaction();
+    table->add_empty_row();
+    table->set_int(0, 0, 1);
+    realm->commit_transaction();
+
+    Results first(realm, table->where().greater_equal(0, 0));
+    Results second(realm, table->where().greater_equal(0, 1));
+    size_t first_calls = 0, second_calls = 0;
+    auto token1 = first.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+        ++first_calls;
+    });
+    auto token2 = second.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+        ++second_calls;
+    });
+
+    coordinator->on_change();
+    realm->notify();
+    REQUIRE(first_calls == 1);
+    REQUIRE(second_calls == 1);
+
+    realm->begin_transaction();
+    table->set_int(0, 0, 2);
+    realm->commit_transaction();
+    coordinator->on_change();
+
+    SECTION("an already-expired deadline defers all but the first notifier's callbacks") {
+        realm->notify(std::chrono::steady_clock::now() - std::chrono::seconds(1));
+        REQUIRE(first_calls + second_calls == 3);
+
+        // The next notify() drains the deferred remainder
+        realm->notify();
+        REQUIRE(first_calls == 2);
+        REQUIRE(second_calls == 2);
+    }
+
+    SECTION("a deadline in the future delivers everything in one call") {
+        realm->notify(std::chrono::steady_clock::now() + std::chrono::hours(1));
+        REQUIRE(first_calls == 2);
+        REQUIRE(second_calls == 2);
+    }
+
+    SECTION("refresh() drains callbacks deferred by a previous notify()") {
+        realm->notify(std::chrono::steady_clock::now() - std::chrono::seconds(1));
+        REQUIRE(first_calls + second_calls == 3);
+
+        realm->begin_transaction();
+        table->set_int(0, 0, 3);
+        realm->commit_transaction();
+        coordinator->on_change();
+
+        realm->refresh();
+        REQUIRE(first_calls >= 2);
+        REQUIRE(second_calls >= 2);
+    }
+}
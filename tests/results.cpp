@@ -26,6 +26,7 @@
 #include "property.hpp"
 #include "results.hpp"
 #include "schema.hpp"
+#include "util/metrics.hpp"
 
 #include <realm/group_shared.hpp>
 #include <realm/link_view.hpp>
@@ -68,6 +69,37 @@ TEST_CASE("results: notifications") {
 
     Results results(r, table->where().greater(0, 0).less(0, 10));
 
+    SECTION("notifications with move tracking disabled") {
+        results.set_move_tracking_enabled(false);
+
+        int notification_calls = 0;
+        CollectionChangeSet change;
+        auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            change = c;
+            ++notification_calls;
+        });
+
+        advance_and_notify(*r);
+
+        SECTION("cannot be changed once a callback has been added") {
+            REQUIRE_THROWS_AS(results.set_move_tracking_enabled(true), std::logic_error);
+        }
+
+        SECTION("moves are reported as deletions and insertions") {
+            r->begin_transaction();
+            table->where().greater_equal(0, 10).find_all().clear(RemoveMode::unordered);
+            table->move_last_over(0);
+            r->commit_transaction();
+            advance_and_notify(*r);
+
+            REQUIRE(notification_calls == 2);
+            REQUIRE(change.moves.empty());
+            REQUIRE_INDICES(change.deletions, 0, 1, 2, 3);
+            REQUIRE_INDICES(change.insertions, 0, 1, 2, 3);
+        }
+    }
+
     SECTION("unsorted notifications") {
         int notification_calls = 0;
         CollectionChangeSet change;
@@ -252,6 +284,30 @@ TEST_CASE("results: notifications") {
             REQUIRE_INDICES(change.modifications_new, 0);
         }
 
+        SECTION("modifying a matching row reports the column which was modified") {
+            write([&] {
+                table->set_int(0, 1, 3);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE(change.columns.size() == 1);
+            REQUIRE_INDICES(change.columns[0], 0);
+        }
+
+        SECTION("modifications due to changes to linked objects are not attributed to a column") {
+            auto linked = r->read_group().get_table("class_linked to object");
+            write([&] {
+                size_t ndx = linked->add_empty_row();
+                table->set_link(1, 1, ndx);
+            });
+
+            write([&] {
+                linked->set_int(0, 0, 1);
+            });
+            REQUIRE(notification_calls == 3);
+            REQUIRE_INDICES(change.modifications, 0);
+            REQUIRE(change.columns.empty());
+        }
+
         SECTION("modifying a matching row to no longer match marks that row as deleted") {
             write([&] {
                 table->set_int(0, 2, 0);
@@ -1097,3 +1153,908 @@ TEST_CASE("results: snapshots") {
         CHECK_THROWS(snapshot.add_notification_callback([](CollectionChangeSet, std::exception_ptr) {}));
     }
 }
+
+TEST_CASE("results: query mode size") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results results(r, table->where().greater(0, 4));
+
+    SECTION("size() does not materialize a TableView") {
+        REQUIRE(results.size() == 5);
+        REQUIRE(results.get_mode() == Results::Mode::Query);
+    }
+
+    SECTION("repeated calls return the same count") {
+        REQUIRE(results.size() == 5);
+        REQUIRE(results.size() == 5);
+    }
+
+    SECTION("the cached count is discarded after a write") {
+        REQUIRE(results.size() == 5);
+
+        r->begin_transaction();
+        table->add_empty_row();
+        table->set_int(0, 10, 10);
+        REQUIRE(results.size() == 6);
+        r->commit_transaction();
+
+        REQUIRE(results.size() == 6);
+    }
+}
+
+TEST_CASE("results: iteration") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    SECTION("iterating a table-mode Results visits every row") {
+        Results results(r, *table);
+        size_t count = 0;
+        int64_t sum = 0;
+        for (auto row : results) {
+            ++count;
+            sum += row.get_int(0);
+        }
+        REQUIRE(count == 10);
+        REQUIRE(sum == 45);
+    }
+
+    SECTION("iterating a query-mode Results visits only matching rows") {
+        Results results(r, table->where().greater(0, 4));
+        size_t count = 0;
+        for (auto row : results) {
+            REQUIRE(row.get_int(0) > 4);
+            ++count;
+        }
+        REQUIRE(count == 5);
+    }
+
+    SECTION("for_each visits each row in order") {
+        Results results(r, *table);
+        int64_t expected = 0;
+        results.for_each([&](auto row) {
+            REQUIRE(row.get_int(0) == expected);
+            ++expected;
+        });
+        REQUIRE(expected == 10);
+    }
+
+    SECTION("iterating an empty Results does nothing") {
+        Results results;
+        for (auto row : results) {
+            static_cast<void>(row);
+            FAIL("empty Results should not produce rows");
+        }
+    }
+}
+
+TEST_CASE("results: limit and offset") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results all(r, *table);
+    Results matching(r, table->where().greater_equal(0, 2));
+
+    SECTION("limit caps the number of rows") {
+        auto limited = all.limit(3);
+        REQUIRE(limited.size() == 3);
+        REQUIRE(limited.get(0).get_int(0) == 0);
+        REQUIRE(limited.get(2).get_int(0) == 2);
+        REQUIRE_THROWS_AS(limited.get(3), Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("offset skips leading rows") {
+        auto skipped = all.offset(7);
+        REQUIRE(skipped.size() == 3);
+        REQUIRE(skipped.get(0).get_int(0) == 7);
+        REQUIRE(skipped.last()->get_int(0) == 9);
+    }
+
+    SECTION("limit and offset compose into a page") {
+        auto page = matching.offset(2).limit(3);
+        REQUIRE(page.size() == 3);
+        REQUIRE(page.first()->get_int(0) == 4);
+        REQUIRE(page.last()->get_int(0) == 6);
+
+        size_t count = 0;
+        for (auto row : page) {
+            REQUIRE(row.get_int(0) == int64_t(4 + count));
+            ++count;
+        }
+        REQUIRE(count == 3);
+    }
+
+    SECTION("a window past the end is empty") {
+        auto past_end = all.offset(20);
+        REQUIRE(past_end.size() == 0);
+        REQUIRE(!past_end.first());
+        REQUIRE(!past_end.last());
+    }
+
+    SECTION("index_of is relative to the window") {
+        auto page = all.offset(5).limit(2);
+        REQUIRE(page.index_of(size_t(5)) == 0);
+        REQUIRE(page.index_of(size_t(6)) == 1);
+        REQUIRE(page.index_of(size_t(4)) == realm::not_found);
+        REQUIRE(page.index_of(size_t(7)) == realm::not_found);
+    }
+
+    SECTION("limit is pushed into an unsorted query") {
+        auto page = matching.limit(4);
+        REQUIRE(page.size() == 4);
+        REQUIRE(page.get(0).get_int(0) == 2);
+        REQUIRE(page.get_mode() == Results::Mode::TableView);
+    }
+
+    SECTION("aggregates see rows past the window") {
+        auto page = matching.limit(4);
+        // materialize the windowed view first so that the aggregates can't
+        // just be evaluating the query before the pushdown happens
+        REQUIRE(page.size() == 4);
+        REQUIRE(page.sum(0)->get_int() == 44);
+        REQUIRE(page.max(0)->get_int() == 9);
+        REQUIRE(page.min(0)->get_int() == 2);
+        REQUIRE(page.average(0)->get_double() == 5.5);
+    }
+
+    SECTION("clear() removes rows past the window") {
+        auto page = matching.limit(4);
+        REQUIRE(page.size() == 4);
+
+        r->begin_transaction();
+        page.clear();
+        r->commit_transaction();
+
+        REQUIRE(table->size() == 2);
+        REQUIRE(matching.size() == 0);
+    }
+
+    SECTION("sorted results apply the window after sorting") {
+        auto sorted = matching.sort({*table, {{0}}, {false}});
+        auto page = sorted.offset(1).limit(2);
+        REQUIRE(page.size() == 2);
+        REQUIRE(page.get(0).get_int(0) == 8);
+        REQUIRE(page.get(1).get_int(0) == 7);
+    }
+}
+
+TEST_CASE("results: index_of caching") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(100);
+    for (int i = 0; i < 100; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results sorted(r, table->where().greater_equal(0, 10), {*table, {{0}}, {false}});
+
+    SECTION("repeated lookups all report the correct position") {
+        for (size_t i = 10; i < 100; ++i)
+            REQUIRE(sorted.index_of(i) == 99 - i);
+        for (size_t i = 0; i < 10; ++i)
+            REQUIRE(sorted.index_of(i) == realm::not_found);
+    }
+
+    SECTION("lookups see changes made after previous lookups") {
+        REQUIRE(sorted.index_of(size_t(99)) == 0);
+
+        r->begin_transaction();
+        table->move_last_over(99);
+        REQUIRE(sorted.index_of(size_t(99)) == realm::not_found);
+        REQUIRE(sorted.index_of(size_t(98)) == 0);
+        r->cancel_transaction();
+
+        REQUIRE(sorted.index_of(size_t(99)) == 0);
+    }
+
+    SECTION("lookups on a snapshot are not affected by the source updating") {
+        auto snapshot = sorted.snapshot();
+        REQUIRE(snapshot.index_of(size_t(99)) == 0);
+
+        r->begin_transaction();
+        table->add_empty_row();
+        table->set_int(0, 100, 100);
+        r->commit_transaction();
+
+        REQUIRE(sorted.index_of(size_t(100)) == 0);
+        REQUIRE(sorted.index_of(size_t(99)) == 1);
+        REQUIRE(snapshot.index_of(size_t(99)) == 0);
+        REQUIRE(snapshot.index_of(size_t(100)) == realm::not_found);
+    }
+}
+
+TEST_CASE("results: aggregate caching") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(5);
+    for (int i = 0; i < 5; ++i)
+        table->set_int(0, i, i + 1);
+    r->commit_transaction();
+
+    Results results(r, table->where());
+
+    SECTION("repeated aggregates return the same values") {
+        REQUIRE(results.sum(0)->get_int() == 15);
+        REQUIRE(results.sum(0)->get_int() == 15);
+        REQUIRE(results.max(0)->get_int() == 5);
+        REQUIRE(results.min(0)->get_int() == 1);
+        REQUIRE(results.average(0)->get_double() == 3.0);
+        REQUIRE(results.average(0)->get_double() == 3.0);
+    }
+
+    SECTION("cached aggregates are discarded after a write") {
+        REQUIRE(results.sum(0)->get_int() == 15);
+        REQUIRE(results.max(0)->get_int() == 5);
+
+        r->begin_transaction();
+        table->add_empty_row();
+        table->set_int(0, 5, 100);
+        r->commit_transaction();
+
+        REQUIRE(results.sum(0)->get_int() == 115);
+        REQUIRE(results.max(0)->get_int() == 100);
+    }
+
+    SECTION("aggregates inside a write transaction are not cached") {
+        r->begin_transaction();
+        REQUIRE(results.sum(0)->get_int() == 15);
+        table->set_int(0, 0, 11);
+        REQUIRE(results.sum(0)->get_int() == 25);
+        r->cancel_transaction();
+    }
+}
+
+TEST_CASE("results: async aggregates") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(5);
+    for (int i = 0; i < 5; ++i)
+        table->set_int(0, i, i + 1);
+    r->commit_transaction();
+
+    Results results(r, table->where());
+
+    SECTION("value is delivered asynchronously") {
+        int calls = 0;
+        util::Optional<Mixed> value;
+        auto token = results.async_sum(0, [&](util::Optional<Mixed> v, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            value = v;
+            ++calls;
+        });
+
+        REQUIRE(calls == 0);
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+        REQUIRE(value->get_int() == 15);
+
+        // One-shot: the value is not redelivered after later writes
+        r->begin_transaction();
+        table->set_int(0, 0, 100);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("each aggregate operation produces the correct value") {
+        util::Optional<Mixed> max, min, sum, average;
+        auto token1 = results.async_max(0, [&](util::Optional<Mixed> v, std::exception_ptr) { max = v; });
+        auto token2 = results.async_min(0, [&](util::Optional<Mixed> v, std::exception_ptr) { min = v; });
+        auto token3 = results.async_sum(0, [&](util::Optional<Mixed> v, std::exception_ptr) { sum = v; });
+        auto token4 = results.async_average(0, [&](util::Optional<Mixed> v, std::exception_ptr) { average = v; });
+
+        advance_and_notify(*r);
+        REQUIRE(max->get_int() == 5);
+        REQUIRE(min->get_int() == 1);
+        REQUIRE(sum->get_int() == 15);
+        REQUIRE(average->get_double() == 3.0);
+    }
+
+    SECTION("empty results produce none for all but sum") {
+        Results empty(r, table->where().equal(0, 100));
+        util::Optional<Mixed> max, sum;
+        auto token1 = empty.async_max(0, [&](util::Optional<Mixed> v, std::exception_ptr) { max = v; });
+        auto token2 = empty.async_sum(0, [&](util::Optional<Mixed> v, std::exception_ptr) { sum = v; });
+
+        advance_and_notify(*r);
+        REQUIRE(!max);
+        REQUIRE(sum->get_int() == 0);
+    }
+
+    SECTION("the value is computed from the version the write was made in") {
+        util::Optional<Mixed> value;
+        auto token = results.async_sum(0, [&](util::Optional<Mixed> v, std::exception_ptr) { value = v; });
+
+        r->begin_transaction();
+        table->set_int(0, 0, 11);
+        r->commit_transaction();
+
+        advance_and_notify(*r);
+        REQUIRE(value->get_int() == 25);
+    }
+
+    SECTION("invalid columns and operations are reported synchronously") {
+        REQUIRE_THROWS_AS(results.async_sum(1, [](util::Optional<Mixed>, std::exception_ptr) { }),
+                          Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("cancellation via destroying the token") {
+        int calls = 0;
+        auto token = results.async_sum(0, [&](util::Optional<Mixed>, std::exception_ptr) { ++calls; });
+        token = {};
+        advance_and_notify(*r);
+        REQUIRE(calls == 0);
+    }
+}
+
+TEST_CASE("results: async snapshot") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(5);
+    for (int i = 0; i < 5; ++i)
+        table->set_int(0, i, i + 1);
+    r->commit_transaction();
+
+    Results results(r, table->where().greater(0, 2));
+
+    SECTION("the snapshot is delivered asynchronously") {
+        int calls = 0;
+        Results snapshot;
+        auto token = results.async_snapshot([&](Results s, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            snapshot = std::move(s);
+            ++calls;
+        });
+
+        REQUIRE(calls == 0);
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+        REQUIRE(snapshot.size() == 3);
+        REQUIRE(snapshot.get(0).get_int(0) == 3);
+
+        // One-shot: the snapshot is not redelivered after later writes
+        r->begin_transaction();
+        table->set_int(0, 0, 100);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("the snapshot does not update to reflect later changes") {
+        Results snapshot;
+        auto token = results.async_snapshot([&](Results s, std::exception_ptr) {
+            snapshot = std::move(s);
+        });
+        advance_and_notify(*r);
+        REQUIRE(snapshot.size() == 3);
+
+        r->begin_transaction();
+        table->add_empty_row();
+        table->set_int(0, 5, 50);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(snapshot.size() == 3);
+        REQUIRE(results.size() == 4);
+    }
+
+    SECTION("sort order is preserved") {
+        Results sorted = results.sort({*table, {{0}}, {false}});
+        Results snapshot;
+        auto token = sorted.async_snapshot([&](Results s, std::exception_ptr) {
+            snapshot = std::move(s);
+        });
+        advance_and_notify(*r);
+        REQUIRE(snapshot.size() == 3);
+        REQUIRE(snapshot.get(0).get_int(0) == 5);
+        REQUIRE(snapshot.get(2).get_int(0) == 3);
+    }
+
+    SECTION("cancellation via destroying the token") {
+        int calls = 0;
+        auto token = results.async_snapshot([&](Results, std::exception_ptr) { ++calls; });
+        token = {};
+        advance_and_notify(*r);
+        REQUIRE(calls == 0);
+    }
+}
+
+TEST_CASE("results: prefetch hint") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"str", PropertyType::String},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i) {
+        table->set_int(0, i, i);
+        table->set_string(1, i, std::string(100, 'a' + i % 26));
+    }
+    r->commit_transaction();
+
+    // The prefetch itself is a best-effort cache warming hint with no
+    // observable results, so these just verify that issuing hints is
+    // harmless for each source of rows
+    SECTION("table-backed results") {
+        Results results(r, *table);
+        results.prefetch_hint(0, 100);
+        results.prefetch_hint(50, 1000);
+        results.prefetch_hint(500, 10);
+        REQUIRE(results.size() == 100);
+        REQUIRE(results.get(99).get_int(0) == 99);
+    }
+
+    SECTION("query-backed results") {
+        Results results(r, table->where().greater(0, 49));
+        results.prefetch_hint(0, 50);
+        REQUIRE(results.size() == 50);
+        REQUIRE(results.get(0).get_int(0) == 50);
+    }
+
+    SECTION("ignored within write transactions") {
+        Results results(r, *table);
+        r->begin_transaction();
+        results.prefetch_hint(0, 100);
+        table->set_int(0, 0, 500);
+        r->commit_transaction();
+        REQUIRE(results.get(0).get_int(0) == 500);
+    }
+
+    SECTION("empty results") {
+        Results results;
+        REQUIRE_NOTHROW(results.prefetch_hint(0, 10));
+    }
+}
+
+TEST_CASE("results: parallel query evaluation") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.parallel_query_thread_count = 4;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    // Enough rows that the query is actually partitioned over the workers
+    constexpr size_t row_count = 100000;
+    r->begin_transaction();
+    table->add_empty_row(row_count);
+    for (size_t i = 0; i < row_count; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results results(r, table->where().greater_equal(0, 50000));
+
+    SECTION("size() matches the single-threaded result") {
+        REQUIRE(results.size() == 50000);
+    }
+
+    SECTION("sum() matches the single-threaded result") {
+        // sum of [50000, 100000)
+        REQUIRE(results.sum(0)->get_int() == 3749975000);
+    }
+
+    SECTION("results update after writes") {
+        REQUIRE(results.size() == 50000);
+        r->begin_transaction();
+        table->set_int(0, 0, 60000);
+        r->commit_transaction();
+        REQUIRE(results.size() == 50001);
+        REQUIRE(results.sum(0)->get_int() == 3750035000);
+    }
+
+    SECTION("other aggregates fall back to the calling thread") {
+        REQUIRE(results.max(0)->get_int() == 99999);
+        REQUIRE(results.min(0)->get_int() == 50000);
+        REQUIRE(results.average(0)->get_double() == 74999.5);
+    }
+}
+
+TEST_CASE("results: parallel deep change checking") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.parallel_query_thread_count = 4;
+    config.schema = Schema{
+        {"origin", {
+            {"link", PropertyType::Object, "target", "", false, false, true},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto origin = r->read_group().get_table("class_origin");
+    auto target = r->read_group().get_table("class_target");
+
+    // Enough rows that the per-row modification checks are actually
+    // partitioned over the worker pool rather than being run serially
+    constexpr size_t row_count = 5000;
+    r->begin_transaction();
+    origin->add_empty_row(row_count);
+    target->add_empty_row(row_count);
+    for (size_t i = 0; i < row_count; ++i)
+        origin->set_link(0, i, i);
+    r->commit_transaction();
+
+    Results results(r, origin->where());
+    CollectionChangeSet change;
+    int notification_calls = 0;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = c;
+        ++notification_calls;
+    });
+    advance_and_notify(*r);
+    REQUIRE(notification_calls == 1);
+
+    SECTION("modifying linked-to rows marks the linking rows as modified") {
+        r->begin_transaction();
+        target->set_int(0, 10, 1);
+        target->set_int(0, 4000, 1);
+        r->commit_transaction();
+
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 2);
+        REQUIRE_INDICES(change.modifications, 10, 4000);
+    }
+
+    SECTION("modifying a target row which is not linked to reports no changes") {
+        r->begin_transaction();
+        size_t row = target->add_empty_row();
+        r->commit_transaction();
+        advance_and_notify(*r);
+
+        r->begin_transaction();
+        target->set_int(0, row, 1);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+    }
+}
+
+TEST_CASE("results: parallel notifier execution") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.parallel_notifier_thread_count = 3;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+        {"other object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+    auto other_table = r->read_group().get_table("class_other object");
+
+    r->begin_transaction();
+    table->add_empty_row(5);
+    other_table->add_empty_row(5);
+    r->commit_transaction();
+
+    // More notifiers than shards, so that some shards run multiple notifiers
+    Results results[] = {
+        Results(r, table->where()),
+        Results(r, table->where().greater(0, 0)),
+        Results(r, other_table->where()),
+        Results(r, other_table->where().greater(0, 0)),
+    };
+
+    int notification_calls[4] = {0, 0, 0, 0};
+    NotificationToken tokens[4];
+    for (int i = 0; i < 4; ++i) {
+        tokens[i] = results[i].add_notification_callback([&, i](CollectionChangeSet, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            ++notification_calls[i];
+        });
+    }
+
+    advance_and_notify(*r);
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(notification_calls[i] == 1);
+
+    SECTION("writes notify the affected notifiers regardless of shard") {
+        r->begin_transaction();
+        table->set_int(0, 0, 1);
+        other_table->set_int(0, 0, 1);
+        r->commit_transaction();
+
+        advance_and_notify(*r);
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(notification_calls[i] == 2);
+    }
+
+    SECTION("removing a notifier does not affect others in the same shard") {
+        tokens[1] = {};
+        results[1] = {};
+
+        r->begin_transaction();
+        table->set_int(0, 1, 2);
+        r->commit_transaction();
+
+        advance_and_notify(*r);
+        REQUIRE(notification_calls[0] == 2);
+        REQUIRE(notification_calls[1] == 1);
+    }
+}
+
+TEST_CASE("results: notifier metrics") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+    Results results(r, table->where());
+
+    int notification_calls = 0;
+    auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        ++notification_calls;
+    });
+
+    advance_and_notify(*r);
+    REQUIRE(notification_calls == 1);
+
+    auto& metrics = coordinator->notifier_metrics();
+    auto runs_before = metrics.run_count.load();
+
+    r->begin_transaction();
+    table->add_empty_row();
+    r->commit_transaction();
+    advance_and_notify(*r);
+    REQUIRE(notification_calls == 2);
+
+    REQUIRE(metrics.run_count.load() > runs_before);
+    REQUIRE(metrics.notifiers_run.load() >= 1);
+    REQUIRE(metrics.last_queue_depth.load() >= 1);
+    REQUIRE(metrics.total_run_time_us.load() >= metrics.last_run_time_us.load());
+}
+
+TEST_CASE("results: shared notifiers") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    r->begin_transaction();
+    table->add_empty_row(5);
+    for (int i = 0; i < 5; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    auto write = [&](auto&& f) {
+        r->begin_transaction();
+        f();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    int first_calls = 0, second_calls = 0;
+    CollectionChangeSet first_change, second_change;
+    auto first_callback = [&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        first_change = c;
+        ++first_calls;
+    };
+    auto second_callback = [&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        second_change = c;
+        ++second_calls;
+    };
+
+    SECTION("table-backed Results watching the same table share one notifier") {
+        Results first(r, *table);
+        Results second(r, *table);
+        auto token1 = first.add_notification_callback(first_callback);
+        auto token2 = second.add_notification_callback(second_callback);
+        advance_and_notify(*r);
+        REQUIRE(first_calls == 1);
+        REQUIRE(second_calls == 1);
+
+        auto before = util::metrics().table_view_rebuilds;
+        write([&] {
+            table->add_empty_row();
+            table->set_int(0, 5, 5);
+        });
+
+        // A single query re-run and diff should have served both Results
+        REQUIRE(util::metrics().table_view_rebuilds - before == 1);
+        REQUIRE(first_calls == 2);
+        REQUIRE(second_calls == 2);
+        REQUIRE_INDICES(first_change.insertions, 5);
+        REQUIRE_INDICES(second_change.insertions, 5);
+        REQUIRE(first.size() == 6);
+        REQUIRE(second.size() == 6);
+    }
+
+    SECTION("destroying one of the Results does not stop the other's notifications") {
+        Results first(r, *table);
+        Results second(r, *table);
+        auto token1 = first.add_notification_callback(first_callback);
+        auto token2 = second.add_notification_callback(second_callback);
+        advance_and_notify(*r);
+
+        token2 = {};
+        second = {};
+        write([&] { table->add_empty_row(); });
+        REQUIRE(first_calls == 2);
+        REQUIRE(first.size() == 6);
+    }
+
+    SECTION("copying and copy-assigning a Results with an active notifier") {
+        Results first(r, *table);
+        Results second(r, *table);
+        auto token1 = first.add_notification_callback(first_callback);
+        auto token2 = second.add_notification_callback(second_callback);
+        advance_and_notify(*r);
+
+        // Copies are not registered targets of the source's notifier, and
+        // assigning over a Results detaches it without tearing the shared
+        // notifier down for the remaining target
+        Results copy(first);
+        second = first;
+        write([&] { table->add_empty_row(); });
+        REQUIRE(first_calls == 2);
+        REQUIRE(first.size() == 6);
+        REQUIRE(copy.size() == 6);
+        REQUIRE(second.size() == 6);
+    }
+
+    SECTION("moving a Results keeps delivering to the moved-to instance") {
+        Results first(r, *table);
+        Results second(r, *table);
+        auto token1 = first.add_notification_callback(first_callback);
+        auto token2 = second.add_notification_callback(second_callback);
+        advance_and_notify(*r);
+
+        Results moved(std::move(second));
+        write([&] { table->add_empty_row(); });
+        REQUIRE(first_calls == 2);
+        REQUIRE(second_calls == 2);
+        REQUIRE(moved.size() == 6);
+    }
+
+    SECTION("query-backed Results each get their own notifier") {
+        Results first(r, table->where().greater_equal(0, 0));
+        Results second(r, table->where().greater_equal(0, 0));
+        auto token1 = first.add_notification_callback(first_callback);
+        auto token2 = second.add_notification_callback(second_callback);
+        advance_and_notify(*r);
+
+        auto before = util::metrics().table_view_rebuilds;
+        write([&] { table->add_empty_row(); });
+        REQUIRE(util::metrics().table_view_rebuilds - before == 2);
+        REQUIRE(first_calls == 2);
+        REQUIRE(second_calls == 2);
+    }
+
+    SECTION("differing move tracking prevents sharing") {
+        Results first(r, *table);
+        Results second(r, *table);
+        second.set_move_tracking_enabled(false);
+        auto token1 = first.add_notification_callback(first_callback);
+        auto token2 = second.add_notification_callback(second_callback);
+        advance_and_notify(*r);
+
+        auto before = util::metrics().table_view_rebuilds;
+        write([&] { table->add_empty_row(); });
+        REQUIRE(util::metrics().table_view_rebuilds - before == 2);
+    }
+}
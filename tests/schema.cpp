@@ -18,6 +18,7 @@
 
 #include "catch.hpp"
 
+#include "lazy_schema.hpp"
 #include "object_schema.hpp"
 #include "property.hpp"
 #include "schema.hpp"
@@ -474,3 +475,69 @@ TEST_CASE("Schema") {
         }
     }
 }
+
+TEST_CASE("LazySchema") {
+    Group g;
+    TableRef pk = g.add_table("pk");
+    pk->add_column(type_String, "pk_table");
+    pk->add_column(type_String, "pk_property");
+    pk->add_empty_row();
+    pk->set_string(0, 0, "first");
+    pk->set_string(1, 0, "pk");
+
+    TableRef first = g.add_table("class_first");
+    first->add_column(type_Int, "pk");
+    TableRef second = g.add_table("class_second");
+    second->add_column(type_Int, "value");
+
+    LazySchema schema(g);
+
+    SECTION("reports the object classes stored in the group") {
+        REQUIRE(schema.size() == 2);
+        REQUIRE(schema.object_types() == std::vector<StringData>({"first", "second"}));
+    }
+
+    SECTION("resolves classes on demand") {
+        REQUIRE(schema.get("nonexistent") == nullptr);
+
+        auto first_schema = schema.get("first");
+        REQUIRE(first_schema);
+        REQUIRE(first_schema->name == "first");
+        REQUIRE(first_schema->primary_key == "pk");
+        REQUIRE(first_schema->persisted_properties.size() == 1);
+
+        // repeated lookups return the cached resolution
+        REQUIRE(schema.get("first") == first_schema);
+
+        auto second_schema = schema.get("second");
+        REQUIRE(second_schema);
+        REQUIRE(second_schema->primary_key.empty());
+        // resolving another class does not move already-resolved ones
+        REQUIRE(schema.get("first") == first_schema);
+    }
+
+    SECTION("compare()") {
+        using namespace schema_change;
+        using vec = std::vector<SchemaChange>;
+
+        SECTION("produces AddTable for classes not in the group") {
+            ObjectSchema target = {"nonexistent", {
+                {"value", PropertyType::Int, "", "", false, false, false},
+            }};
+            REQUIRE(schema.compare(target) == vec{AddTable{&target}});
+        }
+
+        SECTION("diffs only the named class") {
+            ObjectSchema target = {"second", {
+                {"value", PropertyType::Int, "", "", false, false, false},
+                {"value 2", PropertyType::Int, "", "", false, false, false},
+            }};
+            REQUIRE(schema.compare(target) == vec{(AddProperty{schema.get("second"), &target.persisted_properties[1]})});
+        }
+
+        SECTION("reports no changes for a class matching the group") {
+            ObjectSchema target(g, "second");
+            REQUIRE(schema.compare(target).empty());
+        }
+    }
+}